@@ -0,0 +1,510 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <cstdlib>
+#include <cmath>
+#include <random>
+#include <SDL3/SDL.h>
+#include <SDL3/SDL_main.h>
+#include <imgui.h>
+
+#include "EditorUI.h"
+#include "GameObject.h"
+#include "Components/ScriptComponent.h"
+#include "LuaInstance.h"
+#include "SceneManager.h"
+#include "Window.h"
+#include "Renderer.h"
+#include "TextureCache.h"
+#include "TextRenderer.h"
+#include "NBodySolver.h"
+#include "Profiler.h"
+#include "GameTime.h"
+
+// SparkBench runs scenes headless (offscreen video driver + software renderer)
+// for a fixed number of fixed-dt frames and reports per-phase timings as JSON.
+//
+// usage: SparkBench [--frames N] [--warmup N] [--dt seconds] [--no-imgui] [--parallel-update] [--out file.json] [script.lua ...]
+//        SparkBench --nbody [--out file.json]   (direct vs Barnes-Hut gravity kernel, no scene)
+
+namespace
+{
+    struct BenchOptions
+    {
+        std::vector<std::string> scripts{};
+        int frames{600};
+        int warmupFrames{60};
+        float dt{1.0f / 60.0f};
+        bool useImGui{true};
+        bool parallelUpdate{false};
+        bool nbody{false};
+        std::string outputPath{};
+    };
+
+    struct PhaseStats
+    {
+        double min{};
+        double mean{};
+        double p50{};
+        double p99{};
+    };
+
+    // One sample per measured frame, in milliseconds
+    struct FrameSamples
+    {
+        std::vector<double> update;
+        std::vector<double> render;
+        std::vector<double> imgui;
+        std::vector<double> present;
+        std::vector<double> total;
+        std::vector<double> drawCalls;
+        std::vector<double> primitives;
+    };
+
+    struct ScriptResult
+    {
+        std::string script;
+        FrameSamples samples;
+    };
+
+    const std::vector<std::string> g_defaultScripts = {
+        "res/flocking_boids.lua",
+        "res/gravity_simulation.lua",
+        "res/particle_fountain.lua",
+    };
+
+    bool ParseArgs(int argc, char *argv[], BenchOptions &options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            auto nextValue = [&](const char *name) -> const char *
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "[SparkBench]: missing value for " << name << "\n";
+                    return nullptr;
+                }
+                return argv[++i];
+            };
+
+            if (arg == "--frames")
+            {
+                const char *value = nextValue("--frames");
+                if (!value)
+                    return false;
+                options.frames = std::max(1, std::atoi(value));
+            }
+            else if (arg == "--warmup")
+            {
+                const char *value = nextValue("--warmup");
+                if (!value)
+                    return false;
+                options.warmupFrames = std::max(0, std::atoi(value));
+            }
+            else if (arg == "--dt")
+            {
+                const char *value = nextValue("--dt");
+                if (!value)
+                    return false;
+                options.dt = static_cast<float>(std::atof(value));
+            }
+            else if (arg == "--no-imgui")
+            {
+                options.useImGui = false;
+            }
+            else if (arg == "--parallel-update")
+            {
+                options.parallelUpdate = true;
+            }
+            else if (arg == "--nbody")
+            {
+                options.nbody = true;
+            }
+            else if (arg == "--out")
+            {
+                const char *value = nextValue("--out");
+                if (!value)
+                    return false;
+                options.outputPath = value;
+            }
+            else if (arg.starts_with("--"))
+            {
+                std::cerr << "[SparkBench]: unknown option " << arg << "\n";
+                return false;
+            }
+            else
+            {
+                options.scripts.push_back(arg);
+            }
+        }
+
+        if (options.scripts.empty())
+        {
+            options.scripts = g_defaultScripts;
+        }
+        return true;
+    }
+
+    double ElapsedMs(Uint64 start, Uint64 end)
+    {
+        return static_cast<double>(end - start) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+    }
+
+    PhaseStats ComputeStats(std::vector<double> samples)
+    {
+        PhaseStats stats{};
+        if (samples.empty())
+        {
+            return stats;
+        }
+
+        std::sort(samples.begin(), samples.end());
+        // Nearest-rank percentile
+        auto percentile = [&](double p)
+        {
+            size_t rank = static_cast<size_t>(p * static_cast<double>(samples.size() - 1) + 0.5);
+            return samples[std::min(rank, samples.size() - 1)];
+        };
+
+        stats.min = samples.front();
+        stats.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size());
+        stats.p50 = percentile(0.50);
+        stats.p99 = percentile(0.99);
+        return stats;
+    }
+
+    void WriteStats(std::ostream &out, const char *name, const std::vector<double> &samples, bool last = false)
+    {
+        PhaseStats stats = ComputeStats(samples);
+        out << "        \"" << name << "\": { "
+            << "\"min\": " << stats.min << ", "
+            << "\"mean\": " << stats.mean << ", "
+            << "\"p50\": " << stats.p50 << ", "
+            << "\"p99\": " << stats.p99 << " }" << (last ? "\n" : ",\n");
+    }
+
+    void WriteJson(std::ostream &out, const BenchOptions &options, const std::vector<ScriptResult> &results)
+    {
+        out << "{\n";
+        out << "  \"frames\": " << options.frames << ",\n";
+        out << "  \"warmup\": " << options.warmupFrames << ",\n";
+        out << "  \"dt\": " << options.dt << ",\n";
+        out << "  \"imgui\": " << (options.useImGui ? "true" : "false") << ",\n";
+        out << "  \"parallel_update\": " << (options.parallelUpdate ? "true" : "false") << ",\n";
+        out << "  \"unit\": \"ms\",\n";
+        out << "  \"scripts\": [\n";
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const ScriptResult &result = results[i];
+            out << "    {\n";
+            out << "      \"script\": \"" << result.script << "\",\n";
+            out << "      \"phases\": {\n";
+            WriteStats(out, "update", result.samples.update);
+            WriteStats(out, "render", result.samples.render);
+            WriteStats(out, "imgui", result.samples.imgui);
+            WriteStats(out, "present", result.samples.present);
+            WriteStats(out, "total", result.samples.total, true);
+            out << "      },\n";
+            out << "      \"renderer\": {\n";
+            WriteStats(out, "draw_calls", result.samples.drawCalls);
+            WriteStats(out, "primitives", result.samples.primitives, true);
+            out << "      }\n";
+            out << "    }" << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        out << "  ]\n";
+        out << "}\n";
+    }
+
+    struct NBodyResult
+    {
+        std::size_t bodies{};
+        double directMs{};
+        double treeMs{};
+        std::size_t treeNodes{};
+        double relativeError{}; // RMS of |tree - direct| over RMS of |direct|
+    };
+
+    const std::vector<std::size_t> g_nbodySizes = {1000, 10000, 100000};
+
+    // Best of several runs, repeated until about a quarter second has been spent (at least once)
+    template <typename Fn>
+    double TimeBestMs(Fn &&fn)
+    {
+        double best = 0.0;
+        double spent = 0.0;
+        for (int run = 0; run < 50 && (run == 0 || spent < 250.0); ++run)
+        {
+            Uint64 start = SDL_GetPerformanceCounter();
+            fn();
+            const double elapsed = ElapsedMs(start, SDL_GetPerformanceCounter());
+            best = run == 0 ? elapsed : std::min(best, elapsed);
+            spent += elapsed;
+        }
+        return best;
+    }
+
+    std::vector<NBodyResult> RunNBody()
+    {
+        std::vector<NBodyResult> results;
+        std::mt19937 random{12345};
+        std::uniform_real_distribution<float> position(0.0f, 1000.0f);
+        std::uniform_real_distribution<float> mass(1.0f, 10.0f);
+
+        spark::NBodySolver solver;
+        solver.SetTheta(0.5f);
+        for (std::size_t count : g_nbodySizes)
+        {
+            spark::FloatBuffer positions(count, 2);
+            spark::FloatBuffer masses(count, 1);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                positions.SetComponent(i, 0, position(random));
+                positions.SetComponent(i, 1, position(random));
+                masses.Set(i, mass(random));
+            }
+
+            spark::FloatBuffer direct;
+            spark::FloatBuffer tree;
+            NBodyResult result{};
+            result.bodies = count;
+            std::cerr << "[SparkBench]: n-body " << count << " bodies\n";
+            result.directMs = TimeBestMs([&]()
+                                         { solver.ComputeAccelerations(positions, masses, direct, spark::NBodyMethod::Direct); });
+            result.treeMs = TimeBestMs([&]()
+                                       { solver.ComputeAccelerations(positions, masses, tree, spark::NBodyMethod::BarnesHut); });
+            result.treeNodes = solver.GetTreeNodeCount();
+
+            double errorSq = 0.0;
+            double referenceSq = 0.0;
+            for (std::size_t i = 0; i < direct.GetFloatCount(); ++i)
+            {
+                const double difference = static_cast<double>(tree.Get(i)) - direct.Get(i);
+                errorSq += difference * difference;
+                referenceSq += static_cast<double>(direct.Get(i)) * direct.Get(i);
+            }
+            result.relativeError = referenceSq > 0.0 ? std::sqrt(errorSq / referenceSq) : 0.0;
+            results.push_back(result);
+        }
+        return results;
+    }
+
+    void WriteNBodyJson(std::ostream &out, const std::vector<NBodyResult> &results)
+    {
+        out << "{\n";
+        out << "  \"unit\": \"ms\",\n";
+        out << "  \"theta\": 0.5,\n";
+        out << "  \"nbody\": [\n";
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const NBodyResult &result = results[i];
+            out << "    { \"bodies\": " << result.bodies
+                << ", \"direct\": " << result.directMs
+                << ", \"tree\": " << result.treeMs
+                << ", \"speedup\": " << (result.treeMs > 0.0 ? result.directMs / result.treeMs : 0.0)
+                << ", \"tree_nodes\": " << result.treeNodes
+                << ", \"relative_error\": " << result.relativeError << " }"
+                << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        out << "  ]\n";
+        out << "}\n";
+    }
+
+    ScriptResult RunScript(const std::string &scriptPath, const BenchOptions &options, spark::EditorUI &editorUI)
+    {
+        auto &renderer = spark::Renderer::GetInstance();
+        auto &sceneManager = spark::SceneManager::GetInstance();
+        auto &profiler = spark::Profiler::GetInstance();
+        auto &gameTime = spark::GameTime::GetInstance();
+
+        // Every script gets a fresh scene so state does not leak between runs
+        spark::Scene *previousScene = sceneManager.GetCurrentScene();
+        spark::Scene *scene = sceneManager.EmplaceScene(scriptPath);
+        scene->SetParallelUpdateEnabled(options.parallelUpdate);
+        sceneManager.SwitchToScene(scene);
+
+        auto go = scene->EmplaceGameObject("ScriptRunner");
+        go->AddComponent<spark::ScriptComponent>(scriptPath);
+        sceneManager.Init();
+
+        ScriptResult result{};
+        result.script = scriptPath;
+        result.samples.update.reserve(options.frames);
+        result.samples.render.reserve(options.frames);
+        result.samples.imgui.reserve(options.frames);
+        result.samples.present.reserve(options.frames);
+        result.samples.total.reserve(options.frames);
+        result.samples.drawCalls.reserve(options.frames);
+        result.samples.primitives.reserve(options.frames);
+
+        const int totalFrames = options.warmupFrames + options.frames;
+        for (int frame = 0; frame < totalFrames; ++frame)
+        {
+            SDL_PumpEvents();
+            // Frames are ended like in the editor so zone recording costs the same and stays bounded
+            profiler.BeginFrame();
+
+            // Same order as the frame loop in main.cpp, FixedUpdate scripts and physics are part of the measured update
+            Uint64 frameStart = SDL_GetPerformanceCounter();
+            const int fixedSteps = gameTime.Advance(options.dt);
+            for (int step = 0; step < fixedSteps; ++step)
+            {
+                sceneManager.FixedUpdate(gameTime.GetStepDeltaTime());
+            }
+            sceneManager.Update(options.dt);
+            spark::TextureCache::GetInstance().Update();
+            spark::TextRenderer::GetInstance().Update();
+            Uint64 updateEnd = SDL_GetPerformanceCounter();
+
+            renderer.SetDrawColor(135, 206, 235, 255);
+            renderer.Clear();
+
+            double imguiMs = 0.0;
+            if (options.useImGui)
+            {
+                Uint64 imguiStart = SDL_GetPerformanceCounter();
+                editorUI.BeginFrame();
+                imguiMs += ElapsedMs(imguiStart, SDL_GetPerformanceCounter());
+            }
+
+            Uint64 renderStart = SDL_GetPerformanceCounter();
+            sceneManager.Render();
+            renderer.Flush();
+            Uint64 renderEnd = SDL_GetPerformanceCounter();
+
+            if (options.useImGui)
+            {
+                Uint64 imguiStart = SDL_GetPerformanceCounter();
+                editorUI.Render(sceneManager);
+                editorUI.EndFrame(renderer.GetSDLRenderer());
+                imguiMs += ElapsedMs(imguiStart, SDL_GetPerformanceCounter());
+            }
+
+            Uint64 presentStart = SDL_GetPerformanceCounter();
+            renderer.Present();
+            Uint64 frameEnd = SDL_GetPerformanceCounter();
+            profiler.EndFrame();
+
+            if (frame < options.warmupFrames)
+            {
+                continue;
+            }
+
+            result.samples.update.push_back(ElapsedMs(frameStart, updateEnd));
+            result.samples.render.push_back(ElapsedMs(renderStart, renderEnd));
+            result.samples.imgui.push_back(imguiMs);
+            result.samples.present.push_back(ElapsedMs(presentStart, frameEnd));
+            result.samples.total.push_back(ElapsedMs(frameStart, frameEnd));
+
+            const spark::RenderStats &stats = renderer.GetFrameStats();
+            result.samples.drawCalls.push_back(stats.drawCalls);
+            result.samples.primitives.push_back(stats.primitivesSubmitted);
+        }
+
+        sceneManager.SwitchToScene(previousScene);
+        sceneManager.RemoveScene(scene);
+        return result;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    BenchOptions options{};
+    if (!ParseArgs(argc, argv, options))
+    {
+        return 1;
+    }
+
+    // Kernel-only benchmark, doesn't need a window or renderer
+    if (options.nbody)
+    {
+        std::vector<NBodyResult> results = RunNBody();
+        if (options.outputPath.empty())
+        {
+            WriteNBodyJson(std::cout, results);
+            return 0;
+        }
+
+        std::ofstream file(options.outputPath);
+        if (!file.is_open())
+        {
+            std::cerr << "[SparkBench]: failed to open " << options.outputPath << " for writing\n";
+            return 1;
+        }
+        WriteNBodyJson(file, results);
+        return 0;
+    }
+
+    // Headless: no visible window, no GPU, no vsync
+    SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+    SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+    if (!SDL_Init(SDL_INIT_VIDEO))
+    {
+        std::cerr << "[SparkBench]: SDL_Init failed: " << SDL_GetError() << "\n";
+        return 1;
+    }
+
+    // Singletons
+    auto &window = spark::Window::GetInstance();
+    auto &renderer = spark::Renderer::GetInstance();
+    auto &textureCache = spark::TextureCache::GetInstance();
+    auto &textRenderer = spark::TextRenderer::GetInstance();
+    auto &lua = spark::LuaInstance::GetInstance();
+
+    if (!renderer.GetSDLRenderer())
+    {
+        std::cerr << "[SparkBench]: failed to create a software renderer: " << SDL_GetError() << "\n";
+        SDL_Quit();
+        return 1;
+    }
+
+    renderer.SetVSync(false);
+    lua.Init();
+
+    spark::EditorUI editorUI;
+    if (options.useImGui)
+    {
+        editorUI.Init(window.GetSDLWindow(), renderer.GetSDLRenderer());
+        // Don't overwrite the editor layout from a benchmark run
+        ImGui::GetIO().IniFilename = nullptr;
+    }
+
+    std::vector<ScriptResult> results;
+    results.reserve(options.scripts.size());
+    for (const auto &script : options.scripts)
+    {
+        std::cerr << "[SparkBench]: running " << script << " (" << options.frames << " frames)\n";
+        results.push_back(RunScript(script, options, editorUI));
+    }
+
+    if (options.outputPath.empty())
+    {
+        WriteJson(std::cout, options, results);
+    }
+    else
+    {
+        std::ofstream file(options.outputPath);
+        if (!file.is_open())
+        {
+            std::cerr << "[SparkBench]: failed to open " << options.outputPath << " for writing\n";
+        }
+        else
+        {
+            WriteJson(file, options, results);
+        }
+    }
+
+    if (options.useImGui)
+    {
+        editorUI.Shutdown();
+    }
+    textureCache.Clear();
+    textRenderer.Clear();
+    spark::SceneManager::GetInstance().ReleaseBitmapCaches();
+    SDL_Quit();
+    return 0;
+}
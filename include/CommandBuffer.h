@@ -0,0 +1,85 @@
+#ifndef COMMANDBUFFER_H
+#define COMMANDBUFFER_H
+
+#include "GameObject.h"
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace spark
+{
+    // Structural changes recorded while the scene is iterating its objects and applied once it's done.
+    // The scene makes its own MainThread buffer current for the whole of Update, FixedUpdate and Render, so
+    // SetParent, RemoveComponent and object creation never invalidate a loop that's in progress.
+    // During the parallel update every worker records into a Worker buffer instead. Commands from all
+    // worker buffers run ordered by sort key (the root's position in the scene), so the result doesn't depend
+    // on which worker updated which root.
+    class CommandBuffer final
+    {
+    public:
+        enum class Mode
+        {
+            MainThread, // objects and components may still be created immediately, only their registration waits
+            Worker      // nothing structural happens until playback
+        };
+
+        explicit CommandBuffer(Mode mode = Mode::MainThread) : m_mode{mode} {}
+
+        // Buffer changes on the calling thread go to, null when they apply immediately
+        static CommandBuffer *GetCurrent();
+
+        // Makes buffer current on this thread for the scope's lifetime. The second form also records everything
+        // pushed meanwhile under sortKey. Both put the previous buffer and key back when they end, so a worker that
+        // steals another root's job while waiting in a nested ParallelFor can't leave its own root's key behind.
+        class Scope final
+        {
+        public:
+            explicit Scope(CommandBuffer &buffer);
+            Scope(CommandBuffer &buffer, std::uint32_t sortKey);
+            ~Scope();
+
+            Scope(const Scope &other) = delete;
+            Scope &operator=(const Scope &other) = delete;
+
+        private:
+            CommandBuffer *m_previous;
+            CommandBuffer &m_buffer;
+            std::uint32_t m_previousSortKey;
+        };
+
+        void Delete(GameObject *gameObject);
+        void SetParent(GameObject *gameObject, GameObject *newParent, bool keepWorldPos = true);
+
+        template <typename T, typename... Args>
+        void AddComponent(GameObject *gameObject, Args &&...args)
+        {
+            Push([gameObject, ... args = std::forward<Args>(args)]() mutable
+                 { gameObject->AddComponent<T>(std::move(args)...); });
+        }
+
+        void Push(std::function<void()> command);
+
+        bool IsEmpty() const { return m_commands.empty(); }
+        Mode GetMode() const { return m_mode; }
+
+        // Runs the commands in recorded order and empties the buffer. Main thread only.
+        void Playback();
+        // Runs every buffer's commands in sort key order and empties the buffers. Main thread only.
+        static void Playback(std::vector<CommandBuffer> &buffers);
+
+    private:
+        struct Command
+        {
+            std::uint32_t sortKey;
+            std::function<void()> apply;
+        };
+
+        std::vector<Command> m_commands;
+        std::uint32_t m_sortKey{};
+        Mode m_mode;
+    };
+} // namespace spark
+
+#endif // COMMANDBUFFER_H
@@ -0,0 +1,49 @@
+#ifndef COMPONENTTYPEID_H
+#define COMPONENTTYPEID_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+namespace spark
+{
+    // Every component type gets a small integer id the first time it is used,
+    // which indexes GameObject's flat component table and its component bitmask.
+    inline constexpr std::size_t MaxComponentTypes = 32;
+    using ComponentMask = std::uint32_t;
+
+    namespace detail
+    {
+        inline std::size_t NextComponentTypeId() noexcept
+        {
+            // Worker threads can be the first to use a component type, in parallel with the main thread
+            static std::atomic<std::size_t> counter{0};
+            const std::size_t id = counter.fetch_add(1, std::memory_order_relaxed);
+            // Checked in release builds too, a larger id would index past every mask and component table
+            if (id >= MaxComponentTypes)
+            {
+                std::cerr << "Too many component types, raise MaxComponentTypes (" << MaxComponentTypes << ")\n";
+                std::abort();
+            }
+            return id;
+        }
+    }
+
+    template <typename T>
+    std::size_t GetComponentTypeId() noexcept
+    {
+        static const std::size_t id = detail::NextComponentTypeId();
+        return id;
+    }
+
+    template <typename... Ts>
+    ComponentMask GetComponentMask() noexcept
+    {
+        static const ComponentMask mask = (ComponentMask{0} | ... | (ComponentMask{1} << GetComponentTypeId<Ts>()));
+        return mask;
+    }
+} // namespace spark
+
+#endif // COMPONENTTYPEID_H
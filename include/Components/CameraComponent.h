@@ -0,0 +1,64 @@
+#ifndef CAMERACOMPONENT_H
+#define CAMERACOMPONENT_H
+
+#include "Component.h"
+#include "IInspectorRenderable.h"
+#include "Renderer.h"
+
+#include <SDL3/SDL.h>
+#include <glm/glm.hpp>
+
+namespace spark
+{
+    // View onto the scene. The world position of the owner's transform is shown at the centre of the viewport,
+    // scaled by the zoom and turned by the rotation. While a scene has a camera, everything its objects draw is
+    // in world coordinates and renderables outside the view are skipped, see Scene::Render. A camera placed at
+    // half the window size with zoom 1 shows the same thing as having no camera.
+    class CameraComponent final : public Component, public IInspectorRenderable
+    {
+    public:
+        explicit CameraComponent(GameObject *parent) : Component(parent) {}
+
+        void RenderInspector() override;
+
+        // Above 1 magnifies
+        void SetZoom(float zoom) { m_zoom = zoom > 0.0f ? zoom : m_zoom; }
+        float GetZoom() const noexcept { return m_zoom; }
+        // Degrees, turning the camera clockwise turns the world counter-clockwise on screen
+        void SetRotation(float degrees) { m_rotation = degrees; }
+        float GetRotation() const noexcept { return m_rotation; }
+
+        // In window pixels, an empty rect means the whole render target
+        void SetViewport(const SDL_FRect &viewport) { m_viewport = viewport; }
+        const SDL_FRect &GetViewport() const noexcept { return m_viewport; }
+        SDL_FRect GetResolvedViewport() const;
+
+        // Off draws everything, for checking whether culling is what made something disappear
+        void SetCullingEnabled(bool enabled) { m_isCullingEnabled = enabled; }
+        bool IsCullingEnabled() const noexcept { return m_isCullingEnabled; }
+
+        glm::vec2 GetPosition() const;
+        // World to viewport pixels, what the Renderer applies while the camera is active
+        ViewTransform GetViewTransform() const;
+        // Window pixels, e.g. the mouse position, to world and back
+        glm::vec2 ScreenToWorld(const glm::vec2 &screen) const;
+        glm::vec2 WorldToScreen(const glm::vec2 &world) const;
+        // Axis aligned box around the part of the world the viewport shows
+        SDL_FRect GetVisibleWorldBounds() const;
+
+        // Points the Renderer at the viewport and view transform, and back to plain window pixels
+        void BeginRender() const;
+        void EndRender() const;
+
+        // Makes this the camera its scene renders with
+        void MakeCurrent();
+
+    private:
+        float m_zoom{1.0f};
+        float m_rotation{0.0f};
+        SDL_FRect m_viewport{0.0f, 0.0f, 0.0f, 0.0f};
+        bool m_isCullingEnabled{true};
+    };
+} // namespace spark
+
+#endif // CAMERACOMPONENT_H
@@ -0,0 +1,89 @@
+#ifndef PARTICLEEMITTERCOMPONENT_H
+#define PARTICLEEMITTERCOMPONENT_H
+
+#include "Component.h"
+#include "IUpdateable.h"
+#include "IParallelUpdateable.h"
+#include "IRenderable.h"
+#include "IInspectorRenderable.h"
+
+#include <SDL3/SDL.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+namespace spark
+{
+    struct ParticleEmitterSettings
+    {
+        float emissionRate{200.0f}; // particles per second
+        float lifetimeMin{1.0f};
+        float lifetimeMax{2.0f};
+        float speedMin{50.0f};
+        float speedMax{150.0f};
+        float direction{-90.0f}; // degrees, -90 is up in screen space
+        float spread{30.0f};     // degrees either side of direction
+        glm::vec2 gravity{0.0f, 98.0f};
+        glm::vec2 wind{0.0f, 0.0f};
+        float drag{0.5f}; // how quickly velocity approaches the wind velocity
+        float sizeStart{4.0f};
+        float sizeEnd{1.0f};
+        SDL_FColor colorStart{1.0f, 0.8f, 0.2f, 1.0f};
+        SDL_FColor colorEnd{1.0f, 0.1f, 0.0f, 0.0f};
+        glm::vec2 offset{0.0f, 0.0f}; // emission point relative to the owner's world position
+        std::size_t maxParticles{10000};
+    };
+
+    // Native particle system: particles are stored as structure-of-arrays, integrated in tight loops
+    // the compiler can vectorize, removed with swap-and-pop and drawn straight into the Renderer's batch.
+    // Particles live in world space, moving the GameObject only moves where new particles spawn.
+    class ParticleEmitterComponent final : public Component, public IUpdateable, public IParallelUpdateable, public IRenderable, public IInspectorRenderable
+    {
+    public:
+        explicit ParticleEmitterComponent(GameObject *parent);
+        ParticleEmitterComponent(GameObject *parent, const ParticleEmitterSettings &settings);
+
+        void Update(float dt) override;
+        void Render() override;
+        void RenderInspector() override;
+        RenderSortKey GetSortKey() const override { return m_sortKey; }
+        void SetSortKey(const RenderSortKey &key) { m_sortKey = key; }
+
+        // Spawns count particles immediately, regardless of the emission rate
+        void Burst(std::size_t count);
+        void Clear();
+
+        void SetEmitting(bool emitting) { m_isEmitting = emitting; }
+        bool IsEmitting() const { return m_isEmitting; }
+        std::size_t GetParticleCount() const { return m_posX.size(); }
+
+        ParticleEmitterSettings &GetSettings() { return m_settings; }
+        const ParticleEmitterSettings &GetSettings() const { return m_settings; }
+        void SetMaxParticles(std::size_t maxParticles);
+
+    private:
+        void Emit(std::size_t count);
+        void Integrate(std::size_t begin, std::size_t end, float dt);
+        void RemoveDeadParticles();
+        void SwapRemove(std::size_t index);
+
+    private:
+        ParticleEmitterSettings m_settings{};
+        RenderSortKey m_sortKey{};
+        bool m_isEmitting{true};
+        float m_emitAccumulator{0.0f};
+
+        // Structure of arrays, all the same length
+        std::vector<float> m_posX;
+        std::vector<float> m_posY;
+        std::vector<float> m_velX;
+        std::vector<float> m_velY;
+        std::vector<float> m_age;
+        std::vector<float> m_invLifetime; // 1 / lifetime, so age * invLifetime is the 0-1 life ratio
+
+        std::minstd_rand m_random;
+    };
+} // namespace spark
+
+#endif // PARTICLEEMITTERCOMPONENT_H
@@ -4,20 +4,23 @@
 #include <string>
 #include "imgui.h"
 #include "IUpdateable.h"
+#include "IFixedUpdateable.h"
 #include "IRenderable.h"
 #include "IInitializable.h"
 #include "IImGuiRenderable.h"
 #include "IInspectorRenderable.h"
+#include "Profiler.h"
 
 namespace spark
 {
-    class ScriptComponent : public Component, public IInitializable, public IUpdateable, public IRenderable, public IImGuiRenderable, public IInspectorRenderable
+    class ScriptComponent : public Component, public IInitializable, public IUpdateable, public IFixedUpdateable, public IRenderable, public IImGuiRenderable, public IInspectorRenderable
     {
     public:
         ScriptComponent(GameObject *parent, const std::string &scriptPath);
 
         void Init() override;
         void Update(float dt) override;
+        void FixedUpdate(float fixedDt) override;
         void Render() override;
         void RenderImGui() override;
         void RenderInspector() override;
@@ -43,6 +46,7 @@ namespace spark
 
     private:
         bool LoadAndExecuteScript();
+        void RenderLuaProfiler();
 
     private:
         std::string m_scriptPath;
@@ -54,11 +58,20 @@ namespace spark
 
         sol::protected_function m_luaInit;
         sol::protected_function m_luaUpdate;
+        sol::protected_function m_luaFixedUpdate;
         sol::protected_function m_luaRender;
         sol::protected_function m_luaImGuiRender;
 
+#ifndef SPARK_DISABLE_PROFILER
+        // Profiler zones are named after the script so a slow script stands out by path
+        ProfileLabel m_updateLabel{InvalidProfileLabel};
+        ProfileLabel m_fixedUpdateLabel{InvalidProfileLabel};
+        ProfileLabel m_renderLabel{InvalidProfileLabel};
+#endif
+
         bool m_hasInitFunction = true;
         bool m_hasUpdateFunction = true;
+        bool m_hasFixedUpdateFunction = true;
         bool m_hasRenderFunction = true;
         bool m_hasRenderImGuiFunction = true;
 
@@ -0,0 +1,111 @@
+#ifndef SHAPECOMPONENT_H
+#define SHAPECOMPONENT_H
+
+#include "Component.h"
+#include "IBoundedRenderable.h"
+#include "IInspectorRenderable.h"
+
+#include <SDL3/SDL.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace spark
+{
+    // Retained vector drawing, like a Flash Graphics object: build paths once (lines, arcs, rects, circles), each
+    // filled and/or stroked with the style set when it was started. The paths are tessellated into triangles in
+    // the object's local space the first time they're drawn after a change, and every frame the cached triangles
+    // are only transformed by the owner's world matrix and appended to the Renderer's batch. While neither the
+    // paths nor the world matrix change, last frame's vertices are submitted as they are.
+    class ShapeComponent final : public Component, public IBoundedRenderable, public IInspectorRenderable
+    {
+    public:
+        explicit ShapeComponent(GameObject *parent) : Component(parent) {}
+
+        void Render() override;
+        void RenderInspector() override;
+        bool GetWorldBounds(SDL_FRect &bounds) override;
+        std::uint32_t GetBoundsVersion() const override { return m_boundsVersion; }
+        RenderSortKey GetSortKey() const override { return m_sortKey; }
+        void SetSortKey(const RenderSortKey &key) { m_sortKey = key; }
+
+        // Removes every path, the style is kept
+        void Clear();
+
+        // Style for paths started afterwards. A fill only applies to closed paths, a width of 0 means no outline.
+        void SetFill(const SDL_FColor &color);
+        void SetNoFill();
+        void SetLineStyle(float width, const SDL_FColor &color);
+
+        // Path building, coordinates are in the owner's local space
+        void MoveTo(float x, float y);
+        void LineTo(float x, float y);
+        // Angles in degrees, clockwise on screen. Continues the current path, or starts one at the arc's first point.
+        void Arc(float centerX, float centerY, float radius, float startDegrees, float endDegrees);
+        void ClosePath();
+
+        // Complete closed paths of their own
+        void AddRect(float x, float y, float width, float height);
+        void AddCircle(float centerX, float centerY, float radius);
+        void AddEllipse(float centerX, float centerY, float radiusX, float radiusY);
+        // x, y pairs
+        void AddPolygon(const float *points, std::size_t pointCount);
+
+        std::size_t GetPathCount() const { return m_paths.size(); }
+        std::size_t GetTriangleCount();
+        std::size_t GetTessellationCount() const { return m_tessellationCount; }
+
+    private:
+        struct Path
+        {
+            std::vector<glm::vec2> points;
+            bool isClosed{false};
+            bool isFilled{false};
+            SDL_FColor fillColor{};
+            float lineWidth{0.0f};
+            SDL_FColor lineColor{};
+        };
+
+        Path &BeginPath();
+        // Retessellates, and redraws the bitmap caches of the owner and its ancestors
+        void MarkPathsChanged();
+        // Segments for an arc of radius and angle (radians) that stays within a fraction of a pixel of the curve
+        static int ArcSegments(float radius, float angle);
+
+        void Tessellate();
+        void TessellateFill(const Path &path);
+        void TessellateStroke(const Path &path);
+        void AddVertex(const glm::vec2 &position, const SDL_FColor &color);
+
+    private:
+        std::vector<Path> m_paths;
+        // A MoveTo or LineTo after a closed path starts a new one
+        bool m_isPathOpen{false};
+
+        RenderSortKey m_sortKey{};
+
+        bool m_isFilled{false};
+        SDL_FColor m_fillColor{1.0f, 1.0f, 1.0f, 1.0f};
+        float m_lineWidth{1.0f};
+        SDL_FColor m_lineColor{1.0f, 1.0f, 1.0f, 1.0f};
+
+        // Tessellated in local space, rebuilt when the paths change
+        bool m_isTessellationDirty{false};
+        std::vector<SDL_Vertex> m_localVertices;
+        std::vector<int> m_indices;
+        std::size_t m_tessellationCount{0};
+        // Box around m_localVertices
+        glm::vec2 m_localMin{0.0f};
+        glm::vec2 m_localMax{0.0f};
+        // Bumped with every change to the paths, see IBoundedRenderable
+        std::uint32_t m_boundsVersion{0};
+
+        // m_localVertices moved by m_worldMatrix, reused as long as both stay the same
+        std::vector<SDL_Vertex> m_worldVertices;
+        glm::mat4 m_worldMatrix{0.0f};
+        bool m_areWorldVerticesValid{false};
+    };
+} // namespace spark
+
+#endif // SHAPECOMPONENT_H
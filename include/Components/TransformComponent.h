@@ -8,6 +8,7 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtc/constants.hpp>
+#include <cstdint>
 namespace spark
 {
     class GameObject;
@@ -38,10 +39,21 @@ namespace spark
 
         glm::mat4 CalculateLocalMatrix() const;
         void SetDirtyRecursive();
+        bool IsDirty() const noexcept { return m_isDirty; }
+
+        // Used by Scene's transform propagation pass, which visits parents before children
+        // so the parent's cached world matrix is already up to date
+        void UpdateWorldMatrix(const glm::mat4 &parentWorldMatrix);
+        const glm::mat4 &GetCachedWorldMatrix() const noexcept { return m_worldMatrix; }
+        // Changes every time the world matrix is recomputed, lets caches of world space data tell they're stale
+        std::uint32_t GetWorldVersion() const noexcept { return m_worldVersion; }
 
         void RenderInspector() override;
 
     private:
+        // SetDirtyRecursive without invalidating the ancestors' bitmap caches again for every descendant
+        void MarkDirtyRecursive();
+
         // Local space properties
         glm::vec3 m_localPosition = glm::vec3(0.0f);
         glm::quat m_localRotation = glm::identity<glm::quat>();
@@ -50,6 +62,7 @@ namespace spark
         // World space cache
         mutable glm::mat4 m_worldMatrix = glm::identity<glm::mat4>();
         mutable bool m_isDirty = true;
+        mutable std::uint32_t m_worldVersion = 0;
     };
 } // namespace spark
 
@@ -0,0 +1,138 @@
+#ifndef CULLINGGRID_H
+#define CULLINGGRID_H
+
+#include <SDL3/SDL.h>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace spark
+{
+    // Sparse uniform grid of boxes for view culling. Unlike SpatialGrid it's updated in place: an entry is only
+    // moved between cells when its bounds cross into different ones, so static objects cost nothing once inserted
+    // and a query only touches the cells the area covers. Entries are small dense ids chosen by the caller.
+    // Boxes spanning many cells are kept in a separate list that every query reports.
+    class CullingGrid final
+    {
+    public:
+        explicit CullingGrid(float cellSize = 256.0f);
+
+        // Inserts the id, or moves it if it's already in the grid
+        void Update(std::uint32_t id, const SDL_FRect &bounds);
+        void Remove(std::uint32_t id);
+        bool Contains(std::uint32_t id) const noexcept { return id < m_entries.size() && m_entries[id].state != State::Absent; }
+        void Clear();
+
+        // Calls fn(id) once for every id in a cell overlapping area. That's a superset of the ids whose bounds
+        // overlap it, callers test the bounds themselves.
+        template <typename Fn>
+        void Query(const SDL_FRect &area, Fn &&fn);
+
+        std::size_t GetCellCount() const noexcept { return m_cells.size(); }
+
+    private:
+        // Entries covering more cells than this go to m_largeEntries instead
+        static constexpr int MaxCellsPerEntry = 64;
+
+        enum class State : std::uint8_t
+        {
+            Absent,
+            InCells,
+            Large
+        };
+
+        struct CellRange
+        {
+            int minX{0};
+            int minY{0};
+            int maxX{-1};
+            int maxY{-1};
+
+            bool operator==(const CellRange &other) const = default;
+            std::int64_t GetCellCount() const noexcept { return std::int64_t{maxX - minX + 1} * (maxY - minY + 1); }
+        };
+
+        struct Entry
+        {
+            CellRange range;
+            State state{State::Absent};
+            std::uint32_t queryStamp{0};
+        };
+
+        CellRange RangeOf(const SDL_FRect &bounds) const noexcept;
+        static std::uint64_t CellKey(int x, int y) noexcept;
+        void AddToCells(std::uint32_t id, const CellRange &range);
+        void RemoveFromCells(std::uint32_t id, const CellRange &range);
+
+    private:
+        float m_cellSize;
+        float m_invCellSize;
+        std::unordered_map<std::uint64_t, std::vector<std::uint32_t>> m_cells;
+        std::vector<Entry> m_entries; // by id
+        std::vector<std::uint32_t> m_largeEntries;
+        // Entries spanning several cells are seen once per cell, the stamp reports them only the first time
+        std::uint32_t m_queryStamp{0};
+    };
+
+    template <typename Fn>
+    void CullingGrid::Query(const SDL_FRect &area, Fn &&fn)
+    {
+        if (++m_queryStamp == 0)
+        {
+            for (Entry &entry : m_entries)
+            {
+                entry.queryStamp = 0;
+            }
+            m_queryStamp = 1;
+        }
+
+        const auto visitCell = [&](const std::vector<std::uint32_t> &ids)
+        {
+            for (std::uint32_t id : ids)
+            {
+                Entry &entry = m_entries[id];
+                if (entry.queryStamp != m_queryStamp)
+                {
+                    entry.queryStamp = m_queryStamp;
+                    fn(id);
+                }
+            }
+        };
+
+        const CellRange range = RangeOf(area);
+        if (range.GetCellCount() > static_cast<std::int64_t>(m_cells.size()))
+        {
+            // Zoomed far out, walking the occupied cells is cheaper than probing every cell in the area
+            for (const auto &[key, ids] : m_cells)
+            {
+                const int x = static_cast<int>(static_cast<std::int32_t>(key >> 32));
+                const int y = static_cast<int>(static_cast<std::int32_t>(key & 0xFFFFFFFFu));
+                if (x >= range.minX && x <= range.maxX && y >= range.minY && y <= range.maxY)
+                {
+                    visitCell(ids);
+                }
+            }
+        }
+        else
+        {
+            for (int y = range.minY; y <= range.maxY; ++y)
+            {
+                for (int x = range.minX; x <= range.maxX; ++x)
+                {
+                    if (auto it = m_cells.find(CellKey(x, y)); it != m_cells.end())
+                    {
+                        visitCell(it->second);
+                    }
+                }
+            }
+        }
+
+        for (std::uint32_t id : m_largeEntries)
+        {
+            fn(id);
+        }
+    }
+} // namespace spark
+
+#endif // CULLINGGRID_H
@@ -6,6 +6,8 @@
 #include <memory>
 #include "SceneGraphPanel.h"
 #include "InspectorPanel.h"
+#include "ProfilerPanel.h"
+#include "GameObjectHandle.h"
 #include <string>
 #include <iostream>
 
@@ -35,8 +37,10 @@ namespace spark
         void RenderPlaybackControls();
         std::unique_ptr<SceneGraphPanel> m_sceneGraphPanel;
         std::unique_ptr<InspectorPanel> m_inspectorPanel;
+        std::unique_ptr<ProfilerPanel> m_profilerPanel;
 
-        GameObject *m_selectedGameObject{nullptr};
+        // Held as a handle so a deleted selection resolves to null instead of dangling
+        GameObjectHandle m_selectedGameObject{};
         bool m_isPlaying{};
         float m_fontSize{20.0f};
     };
@@ -0,0 +1,60 @@
+#ifndef FLOATBUFFER_H
+#define FLOATBUFFER_H
+
+#include <cstddef>
+#include <vector>
+
+namespace spark
+{
+    // Contiguous array of floats grouped into elements of `stride` components (stride 2 = array of vec2).
+    // Exposed to Lua as FloatBuffer / Vec2Array so scripts can keep thousands of entities in native memory
+    // and update them in place instead of allocating a vec3 usertype per operation.
+    // Indices are 0-based, out of range reads return 0 and out of range writes are ignored.
+    class FloatBuffer final
+    {
+    public:
+        explicit FloatBuffer(std::size_t count = 0, std::size_t stride = 1);
+
+        std::size_t GetCount() const noexcept { return m_stride ? m_data.size() / m_stride : 0; }
+        std::size_t GetStride() const noexcept { return m_stride; }
+        std::size_t GetFloatCount() const noexcept { return m_data.size(); }
+        float *Data() noexcept { return m_data.data(); }
+        const float *Data() const noexcept { return m_data.data(); }
+
+        // Flat access, index counts floats
+        float Get(std::size_t index) const noexcept;
+        void Set(std::size_t index, float value) noexcept;
+
+        // Element access, index counts elements
+        float GetComponent(std::size_t element, std::size_t component) const noexcept;
+        void SetComponent(std::size_t element, std::size_t component, float value) noexcept;
+
+        void Resize(std::size_t count);
+        void Reserve(std::size_t count);
+        void Clear() noexcept { m_data.clear(); }
+        // Appends one element, missing components are 0
+        void Push(const float *values, std::size_t valueCount);
+        // O(1) removal that moves the last element into the hole
+        void SwapRemove(std::size_t element) noexcept;
+        void CopyFrom(const FloatBuffer &other);
+
+        // --- In-place math over every float (or one component of every element) ---
+
+        void Fill(float value) noexcept;
+        void Scale(float scale) noexcept;
+        // this += other * scale, over the shared length
+        void AddScaled(const FloatBuffer &other, float scale) noexcept;
+        void Clamp(float minValue, float maxValue) noexcept;
+        void Wrap(float minValue, float maxValue) noexcept;
+        void ClampComponent(std::size_t component, float minValue, float maxValue) noexcept;
+        void WrapComponent(std::size_t component, float minValue, float maxValue) noexcept;
+        // Limits the length of every element treated as a vector
+        void ClampLength(float maxLength) noexcept;
+
+    private:
+        std::vector<float> m_data;
+        std::size_t m_stride{1};
+    };
+} // namespace spark
+
+#endif // FLOATBUFFER_H
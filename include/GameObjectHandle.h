@@ -0,0 +1,25 @@
+#ifndef GAMEOBJECTHANDLE_H
+#define GAMEOBJECTHANDLE_H
+
+#include <cstdint>
+
+namespace spark
+{
+    // Weak reference to a GameObject: a slot in the scene's handle table plus the generation the slot had when the
+    // object was registered. Once the object is destroyed the slot's generation moves on and the handle resolves
+    // to null instead of dangling. The scene id keeps another scene from resolving it to whatever sits in its own
+    // slot with that number. See Scene::Resolve.
+    struct GameObjectHandle
+    {
+        static constexpr std::uint32_t InvalidIndex = ~std::uint32_t{0};
+
+        std::uint32_t index{InvalidIndex};
+        std::uint32_t generation{0};
+        std::uint32_t sceneId{0}; // Scene::GetId of the scene that issued it, ids start at 1
+
+        bool IsNull() const noexcept { return index == InvalidIndex; }
+        friend bool operator==(const GameObjectHandle &a, const GameObjectHandle &b) = default;
+    };
+} // namespace spark
+
+#endif // GAMEOBJECTHANDLE_H
@@ -0,0 +1,58 @@
+#ifndef GAMETIME_H
+#define GAMETIME_H
+
+#include "Singleton.h"
+
+namespace spark
+{
+    // Frame clock plus the accumulator behind FixedUpdate. Each frame Advance banks the real frame time and
+    // returns how many fixed steps to run; whatever is left over becomes the interpolation alpha, the fraction
+    // of a step the rendered frame lies past the last simulated state.
+    class GameTime final : public Singleton<GameTime>
+    {
+        friend class Singleton<GameTime>;
+
+    public:
+        // With the fixed step disabled FixedUpdate runs once per frame with the frame's dt (capped at max substeps
+        // fixed steps) and alpha stays 1
+        void SetFixedTimestepEnabled(bool enabled);
+        bool IsFixedTimestepEnabled() const { return m_isFixedTimestepEnabled; }
+
+        void SetFixedRate(float hz);
+        float GetFixedRate() const { return 1.0f / m_fixedDeltaTime; }
+        float GetFixedDeltaTime() const { return m_fixedDeltaTime; }
+
+        // Steps per frame are capped so a slow frame can't snowball into ever longer catch-up frames,
+        // time beyond the cap is dropped and the simulation runs slower than real time instead
+        void SetMaxSubsteps(int maxSubsteps) { m_maxSubsteps = maxSubsteps < 1 ? 1 : maxSubsteps; }
+        int GetMaxSubsteps() const { return m_maxSubsteps; }
+
+        // Returns the number of FixedUpdate steps to run this frame
+        int Advance(float frameDt);
+
+        // Real time of the frame being processed
+        float GetDeltaTime() const { return m_deltaTime; }
+        // Simulated time, advanced by each fixed step
+        double GetFixedTime() const { return m_fixedTime; }
+        // Step length to pass to FixedUpdate, the frame dt while the fixed step is disabled
+        float GetStepDeltaTime() const { return m_isFixedTimestepEnabled ? m_fixedDeltaTime : m_variableStep; }
+        // In [0, 1), blend previous and current simulated state by this when rendering. 1 with the fixed step off.
+        float GetInterpolationAlpha() const { return m_interpolationAlpha; }
+
+    private:
+        GameTime() = default;
+
+    private:
+        bool m_isFixedTimestepEnabled{true};
+        float m_fixedDeltaTime{1.0f / 60.0f};
+        int m_maxSubsteps{5};
+
+        float m_deltaTime{};
+        float m_variableStep{};
+        double m_accumulator{};
+        double m_fixedTime{};
+        float m_interpolationAlpha{1.0f};
+    };
+} // namespace spark
+
+#endif // GAMETIME_H
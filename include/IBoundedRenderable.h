@@ -0,0 +1,23 @@
+#ifndef IBOUNDEDRENDERABLE_H
+#define IBOUNDEDRENDERABLE_H
+
+#include "IRenderable.h"
+#include <SDL3/SDL.h>
+#include <cstdint>
+
+namespace spark
+{
+    // A renderable that knows where it draws. With a camera, the scene only calls Render on the ones whose
+    // bounds overlap the view, renderables without bounds (like scripts) are always drawn.
+    struct IBoundedRenderable : IRenderable
+    {
+        // Axis aligned box in world space around everything Render draws, false if it draws nothing
+        virtual bool GetWorldBounds(SDL_FRect &bounds) = 0;
+        // Has to change whenever the bounds can change for a reason other than the owner's transform moving.
+        // While neither changes the scene keeps the bounds it got last time.
+        virtual std::uint32_t GetBoundsVersion() const = 0;
+    };
+
+} // namespace spark
+
+#endif // IBOUNDEDRENDERABLE_H
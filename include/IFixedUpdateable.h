@@ -0,0 +1,15 @@
+#ifndef IFIXEDUPDATEABLE_H
+#define IFIXEDUPDATEABLE_H
+
+namespace spark
+{
+    // Called zero or more times per frame with a constant step, see GameTime
+    struct IFixedUpdateable
+    {
+        virtual ~IFixedUpdateable() = default;
+        virtual void FixedUpdate(float fixedDt) = 0;
+    };
+
+} // namespace spark
+
+#endif // IFIXEDUPDATEABLE_H
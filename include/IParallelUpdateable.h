@@ -0,0 +1,16 @@
+#ifndef IPARALLELUPDATEABLE_H
+#define IPARALLELUPDATEABLE_H
+
+namespace spark
+{
+    // Marks an IUpdateable whose Update only touches its own GameObject and never calls into Lua or SDL.
+    // Root subtrees made only of such updateables are updated on worker threads, see Scene::Update.
+    // Structural changes made from there are recorded into the thread's CommandBuffer.
+    struct IParallelUpdateable
+    {
+        virtual ~IParallelUpdateable() = default;
+    };
+
+} // namespace spark
+
+#endif // IPARALLELUPDATEABLE_H
@@ -1,12 +1,24 @@
 #ifndef IRENDERABLE_H
 #define IRENDERABLE_H
 
+#include <cstdint>
+
 namespace spark
 {
+    // Where a renderable's draws land in the Renderer's sorted command list. Lower layers are drawn first,
+    // within a layer lower depths are. See Renderer::SetSortKey.
+    struct RenderSortKey
+    {
+        std::int8_t layer{0};
+        float depth{0.0f};
+    };
+
     struct IRenderable
     {
         virtual ~IRenderable() = default;
         virtual void Render() = 0;
+        // Set on the Renderer before Render is called
+        virtual RenderSortKey GetSortKey() const { return {}; }
     };
 
 } // namespace spark
@@ -0,0 +1,165 @@
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#include "Singleton.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Browsers only get threads when the build opts into pthreads (-pthread), otherwise everything runs inline
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+#define SPARK_JOBS_SINGLE_THREADED
+#endif
+
+namespace spark
+{
+    // Range job entry point, data is whatever the scheduling call passed along
+    using JobFunction = void (*)(void *data, std::size_t begin, std::size_t end);
+
+    struct JobCounter;
+
+    struct Job
+    {
+        JobFunction function;
+        void *data;
+        std::size_t begin;
+        std::size_t end;
+        JobCounter *counter; // decremented when the job finishes, may be null
+    };
+
+    // Counts unfinished jobs. Wait on it, or make other jobs depend on it reaching zero.
+    // Must outlive every job that references it.
+    struct JobCounter
+    {
+        // Only says the jobs finished: the last one may still hold mutex, so this alone doesn't mean the counter can
+        // be destroyed. Use IsReleasable or JobSystem::Wait for that.
+        bool IsDone() const { return pending.load(std::memory_order_acquire) == 0; }
+        // Done, and the last job has left Execute, so the counter may be destroyed. Never blocks, false while the
+        // last job is still finishing up.
+        bool IsReleasable()
+        {
+            if (!IsDone())
+            {
+                return false;
+            }
+            const std::unique_lock lock{mutex, std::try_to_lock};
+            return lock.owns_lock();
+        }
+
+        std::atomic<int> pending{0};
+        std::mutex mutex;
+        std::vector<Job> continuations; // jobs released once pending drops to zero
+    };
+
+    // Work-stealing scheduler. Every worker owns a deque: it pushes and pops at the back (newest first, warm in cache),
+    // idle workers steal from the front of someone else's (oldest first, usually the biggest chunks of work).
+    // Threads outside the pool push into slot 0, which the calling thread drains itself while it waits.
+    // Background jobs sit in a queue of their own that workers only turn to when there's nothing else to do.
+    // Jobs must not touch Lua or SDL, both are main thread only.
+    class JobSystem final : public Singleton<JobSystem>
+    {
+        friend class Singleton<JobSystem>;
+
+    public:
+        ~JobSystem();
+
+        JobSystem(const JobSystem &other) = delete;
+        JobSystem &operator=(const JobSystem &other) = delete;
+
+        // Threads besides the caller, 0 when running single-threaded
+        std::size_t GetWorkerCount() const { return m_workers.size(); }
+        // Workers plus the threads outside the pool, which share index 0
+        std::size_t GetThreadCount() const { return m_workers.size() + 1; }
+        // In [0, GetThreadCount()), for per-thread scratch data in jobs
+        static std::size_t GetCurrentThreadIndex();
+
+        // Runs task on some thread. With a dependency it only starts once that counter reaches zero.
+        void Schedule(std::function<void()> task, JobCounter &counter, JobCounter *dependency = nullptr);
+        void Schedule(const Job &job, JobCounter *dependency = nullptr);
+        // For long jobs nothing in the frame waits on, such as decoding assets. Run first in, first out.
+        void ScheduleBackground(std::function<void()> task, JobCounter &counter);
+
+        // Helps run jobs until counter reaches zero. Of the background jobs it only runs counter's own, so waiting on
+        // a frame's work never stalls the caller behind some unrelated decode.
+        void Wait(JobCounter &counter);
+
+        // Calls fn(rangeBegin, rangeEnd) over [begin, end) split into chunks of at least grainSize, and returns once
+        // all of them are done. The calling thread takes a chunk too. Small ranges run inline without scheduling.
+        template <typename Fn>
+        void ParallelFor(std::size_t begin, std::size_t end, std::size_t grainSize, Fn &&fn)
+        {
+            if (end <= begin)
+            {
+                return;
+            }
+
+            const std::size_t count = end - begin;
+            grainSize = grainSize ? grainSize : 1;
+            if (m_workers.empty() || count <= grainSize)
+            {
+                fn(begin, end);
+                return;
+            }
+
+            // A few chunks per thread, so a thread that's briefly busy elsewhere doesn't hold up the whole loop
+            const std::size_t maxChunks = (m_workers.size() + 1) * 4;
+            const std::size_t chunkCount = std::min((count + grainSize - 1) / grainSize, maxChunks);
+            const std::size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+
+            using FnType = std::remove_reference_t<Fn>;
+            JobCounter counter;
+            for (std::size_t chunkBegin = begin + chunkSize; chunkBegin < end; chunkBegin += chunkSize)
+            {
+                Schedule(Job{&InvokeRange<FnType>, const_cast<void *>(static_cast<const void *>(&fn)), chunkBegin,
+                             std::min(chunkBegin + chunkSize, end), &counter});
+            }
+            fn(begin, std::min(begin + chunkSize, end));
+            Wait(counter);
+        }
+
+    private:
+        JobSystem();
+
+        struct alignas(64) WorkQueue
+        {
+            std::mutex mutex;
+            std::deque<Job> jobs;
+        };
+
+        template <typename Fn>
+        static void InvokeRange(void *data, std::size_t begin, std::size_t end)
+        {
+            (*static_cast<Fn *>(data))(begin, end);
+        }
+
+        static void InvokeTask(void *data, std::size_t begin, std::size_t end);
+
+        void Push(const Job &job);
+        bool TryRunOne(std::size_t queueIndex);
+        // Oldest background job, or with only set the oldest one counting down that counter
+        bool TryRunBackground(const JobCounter *only);
+        void Execute(const Job &job);
+        void WorkerLoop(std::size_t queueIndex);
+
+    private:
+        std::vector<std::unique_ptr<WorkQueue>> m_queues; // 0 is shared by threads outside the pool
+        WorkQueue m_backgroundQueue;
+        std::vector<std::thread> m_workers;
+
+        std::atomic<std::size_t> m_queuedJobs{0};
+        std::atomic<bool> m_isRunning{true};
+        std::mutex m_sleepMutex;
+        std::condition_variable m_wakeCondition;
+    };
+} // namespace spark
+
+#endif // JOBSYSTEM_H
@@ -2,6 +2,7 @@
 #define LUAINSTANCE_H
 
 #include "Singleton.h"
+#include "LuaProfiler.h"
 #include <sol/sol.hpp>
 namespace spark
 {
@@ -15,12 +16,14 @@ namespace spark
 
         void Init();
         sol::state &GetState() { return m_Lua; }
+        LuaProfiler &GetProfiler() { return m_profiler; }
 
     private:
         friend Singleton<LuaInstance>;
         LuaInstance() = default;
         void SetupBindings();
         sol::state m_Lua;
+        LuaProfiler m_profiler;
     };
 } // namespace spark
 
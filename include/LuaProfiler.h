@@ -0,0 +1,108 @@
+#ifndef LUAPROFILER_H
+#define LUAPROFILER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct lua_State;
+struct lua_Debug;
+
+namespace spark
+{
+    // Sampling profiler for the shared Lua state. While any script has profiling enabled a count hook fires every
+    // few hundred VM instructions, and the wall time since the previous sample is charged to the current Lua stack
+    // of whichever script is running. With no script enabled the hook is removed, so there's no cost at all.
+    // Scripts are identified by path, results can be exported as collapsed stacks for flamegraph tools.
+    class LuaProfiler final
+    {
+    public:
+        struct LineStats
+        {
+            std::string function;
+            std::string location; // source:line
+            std::uint64_t selfNs{};
+            std::uint32_t samples{};
+        };
+
+        void Attach(lua_State *L) { m_state = L; }
+
+        void SetScriptEnabled(const std::string &scriptPath, bool enabled);
+        bool IsScriptEnabled(const std::string &scriptPath) const;
+        // True while the hook is installed
+        bool IsActive() const { return m_enabledScripts > 0; }
+
+        // VM instructions between samples, smaller is more precise and more expensive
+        void SetSampleInterval(int instructions);
+        int GetSampleInterval() const { return m_sampleInterval; }
+
+        // Brackets a call into a script so samples are charged to it, see LuaProfileScope. Calls nest, a script
+        // calling into another one gets its samples back once the inner call leaves.
+        void EnterScript(const std::string &scriptPath);
+        void LeaveScript();
+
+        std::uint64_t GetTotalNs(const std::string &scriptPath) const;
+        std::uint32_t GetSampleCount(const std::string &scriptPath) const;
+        // Lines sorted by self time, most expensive first
+        std::vector<LineStats> GetTopLines(const std::string &scriptPath, std::size_t maxLines) const;
+        void Reset(const std::string &scriptPath);
+
+        // One "outer;...;inner microseconds" line per distinct stack, as read by flamegraph.pl / speedscope
+        void ExportCollapsed(const std::string &scriptPath, std::ostream &out) const;
+        bool WriteCollapsedFile(const std::string &scriptPath, const std::string &filePath) const;
+
+    private:
+        struct ScriptProfile
+        {
+            bool isEnabled{false};
+            std::uint64_t totalNs{};
+            std::uint32_t samples{};
+            std::unordered_map<std::string, std::uint64_t> stacks;
+            std::unordered_map<std::string, LineStats> lines;
+        };
+
+        static void Hook(lua_State *L, lua_Debug *ar);
+        void Sample(lua_State *L);
+        void UpdateHook();
+
+    private:
+        lua_State *m_state{nullptr};
+        int m_sampleInterval{1000};
+        int m_enabledScripts{0};
+
+        std::unordered_map<std::string, ScriptProfile> m_scripts;
+        ScriptProfile *m_currentScript{nullptr};
+        std::vector<ScriptProfile *> m_enclosingScripts; // the scripts EnterScript interrupted, innermost last
+        std::uint64_t m_lastSampleNs{};
+        // Reused by every sample so taking one doesn't allocate once the strings have grown
+        std::string m_stackScratch;
+        std::string m_locationScratch;
+    };
+
+    // Charges samples taken during its lifetime to scriptPath, does nothing unless the profiler is active
+    class LuaProfileScope final
+    {
+    public:
+        LuaProfileScope(LuaProfiler &profiler, const std::string &scriptPath) : m_profiler{profiler.IsActive() ? &profiler : nullptr}
+        {
+            if (m_profiler)
+                m_profiler->EnterScript(scriptPath);
+        }
+        ~LuaProfileScope()
+        {
+            if (m_profiler)
+                m_profiler->LeaveScript();
+        }
+
+        LuaProfileScope(const LuaProfileScope &other) = delete;
+        LuaProfileScope &operator=(const LuaProfileScope &other) = delete;
+
+    private:
+        LuaProfiler *m_profiler;
+    };
+} // namespace spark
+
+#endif // LUAPROFILER_H
@@ -0,0 +1,94 @@
+#ifndef NBODYSOLVER_H
+#define NBODYSOLVER_H
+
+#include "FloatBuffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace spark
+{
+    enum class NBodyMethod
+    {
+        Auto,     // direct below the direct threshold, Barnes-Hut above it
+        Direct,   // exact O(n^2) sum
+        BarnesHut // O(n log n) quadtree approximation
+    };
+
+    // 2D gravity solver. Acceleration on body i is G * sum(m_j * r_ij / (|r_ij|^2 + softening^2)^(3/2)).
+    // Positions are read as the first two components of each element of a strided array (a Vec2Array works as is),
+    // masses as one float per body.
+    class NBodySolver final
+    {
+    public:
+        NBodySolver() = default;
+
+        void SetGravitationalConstant(float g) { m_gravitationalConstant = g; }
+        float GetGravitationalConstant() const { return m_gravitationalConstant; }
+        // Opening angle: a tree node is treated as one body when size / distance < theta. 0 makes the tree exact.
+        void SetTheta(float theta) { m_theta = theta < 0.0f ? 0.0f : theta; }
+        float GetTheta() const { return m_theta; }
+        // Keeps close encounters finite, in world units
+        void SetSoftening(float softening) { m_softening = softening; }
+        float GetSoftening() const { return m_softening; }
+        void SetDirectThreshold(std::size_t count) { m_directThreshold = count; }
+        std::size_t GetDirectThreshold() const { return m_directThreshold; }
+
+        // Writes ax, ay per body into accelerations (2 * count floats)
+        void ComputeAccelerations(const float *positions, std::size_t positionStride, const float *masses, std::size_t count,
+                                  float *accelerations, NBodyMethod method = NBodyMethod::Auto);
+
+        // FloatBuffer convenience: accelerations is resized to count elements of stride 2
+        void ComputeAccelerations(const FloatBuffer &positions, const FloatBuffer &masses, FloatBuffer &accelerations,
+                                  NBodyMethod method = NBodyMethod::Auto);
+        // Semi-implicit Euler: v += a * dt, p += v * dt over the bodies all three buffers cover
+        void Step(FloatBuffer &positions, FloatBuffer &velocities, const FloatBuffer &masses, float dt,
+                  NBodyMethod method = NBodyMethod::Auto);
+
+        std::size_t GetTreeNodeCount() const { return m_nodes.size(); }
+
+    private:
+        struct Node
+        {
+            float centerX;
+            float centerY;
+            float halfSize;
+            float massX; // mass-weighted position sum while building, center of mass afterwards
+            float massY;
+            float mass;
+            std::int32_t firstChild; // 4 consecutive children, -1 for a leaf
+            std::int32_t firstBody;  // while building: head of a list through m_nextBody, after: offset into m_tree*
+            std::int32_t bodyCount;
+        };
+
+        void LoadBodies(const float *positions, std::size_t positionStride, const float *masses, std::size_t count);
+        void ComputeDirectRange(std::size_t begin, std::size_t end, float *accelerations) const;
+        void BuildTree();
+        void InsertBody(std::int32_t body, std::int32_t node, int depth);
+        void SplitLeaf(std::int32_t node, int depth);
+        std::int32_t ChildFor(const Node &node, float x, float y) const;
+        void ComputeTreeRange(std::size_t begin, std::size_t end, float *accelerations) const;
+
+    private:
+        float m_gravitationalConstant{1.0f};
+        float m_theta{0.5f};
+        float m_softening{1.0f};
+        std::size_t m_directThreshold{512};
+
+        // Bodies copied into separate arrays so the inner loops read contiguous floats
+        std::vector<float> m_x;
+        std::vector<float> m_y;
+        std::vector<float> m_mass;
+        std::vector<Node> m_nodes;
+        std::vector<std::int32_t> m_nextBody;
+        // Bodies regrouped leaf by leaf after the build, m_treeOrder maps back to the caller's indices
+        std::vector<std::int32_t> m_treeOrder;
+        std::vector<float> m_treeX;
+        std::vector<float> m_treeY;
+        std::vector<float> m_treeMass;
+        std::vector<float> m_accelerationScratch;
+    };
+} // namespace spark
+
+#endif // NBODYSOLVER_H
@@ -0,0 +1,212 @@
+#ifndef OBJECTPOOL_H
+#define OBJECTPOOL_H
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace spark
+{
+    // Generational reference into an ObjectPool. Stays safe to resolve after the object is destroyed
+    // (Resolve returns nullptr once the slot has been reused or freed).
+    struct PoolHandle
+    {
+        std::uint32_t index{UINT32_MAX};
+        std::uint32_t generation{0};
+
+        bool IsNull() const noexcept { return index == UINT32_MAX; }
+        bool operator==(const PoolHandle &other) const noexcept = default;
+    };
+
+    // Per-type storage: objects of T live in fixed-size chunks that are never moved or freed while the pool
+    // is alive, so pointers stay stable and objects of the same type sit next to each other in memory.
+    // Freed slots are reused LIFO, the most recently freed one is the likeliest to still be in cache. That says
+    // nothing about where live objects end up: after churn they are scattered across every chunk allocated so far.
+    // Not thread-safe: allocate and free from the main thread only.
+    template <typename T, std::size_t ChunkSize = 256>
+    class ObjectPool final
+    {
+    public:
+        static ObjectPool &GetInstance()
+        {
+            // Intentionally never destroyed: objects owned by other singletons (e.g. SceneManager)
+            // are still released back into the pool during static destruction.
+            static ObjectPool *instance = new ObjectPool{};
+            return *instance;
+        }
+
+        ObjectPool(const ObjectPool &other) = delete;
+        ObjectPool(ObjectPool &&other) = delete;
+        ObjectPool &operator=(const ObjectPool &other) = delete;
+        ObjectPool &operator=(ObjectPool &&other) = delete;
+
+        // Raw storage for one T, the slot is considered live until Deallocate
+        void *Allocate()
+        {
+            if (m_freeList.empty())
+            {
+                AddChunk();
+            }
+
+            std::uint32_t index = m_freeList.back();
+            m_freeList.pop_back();
+            m_live[index] = 1;
+            ++m_liveCount;
+            return SlotAt(index);
+        }
+
+        void Deallocate(void *ptr)
+        {
+            if (!ptr)
+                return;
+
+            std::uint32_t index = IndexOf(ptr);
+            assert(index != UINT32_MAX && m_live[index] && "pointer does not belong to this pool");
+            if (index == UINT32_MAX || !m_live[index])
+                return;
+
+            m_live[index] = 0;
+            ++m_generations[index];
+            --m_liveCount;
+            m_freeList.push_back(index);
+        }
+
+        template <typename... Args>
+        T *Create(Args &&...args)
+        {
+            void *storage = Allocate();
+            try
+            {
+                return ::new (storage) T(std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                Deallocate(storage);
+                throw;
+            }
+        }
+
+        void Destroy(T *ptr)
+        {
+            if (!ptr)
+                return;
+            ptr->~T();
+            Deallocate(ptr);
+        }
+
+        PoolHandle GetHandle(const T *ptr) const
+        {
+            std::uint32_t index = IndexOf(ptr);
+            if (index == UINT32_MAX || !m_live[index])
+            {
+                return {};
+            }
+            return {index, m_generations[index]};
+        }
+
+        T *Resolve(PoolHandle handle) const
+        {
+            if (handle.index >= m_live.size() || !m_live[handle.index] || m_generations[handle.index] != handle.generation)
+            {
+                return nullptr;
+            }
+            return static_cast<T *>(SlotAt(handle.index));
+        }
+
+        // Visits live objects in storage order. Only valid for pools filled through Create.
+        template <typename Fn>
+        void ForEach(Fn &&fn)
+        {
+            for (std::uint32_t index = 0; index < m_live.size(); ++index)
+            {
+                if (m_live[index])
+                {
+                    fn(*static_cast<T *>(SlotAt(index)));
+                }
+            }
+        }
+
+        std::size_t Size() const noexcept { return m_liveCount; }
+        std::size_t Capacity() const noexcept { return m_live.size(); }
+
+    private:
+        ObjectPool() = default;
+        ~ObjectPool() = default;
+
+        struct alignas(T) Slot
+        {
+            std::byte storage[sizeof(T)];
+        };
+        using Chunk = std::array<Slot, ChunkSize>;
+
+        void AddChunk()
+        {
+            auto chunk = std::make_unique<Chunk>();
+            const std::uint32_t firstIndex = static_cast<std::uint32_t>(m_chunks.size() * ChunkSize);
+
+            // Keep the lookup table sorted by address so IndexOf is a binary search
+            ChunkRange range{reinterpret_cast<std::uintptr_t>(chunk->data()), static_cast<std::uint32_t>(m_chunks.size())};
+            m_chunkRanges.insert(std::upper_bound(m_chunkRanges.begin(), m_chunkRanges.end(), range,
+                                                  [](const ChunkRange &a, const ChunkRange &b)
+                                                  { return a.begin < b.begin; }),
+                                 range);
+            m_chunks.emplace_back(std::move(chunk));
+
+            m_live.resize(m_live.size() + ChunkSize, 0);
+            m_generations.resize(m_generations.size() + ChunkSize, 0);
+
+            // Push in reverse so the lowest index is handed out first
+            m_freeList.reserve(m_freeList.size() + ChunkSize);
+            for (std::uint32_t i = ChunkSize; i > 0; --i)
+            {
+                m_freeList.push_back(firstIndex + i - 1);
+            }
+        }
+
+        void *SlotAt(std::uint32_t index) const
+        {
+            return (*m_chunks[index / ChunkSize])[index % ChunkSize].storage;
+        }
+
+        std::uint32_t IndexOf(const void *ptr) const
+        {
+            const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(ptr);
+            auto it = std::upper_bound(m_chunkRanges.begin(), m_chunkRanges.end(), address,
+                                       [](std::uintptr_t value, const ChunkRange &range)
+                                       { return value < range.begin; });
+            if (it == m_chunkRanges.begin())
+            {
+                return UINT32_MAX;
+            }
+            --it;
+
+            const std::uintptr_t offset = address - it->begin;
+            if (offset >= sizeof(Chunk) || offset % sizeof(Slot) != 0)
+            {
+                return UINT32_MAX;
+            }
+            return static_cast<std::uint32_t>(it->chunk * ChunkSize + offset / sizeof(Slot));
+        }
+
+        struct ChunkRange
+        {
+            std::uintptr_t begin;
+            std::uint32_t chunk;
+        };
+
+        std::vector<std::unique_ptr<Chunk>> m_chunks{};
+        std::vector<ChunkRange> m_chunkRanges{};
+        std::vector<std::uint8_t> m_live{};
+        std::vector<std::uint32_t> m_generations{};
+        std::vector<std::uint32_t> m_freeList{};
+        std::size_t m_liveCount{0};
+    };
+} // namespace spark
+
+#endif // OBJECTPOOL_H
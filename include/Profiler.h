@@ -0,0 +1,143 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "Singleton.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace spark
+{
+    // Interned zone name, cheap to store per zone and to compare
+    using ProfileLabel = std::uint32_t;
+    inline constexpr ProfileLabel InvalidProfileLabel = ~ProfileLabel{0};
+
+    struct ProfileZone
+    {
+        ProfileLabel label;
+        std::uint32_t threadIndex; // small per-thread number, 0 is the first thread that recorded a zone
+        std::uint32_t depth;       // nesting level on its thread, 0 for outermost
+        std::uint64_t startNs;
+        std::uint64_t endNs;
+    };
+
+    struct ProfileFrame
+    {
+        std::uint64_t frameIndex{};
+        std::uint64_t startNs{};
+        std::uint64_t endNs{};
+        std::vector<ProfileZone> zones; // ordered by start time per thread, parents before their children
+        std::uint32_t droppedZones{};
+    };
+
+    // Hierarchical CPU profiler. Zones are recorded per thread without locking and handed over at EndFrame into a
+    // ring of the last FrameHistory frames. The ring has a single writer (whoever calls EndFrame) that publishes
+    // each finished frame with one atomic store, readers only touch published frames.
+    // EndFrame expects no zone to be open on other threads.
+    class Profiler final : public Singleton<Profiler>
+    {
+        friend class Singleton<Profiler>;
+
+    public:
+        static constexpr std::size_t FrameHistory = 240;
+        // Per thread per frame, further zones are counted as dropped (keeps memory bounded when frames aren't ended)
+        static constexpr std::size_t MaxZonesPerFrame = 1 << 16;
+
+        ProfileLabel InternLabel(std::string_view name);
+        // Stays valid for the lifetime of the profiler
+        const char *GetLabelName(ProfileLabel label) const;
+
+        // Takes effect at the next BeginFrame, so zones never open and close under different settings
+        void SetEnabled(bool enabled) { m_isEnabled.store(enabled, std::memory_order_relaxed); }
+        bool IsEnabled() const { return m_isEnabled.load(std::memory_order_relaxed); }
+
+        // Returns false when the zone isn't recorded, in which case EndZone must not be called for it
+        bool BeginZone(ProfileLabel label);
+        void EndZone();
+
+        void BeginFrame();
+        void EndFrame();
+
+        // Frames published so far, the last min(count, FrameHistory) of them can be read
+        std::uint64_t GetFrameCount() const { return m_publishedFrames.load(std::memory_order_acquire); }
+        // frameIndex must be within the last FrameHistory published frames
+        const ProfileFrame &GetFrame(std::uint64_t frameIndex) const { return m_frames[frameIndex % FrameHistory]; }
+        const ProfileFrame *GetLatestFrame() const;
+
+        static std::uint64_t NowNs();
+
+    private:
+        Profiler() = default;
+
+        struct ThreadState
+        {
+            std::uint32_t threadIndex{};
+            std::vector<ProfileZone> zones;
+            std::vector<std::uint32_t> openZones; // indices into zones
+            std::uint32_t droppedZones{};
+        };
+
+        ThreadState &GetThreadState();
+
+    private:
+        std::atomic<bool> m_isEnabled{true};
+        std::atomic<bool> m_isRecording{true};
+
+        mutable std::mutex m_labelMutex;
+        std::unordered_map<std::string, ProfileLabel> m_labelIds;
+        std::deque<std::string> m_labelNames;
+
+        std::mutex m_threadMutex;
+        std::vector<std::unique_ptr<ThreadState>> m_threads;
+
+        std::uint64_t m_frameStartNs{};
+        std::array<ProfileFrame, FrameHistory> m_frames{};
+        std::atomic<std::uint64_t> m_publishedFrames{0};
+    };
+
+    // RAII zone, the usual way to record one
+    class ProfileScope final
+    {
+    public:
+        explicit ProfileScope(ProfileLabel label) : m_isRecorded{Profiler::GetInstance().BeginZone(label)} {}
+        ~ProfileScope()
+        {
+            if (m_isRecorded)
+                Profiler::GetInstance().EndZone();
+        }
+
+        ProfileScope(const ProfileScope &other) = delete;
+        ProfileScope &operator=(const ProfileScope &other) = delete;
+
+    private:
+        bool m_isRecorded;
+    };
+} // namespace spark
+
+#define SPARK_PROFILE_CONCAT_INNER(a, b) a##b
+#define SPARK_PROFILE_CONCAT(a, b) SPARK_PROFILE_CONCAT_INNER(a, b)
+
+#ifndef SPARK_DISABLE_PROFILER
+// Zone with a fixed name, interned once per call site
+#define SPARK_PROFILE_SCOPE(name)                                                                                                  \
+    static const ::spark::ProfileLabel SPARK_PROFILE_CONCAT(sparkProfileLabel_, __LINE__) =                                        \
+        ::spark::Profiler::GetInstance().InternLabel(name);                                                                        \
+    const ::spark::ProfileScope SPARK_PROFILE_CONCAT(sparkProfileScope_, __LINE__) { SPARK_PROFILE_CONCAT(sparkProfileLabel_, __LINE__) }
+// Zone with a label interned beforehand, for names only known at runtime
+#define SPARK_PROFILE_SCOPE_LABEL(label) \
+    const ::spark::ProfileScope SPARK_PROFILE_CONCAT(sparkProfileScope_, __LINE__) { label }
+#else
+#define SPARK_PROFILE_SCOPE(name)
+#define SPARK_PROFILE_SCOPE_LABEL(label)
+#endif
+
+#endif // PROFILER_H
@@ -0,0 +1,35 @@
+#ifndef PROFILERPANEL_H
+#define PROFILERPANEL_H
+
+#include "Profiler.h"
+#include <cstdint>
+#include <vector>
+
+namespace spark
+{
+    // Frame-time history and flame graph of the Profiler's recorded frames
+    class ProfilerPanel
+    {
+    public:
+        ProfilerPanel() = default;
+        ~ProfilerPanel() = default;
+
+        void Render();
+
+    private:
+        void RefreshHistory();
+        void PinFrame(std::uint64_t frameIndex);
+        void RenderFrameHistory();
+        void RenderFlameGraph(const ProfileFrame &frame);
+        void RenderZoneTable(const ProfileFrame &frame);
+
+    private:
+        // While paused the history and the inspected frame are copies, so the ring can keep overwriting its slots
+        bool m_isPaused{false};
+        ProfileFrame m_pinnedFrame{};
+        std::uint64_t m_historyFirstFrame{0};
+        std::vector<float> m_frameTimes; // ms, oldest first
+    };
+}
+
+#endif // PROFILERPANEL_H
@@ -0,0 +1,56 @@
+#ifndef RENDERSORT_H
+#define RENDERSORT_H
+
+#include "IRenderable.h"
+
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace spark
+{
+    // The Renderer's 64 bit draw command key: layer in the top byte, then the texture rank (12 bits) and blend mode
+    // rank (4 bits), then the depth's bits, ordered like the floats. Ranks past their bits are clamped, pass 0 for
+    // both on layers that aren't batched so their draws only sort by layer and depth.
+    std::uint64_t PackSortKey(const RenderSortKey &key, std::uint64_t textureRank, std::uint64_t blendModeRank);
+
+    // LSD radix sort of anything with a 64 bit key member on 8 bit digits, stable, so equal keys stay in submission
+    // order. Bytes every key shares (unused layers, a single texture, the same depth) are skipped, usually leaving
+    // one or two passes. scratch is only reused storage.
+    template <typename Item>
+    void RadixSort(std::vector<Item> &items, std::vector<Item> &scratch)
+    {
+        if (items.empty())
+        {
+            return;
+        }
+
+        scratch.resize(items.size());
+        for (int shift = 0; shift < 64; shift += 8)
+        {
+            std::array<std::uint32_t, 256> offsets{};
+            for (const Item &item : items)
+            {
+                ++offsets[(item.key >> shift) & 0xFF];
+            }
+            if (offsets[(items.front().key >> shift) & 0xFF] == items.size())
+            {
+                continue;
+            }
+
+            std::uint32_t total = 0;
+            for (std::uint32_t &offset : offsets)
+            {
+                total += std::exchange(offset, total);
+            }
+            for (const Item &item : items)
+            {
+                scratch[offsets[(item.key >> shift) & 0xFF]++] = item;
+            }
+            items.swap(scratch);
+        }
+    }
+} // namespace spark
+
+#endif // RENDERSORT_H
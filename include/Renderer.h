@@ -2,7 +2,11 @@
 #define RENDERER_H
 #include <SDL3/SDL.h>
 #include "Singleton.h"
+#include "IRenderable.h"
+#include <array>
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 namespace spark
 {
@@ -15,6 +19,34 @@ namespace spark
         }
     };
 
+    // Per-frame counters, reset by Present
+    struct RenderStats
+    {
+        int drawCalls{0};           // Calls that reached SDL (batch flushes + unbatched draws)
+        int primitivesSubmitted{0}; // Points, lines, rects and triangles handed to the Renderer
+        int verticesSubmitted{0};
+    };
+
+    // 2D affine transform: x' = xx * x + yx * y + tx, y' = xy * x + yy * y + ty
+    struct ViewTransform
+    {
+        float xx{1.0f};
+        float xy{0.0f};
+        float yx{0.0f};
+        float yy{1.0f};
+        float tx{0.0f};
+        float ty{0.0f};
+    };
+
+    // Primitive draws (points, lines, rects, geometry) are not sent to SDL immediately: they are
+    // accumulated as colored triangles and sent with one SDL_RenderGeometry call per texture/blend state.
+    // Anything that talks to the SDL_Renderer directly (e.g. ImGui) must call Flush() first.
+    //
+    // Queued draws are kept as a command list tagged with the sort key that was set when they were submitted,
+    // and Flush radix-sorts it by (layer, depth) before drawing, submission order breaking ties. Layers marked
+    // batched sort by (layer, texture, blend mode, depth) instead: their draws are grouped into as few
+    // SDL_RenderGeometry calls as possible, which is only right for content that doesn't overlap, or doesn't
+    // care in which order it's blended. Sorting never crosses a Flush.
     class Renderer final : public Singleton<Renderer>
     {
 
@@ -32,8 +64,36 @@ namespace spark
         bool SetDrawColorFloat(float r, float g, float b, float a);
         bool GetDrawColor(Uint8 *r, Uint8 *g, Uint8 *b, Uint8 *a);
         bool GetDrawColorFloat(float *r, float *g, float *b, float *a);
+        bool SetDrawBlendMode(SDL_BlendMode blendMode);
+        SDL_BlendMode GetDrawBlendMode() const;
         bool Clear();
         bool Present();
+        bool Flush();
+
+        // Maps everything batched while it's enabled from world to viewport coordinates, set up by the scene's
+        // camera. Disable it to draw in plain viewport pixels (HUDs) and enable it again afterwards.
+        void SetViewTransform(const ViewTransform &view);
+        const ViewTransform &GetViewTransform() const { return m_view; }
+        void SetViewTransformEnabled(bool enabled);
+        bool IsViewTransformEnabled() const { return m_isViewEnabled; }
+        // Null is the whole render target
+        bool SetViewport(const SDL_Rect *viewport);
+        // Draws submitted until the matching PopRenderTarget go to texture (null is the window), sorted and flushed
+        // on their own, starting with the view transform disabled. What was queued for the previous target stays
+        // queued with its view transform and sort key, so switching targets mid-frame doesn't break its order.
+        // The texture needs SDL_TEXTUREACCESS_TARGET.
+        bool PushRenderTarget(SDL_Texture *texture);
+        // Flushes the draws queued for the pushed target and goes back to the previous one
+        bool PopRenderTarget();
+        SDL_Texture *GetRenderTarget() const;
+
+        // Applies to everything submitted afterwards. The scene sets each renderable's own key before its Render.
+        void SetSortKey(const RenderSortKey &key) { m_sortKey = key; }
+        const RenderSortKey &GetSortKey() const { return m_sortKey; }
+        // Lets a layer's draws be reordered by texture and blend mode, see above. Off for every layer by default.
+        void SetLayerBatched(std::int8_t layer, bool batched);
+        bool IsLayerBatched(std::int8_t layer) const { return m_batchedLayers[LayerIndex(layer)]; }
+
         bool RenderPoint(float x, float y);
         bool RenderPoints(const SDL_FPoint *points, int count);
         bool RenderLine(float x1, float y1, float x2, float y2);
@@ -42,6 +102,17 @@ namespace spark
         bool RenderRects(const SDL_FRect *rects, int count);
         bool RenderFillRect(const SDL_FRect *rect);
         bool RenderFillRects(const SDL_FRect *rects, int count);
+
+        // Bulk submission from flat float arrays (used by the Lua bulk draw bindings).
+        // Lines are x1, y1, x2, y2 per segment, rects x, y, w, h, points x, y.
+        // colors is optional: r, g, b, a floats per primitive, nullptr uses the current draw color.
+        bool RenderLineList(const float *coords, int count, const float *colors = nullptr);
+        bool RenderFillRectList(const float *rects, int count, const float *colors = nullptr);
+        bool RenderPointList(const float *points, int count, const float *colors = nullptr);
+
+        // Reserves quadCount quads (4 vertices each, drawn as triangles 0-1-2 and 0-2-3) in the current batch
+        // and returns their vertices for the caller to fill in place. Valid until the next Renderer call.
+        SDL_Vertex *AllocateQuads(SDL_Texture *texture, int quadCount);
         bool RenderTexture(SDL_Texture *texture, const SDL_FRect *srcrect, const SDL_FRect *dstrect);
         bool RenderTextureRotated(SDL_Texture *texture, const SDL_FRect *srcrect, const SDL_FRect *dstrect, double angle, const SDL_FPoint *center, SDL_FlipMode flip);
         bool RenderTextureAffine(SDL_Texture *texture, const SDL_FRect *srcrect, const SDL_FPoint *origin, const SDL_FPoint *right, const SDL_FPoint *down);
@@ -51,13 +122,83 @@ namespace spark
         bool RenderGeometry(SDL_Texture *texture, const SDL_Vertex *vertices, int num_vertices, const int *indices, int num_indices);
         bool RenderGeometryRaw(SDL_Texture *texture, const float *xy, int xy_stride, const SDL_FColor *color, int color_stride, const float *uv, int uv_stride, int num_vertices, const void *indices, int num_indices, int size_indices);
 
+        // Stats of the last presented frame
+        const RenderStats &GetFrameStats() const { return m_lastFrameStats; }
+
     private:
         friend Singleton<Renderer>;
         Renderer();
 
+        struct DrawCommand
+        {
+            std::uint64_t key;
+            SDL_Texture *texture;
+            SDL_BlendMode blendMode;
+            std::uint32_t firstIndex; // the command's indices run up to the next command's firstIndex
+        };
+
+        // A target's queue while a PushRenderTarget draws somewhere else
+        struct QueuedTarget
+        {
+            SDL_Texture *target;
+            std::vector<SDL_Vertex> vertices;
+            std::vector<int> indices;
+            std::vector<DrawCommand> commands;
+            std::vector<SDL_Texture *> textureRanks;
+            std::vector<SDL_BlendMode> blendModeRanks;
+            RenderSortKey sortKey;
+            ViewTransform view;
+            bool isViewEnabled;
+        };
+
+        struct SortItem
+        {
+            std::uint64_t key;
+            std::uint32_t command;
+        };
+
+        static std::size_t LayerIndex(std::int8_t layer) { return static_cast<std::size_t>(layer + 128); }
+        // m_sortKey packed with the texture and blend mode ranks on batched layers, see PackSortKey
+        std::uint64_t MakeSortKey(SDL_Texture *texture);
+        // Starts a new command unless the draw continues the last one
+        void PrepareBatch(SDL_Texture *texture, int vertexCount);
+        bool DrawBatch(SDL_Texture *texture, SDL_BlendMode blendMode, const int *indices, int indexCount, SDL_BlendMode &appliedBlendMode);
+        void PushQuad(float x0, float y0, float x1, float y1, float x2, float y2, float x3, float y3, const SDL_FColor &color);
+        void PushRect(float x, float y, float w, float h, const SDL_FColor &color);
+        void PushLine(float x1, float y1, float x2, float y2, const SDL_FColor &color);
+        // Null srcrect is the whole texture, null dstrect the whole render target. False if there's nothing to draw.
+        bool ResolveTextureRects(SDL_Texture *texture, const SDL_FRect *srcrect, const SDL_FRect *dstrect, SDL_FRect &source, SDL_FRect &destination);
+        // Corners clockwise from the top left, source in texture pixels
+        void PushTexturedQuad(SDL_Texture *texture, const SDL_FPoint (&corners)[4], const SDL_FRect &source, SDL_FlipMode flip);
+        void PushTiled(SDL_Texture *texture, const SDL_FRect &source, float tileWidth, float tileHeight, const SDL_FRect &destination);
+
     private:
         std::unique_ptr<SDL_Renderer, SDLRendererDeleter> m_SDLRenderer;
-        };
+
+        // Larger batches are split into several SDL_RenderGeometry calls after the sort, a multiple of 3 so no
+        // triangle straddles two calls. The queue itself grows until Flush so the sort always sees the whole frame.
+        static constexpr int MaxDrawIndices = 3 << 16;
+
+        std::vector<SDL_Vertex> m_batchVertices;
+        std::vector<int> m_batchIndices;
+        std::vector<DrawCommand> m_commands;
+        std::vector<SortItem> m_sortItems;
+        std::vector<SortItem> m_sortScratch;
+        std::vector<int> m_sortedIndices;
+        // Textures and blend modes in the order they were first seen since the last Flush, the rank is the index
+        std::vector<SDL_Texture *> m_textureRanks;
+        std::vector<SDL_BlendMode> m_blendModeRanks;
+        std::vector<QueuedTarget> m_queuedTargets;
+        RenderSortKey m_sortKey{};
+        std::array<bool, 256> m_batchedLayers{};
+        SDL_BlendMode m_blendMode{SDL_BLENDMODE_NONE};
+        SDL_FColor m_drawColor{0.0f, 0.0f, 0.0f, 1.0f};
+        ViewTransform m_view{};
+        bool m_isViewEnabled{false};
+
+        RenderStats m_frameStats{};
+        RenderStats m_lastFrameStats{};
+    };
 
 } // namespace spark
 
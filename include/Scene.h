@@ -2,9 +2,19 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <cstdint>
+#include <array>
+#include <unordered_map>
 #include "GameObject.h"
+#include "CommandBuffer.h"
+#include "GameObjectHandle.h"
+#include "TagRegistry.h"
+#include "CullingGrid.h"
 namespace spark
 {
+    class TransformComponent;
+    class CameraComponent;
+    struct IBoundedRenderable;
     class Scene final
     {
     public:
@@ -16,25 +26,210 @@ namespace spark
         Scene &operator=(const Scene &other) = delete;
         Scene &operator=(Scene &&other) = delete;
 
+        // While the scene is iterating, new objects wait in a pending list and join at the next ApplyDeferredChanges
         void AddGameObject(std::unique_ptr<GameObject> gameObject);
         GameObject *EmplaceGameObject();
         GameObject *EmplaceGameObject(const std::string &name);
         void RemoveGameObject(GameObject *gameObject);
         GameObject *PopGameObject(GameObject *gameObject);
-        std::vector<GameObject *> GetAllGameObjects() const;
+        // Every object in the scene at any depth, including ones still pending, in no particular order
+        const std::vector<GameObject *> &GetAllGameObjects() const noexcept { return m_allGameObjects; }
+        const std::vector<std::unique_ptr<GameObject>> &GetRootGameObjects() const noexcept { return m_gameObjects; }
+
+        // Null once the object has been destroyed, or if the handle came from another scene
+        GameObject *Resolve(GameObjectHandle handle) const noexcept;
+
+        // Queries read indices that are kept up to date as objects join or leave the scene and as they're renamed,
+        // tagged or gain and lose components, so none of them walk the hierarchy. The returned lists are owned by
+        // the scene and stay valid for its lifetime, but change as objects do.
+        GameObject *FindGameObject(const std::string &name) const;
+        const std::vector<GameObject *> &FindGameObjects(const std::string &name) const;
+        const std::vector<GameObject *> &GetGameObjectsWithTag(const std::string &tag) const;
+        const std::vector<GameObject *> &GetGameObjectsWithComponent(std::size_t componentTypeId) const;
+        // The shortest index list that holds every object matching both masks, matches still need checking
+        const std::vector<GameObject *> &GetQueryCandidates(ComponentMask components, TagMask tags) const;
+
+        // Calls fn(GameObject *) for every object that has all the components and all the tags. Objects that
+        // lose a tag inside fn can make the iteration skip another object, objects that gain one may be visited.
+        template <typename Fn>
+        void ForEachMatching(ComponentMask components, TagMask tags, Fn &&fn) const
+        {
+            const std::vector<GameObject *> &candidates = GetQueryCandidates(components, tags);
+            for (std::size_t i = 0; i < candidates.size(); ++i)
+            {
+                GameObject *gameObject = candidates[i];
+                if (gameObject->HasComponentMask(components) && gameObject->HasTags(tags))
+                {
+                    fn(gameObject);
+                }
+            }
+        }
+
+        template <typename... Ts, typename Fn>
+        void ForEachWith(Fn &&fn) const
+        {
+            ForEachMatching(GetComponentMask<Ts...>(), TagMask{0}, std::forward<Fn>(fn));
+        }
 
         void SetName(const std::string &name);
         const std::string &GetName() const;
+        // Unique for the lifetime of the program, stamped into the handles this scene issues
+        std::uint32_t GetId() const noexcept { return m_id; }
 
         void Init();
         void Update(float dt);
+        void FixedUpdate(float fixedDt);
         void Render();
         void RenderImGui();
 
+        // Opt-in, off by default. When on, roots whose whole subtree is IParallelUpdateable are updated on worker
+        // threads first, then every other root on the main thread in creation order. That changes the update order
+        // relative to the serial path: a parallel-safe root now updates before serial roots created earlier than it,
+        // so scripts never see it half way through a frame. Roots without anything to update stay serial.
+        void SetParallelUpdateEnabled(bool enabled) noexcept { m_isParallelUpdateEnabled = enabled; }
+        bool IsParallelUpdateEnabled() const noexcept { return m_isParallelUpdateEnabled; }
+
+        // Applies everything queued while the scene was iterating: pending objects, recorded commands, deletions.
+        // Runs at the end of Init, Update, FixedUpdate and Render.
+        void ApplyDeferredChanges();
+
+        // Call whenever objects are added, removed or reparented so the transform order gets rebuilt
+        void MarkHierarchyDirty() noexcept { m_isHierarchyDirty = true; }
+
+        // The camera Render views the scene through. Without one set the CameraComponent with the lowest
+        // handle index is used, without any camera the scene draws in window pixels and nothing is culled.
+        void SetCamera(CameraComponent *camera);
+        CameraComponent *GetCamera() const;
+        // Bounded renderables drawn and skipped by the last culled Render. Renderables below a bitmap-cached object
+        // are in neither, the cached subtrees drawn are counted on their own.
+        std::size_t GetLastDrawnCount() const noexcept { return m_lastDrawnCount; }
+        std::size_t GetLastCulledCount() const noexcept { return m_lastCulledCount; }
+        std::size_t GetLastCachedCount() const noexcept { return m_lastCachedCount; }
+
+        // Frees the textures of every bitmap cache, they're redrawn when next rendered
+        void ReleaseBitmapCaches();
+
     private:
+        friend class GameObject;
+
+        bool IsRoot(const GameObject *gameObject) const noexcept;
+        void InsertRoot(std::unique_ptr<GameObject> gameObject);
+        std::unique_ptr<GameObject> DetachRoot(GameObject *gameObject);
+        // Gives the object and its children handles, done once when they first join the scene
+        void RegisterGameObject(GameObject *gameObject);
+        // Drops the object from the query indices and invalidates its handle, called as it's destroyed
+        void UnregisterGameObject(GameObject *gameObject) noexcept;
+
+        void OnGameObjectRenamed(GameObject *gameObject, const std::string &oldName);
+        void OnComponentAdded(GameObject *gameObject, std::size_t typeId);
+        void OnComponentRemoved(GameObject *gameObject, std::size_t typeId);
+        void OnTagAdded(GameObject *gameObject, std::size_t tagId);
+        void OnTagRemoved(GameObject *gameObject, std::size_t tagId);
+        void OnRenderableAdded(GameObject *gameObject, IRenderable *renderable);
+        void OnRenderableRemoved(GameObject *gameObject, IRenderable *renderable);
+
         void DeleteGameObjects();
+        void UpdateParallelRoots(float dt);
+        void RebuildTransformOrder();
+        void PropagateTransforms();
+        void PropagateTransformRange(std::size_t begin, std::size_t end);
+
+        void AddCullEntry(GameObject *gameObject, IBoundedRenderable *renderable);
+        void RemoveCullEntry(IBoundedRenderable *renderable);
+        // Re-measures the bounds whose renderable or transform changed since the last frame. Returns how many
+        // entries are in the render order, the rest are drawn by a bitmap cache or outside the hierarchy.
+        std::size_t RefreshCullEntries();
+        // Everything the view can see, in the same order the hierarchy walk would draw it
+        void RenderVisible(const SDL_FRect &view);
+
+        // Flattened hierarchy in parent-before-child order, parent is an index into the same array (-1 for none)
+        struct TransformNode
+        {
+            TransformComponent *transform;
+            std::int32_t parent;
+        };
+
+        struct HandleSlot
+        {
+            GameObject *gameObject; // null while the slot is free
+            std::uint32_t generation;
+        };
+
+        // Where an object sits in each query index it's part of, so leaving one is swap-and-pop.
+        // Indexed by handle slot like m_handleSlots.
+        struct IndexPositions
+        {
+            std::uint32_t all;
+            std::uint32_t name;
+            std::array<std::uint32_t, MaxComponentTypes> components;
+            std::array<std::uint32_t, MaxTags> tags;
+            std::uint32_t unboundedRenderer;
+            // Pre-order position in the hierarchy, NotIndexed while the object isn't under a root or is drawn by a
+            // bitmap cache
+            std::uint32_t renderOrder;
+        };
+
+        // A bounded renderable as the culling grid knows it, the id into m_cullEntries is its grid id
+        struct CullEntry
+        {
+            IBoundedRenderable *renderable; // null while the entry is free
+            GameObject *gameObject;
+            SDL_FRect bounds;
+            std::uint32_t transformVersion;
+            std::uint32_t boundsVersion;
+            bool hasBounds;
+            bool isMeasured;
+        };
+
+        struct DrawItem
+        {
+            // Render order in the high half, position in the object's renderables in the low half
+            std::uint64_t key;
+            IRenderable *renderable;
+            // Set instead of the renderable for an object that caches its subtree as a bitmap
+            GameObject *gameObject;
+        };
 
         std::string m_name{"Scene"};
+        std::uint32_t m_id;
+        // Declared before the objects, which unregister themselves while they're destroyed
+        std::vector<HandleSlot> m_handleSlots;
+        std::vector<std::uint32_t> m_freeHandleSlots;
+        std::vector<IndexPositions> m_indexPositions;
+        std::vector<GameObject *> m_allGameObjects;
+        // Emptied buckets are kept, so a list handed out by FindGameObjects never dangles
+        std::unordered_map<std::string, std::vector<GameObject *>> m_nameIndex;
+        std::array<std::vector<GameObject *>, MaxComponentTypes> m_componentIndex;
+        std::array<std::vector<GameObject *>, MaxTags> m_tagIndex;
+        // Also before the objects, which drop their renderables from these as they're destroyed
+        GameObjectHandle m_cameraObject{};
+        std::vector<CullEntry> m_cullEntries;
+        std::vector<std::uint32_t> m_freeCullEntries;
+        std::unordered_map<IBoundedRenderable *, std::uint32_t> m_cullEntryIds;
+        CullingGrid m_cullingGrid;
+        // Objects with renderables the grid can't hold, drawn whatever the camera looks at
+        std::vector<GameObject *> m_unboundedRenderers;
+        std::vector<DrawItem> m_drawList;
+        // Objects drawing their subtree from a bitmap, rebuilt with the transform order. Nothing below them is
+        // in the render order, the culled Render draws each one as a single item.
+        std::vector<DrawItem> m_bitmapCacheRoots;
+        std::size_t m_lastDrawnCount{0};
+        std::size_t m_lastCulledCount{0};
+        std::size_t m_lastCachedCount{0};
+
+        // Roots in creation order, which is update and draw order. Each knows its index, removal keeps the order.
         std::vector<std::unique_ptr<GameObject>> m_gameObjects;
+        std::vector<TransformNode> m_transformOrder;
+        // Where each top-level subtree starts in m_transformOrder, subtrees are independent and propagate in parallel
+        std::vector<std::size_t> m_subtreeStarts;
+        bool m_isHierarchyDirty{true};
+
+        bool m_isParallelUpdateEnabled{false};
+        std::vector<GameObject *> m_parallelRoots;
+        std::vector<GameObject *> m_serialRoots;
+        std::vector<CommandBuffer> m_commandBuffers; // one per JobSystem thread
+
+        CommandBuffer m_deferredChanges;
+        std::vector<std::unique_ptr<GameObject>> m_pendingGameObjects;
     };
 }
\ No newline at end of file
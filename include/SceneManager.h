@@ -28,8 +28,11 @@ namespace spark
 
         void Init();
         void Update(float dt);
+        void FixedUpdate(float fixedDt);
         void Render();
         void ImGuiRender();
+        // Frees the bitmap cache textures of every scene, needed before the renderer is destroyed
+        void ReleaseBitmapCaches();
 
     private:
         friend Singleton<SceneManager>;
@@ -0,0 +1,91 @@
+#ifndef SPATIALGRID_H
+#define SPATIALGRID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace spark
+{
+    // Uniform grid broadphase over a set of 2D points, rebuilt from scratch each frame with a counting sort
+    // (O(n), no per-cell allocations). Points are addressed by their 0-based index in the source array,
+    // so it works directly on a FloatBuffer of positions or any other strided float array.
+    class SpatialGrid final
+    {
+    public:
+        static constexpr std::uint32_t NoIndex = std::numeric_limits<std::uint32_t>::max();
+
+        explicit SpatialGrid(float cellSize = 64.0f);
+
+        // Cell size should be about the most common query radius
+        void SetCellSize(float cellSize);
+        float GetCellSize() const noexcept { return m_cellSize; }
+
+        // Indexes count points read from points[i * stride], points[i * stride + 1]
+        void Build(const float *points, std::size_t count, std::size_t stride = 2);
+        void Clear() noexcept;
+        std::size_t GetPointCount() const noexcept { return m_sortedIndices.size(); }
+
+        // Calls fn(index, distanceSquared) for every point within radius of (x, y)
+        template <typename Fn>
+        void ForEachInRadius(float x, float y, float radius, Fn &&fn) const;
+
+        // Replaces out with the indices within radius of (x, y), skipping exclude. Order is unspecified.
+        std::size_t QueryRadius(float x, float y, float radius, std::vector<std::uint32_t> &out, std::uint32_t exclude = NoIndex) const;
+        // Replaces out with up to k nearest indices to (x, y) within maxRadius, skipping exclude, nearest first
+        std::size_t QueryNearest(float x, float y, std::size_t k, std::vector<std::uint32_t> &out,
+                                 std::uint32_t exclude = NoIndex, float maxRadius = std::numeric_limits<float>::max()) const;
+
+    private:
+        int CellX(float x) const noexcept;
+        int CellY(float y) const noexcept;
+        std::size_t CellIndex(int cx, int cy) const noexcept { return static_cast<std::size_t>(cy) * m_columns + cx; }
+
+    private:
+        float m_cellSize{64.0f};
+        float m_invCellSize{1.0f / 64.0f}; // of the cell size actually in use, which grows for sparse point sets
+        float m_originX{0.0f};
+        float m_originY{0.0f};
+        int m_columns{0};
+        int m_rows{0};
+
+        std::vector<std::uint32_t> m_cellStart;     // m_columns * m_rows + 1 offsets into the sorted arrays
+        std::vector<std::uint32_t> m_sortedIndices; // source indices grouped by cell
+        std::vector<float> m_sortedPoints;          // x, y pairs in the same order, so queries stay in cache
+    };
+
+    template <typename Fn>
+    void SpatialGrid::ForEachInRadius(float x, float y, float radius, Fn &&fn) const
+    {
+        if (m_sortedIndices.empty() || radius < 0.0f)
+        {
+            return;
+        }
+
+        const int minX = CellX(x - radius);
+        const int maxX = CellX(x + radius);
+        const int minY = CellY(y - radius);
+        const int maxY = CellY(y + radius);
+        const float radiusSq = radius * radius;
+
+        for (int cy = minY; cy <= maxY; ++cy)
+        {
+            // Cells of a row are adjacent in the sorted arrays, so each row is one contiguous range
+            const std::uint32_t begin = m_cellStart[CellIndex(minX, cy)];
+            const std::uint32_t end = m_cellStart[CellIndex(maxX, cy) + 1];
+            for (std::uint32_t i = begin; i < end; ++i)
+            {
+                const float dx = m_sortedPoints[i * 2] - x;
+                const float dy = m_sortedPoints[i * 2 + 1] - y;
+                const float distanceSq = dx * dx + dy * dy;
+                if (distanceSq <= radiusSq)
+                {
+                    fn(m_sortedIndices[i], distanceSq);
+                }
+            }
+        }
+    }
+} // namespace spark
+
+#endif // SPATIALGRID_H
@@ -0,0 +1,41 @@
+#ifndef TAGREGISTRY_H
+#define TAGREGISTRY_H
+
+#include "Singleton.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace spark
+{
+    // Tags are strings in the API but bits on the GameObject. Each distinct tag gets the next free bit the first
+    // time it's used, shared by every scene, so membership tests and multi-tag queries are single mask checks.
+    inline constexpr std::size_t MaxTags = 32;
+    using TagMask = std::uint32_t;
+
+    class TagRegistry final : public Singleton<TagRegistry>
+    {
+        friend class Singleton<TagRegistry>;
+
+    public:
+        static constexpr std::size_t InvalidTagId = ~std::size_t{0};
+
+        // Assigns a bit to unknown tags, InvalidTagId once all MaxTags bits are taken
+        std::size_t GetTagId(const std::string &tag);
+        // Doesn't register, InvalidTagId for tags nothing has used yet
+        std::size_t FindTagId(const std::string &tag) const;
+        const std::string &GetTagName(std::size_t tagId) const;
+        std::size_t GetTagCount() const { return m_tagNames.size(); }
+
+    private:
+        TagRegistry() = default;
+
+    private:
+        std::unordered_map<std::string, std::size_t> m_tagIds;
+        std::vector<std::string> m_tagNames;
+    };
+} // namespace spark
+
+#endif // TAGREGISTRY_H
@@ -0,0 +1,86 @@
+#ifndef TEXTRENDERER_H
+#define TEXTRENDERER_H
+
+#include <SDL3/SDL.h>
+#include "Singleton.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace spark
+{
+    // In-game text from TTF fonts, drawn through the Renderer's batch. Glyphs are rasterized with stb_truetype the
+    // first time they're needed and packed into shared glyph pages. Laid out strings are cached per font, so drawing
+    // a label that didn't change since last frame is one lookup and a copy of its quads into the batch.
+    // Runs that haven't been drawn for a while are dropped by Update.
+    class TextRenderer final : public Singleton<TextRenderer>
+    {
+        friend class Singleton<TextRenderer>;
+
+    public:
+        using FontId = std::uint32_t;
+        static constexpr FontId InvalidFontId = ~FontId{0};
+        static constexpr const char *DefaultFontPath = "res/fonts/RedHatMono-Regular.ttf";
+        static constexpr float DefaultFontSize = 18.0f;
+
+        ~TextRenderer();
+
+        // Same path and size give the same font. InvalidFontId if the file can't be read or isn't a font.
+        FontId LoadFont(const std::string &path, float pixelHeight);
+        // DefaultFontPath at DefaultFontSize, loaded on first use
+        FontId GetDefaultFont();
+
+        // (x, y) is the top left of the first line, '\n' starts a new one. Uses the renderer's draw color.
+        bool DrawText(FontId font, std::string_view text, float x, float y);
+        bool DrawText(FontId font, std::string_view text, float x, float y, const SDL_FColor &color);
+        // Width of the longest line and height of all lines
+        SDL_FPoint MeasureText(FontId font, std::string_view text);
+        float GetLineHeight(FontId font) const;
+
+        // Drops runs not drawn for a while. Once per frame.
+        void Update();
+        // Destroys the glyph pages, call before the renderer goes away. Fonts stay loaded.
+        void Clear();
+
+        std::size_t GetCachedRunCount() const;
+        std::size_t GetGlyphPageCount() const { return m_pages.size(); }
+
+    private:
+        // Out of line with the destructor, FontData is only complete in the .cpp
+        TextRenderer();
+
+        struct Glyph;
+        struct FontData;
+        struct TextRun;
+
+        struct GlyphPage
+        {
+            SDL_Texture *texture{nullptr};
+            int shelfX{0};
+            int shelfY{0};
+            int shelfHeight{0};
+        };
+
+        FontData *Find(FontId font) const;
+        // Lays out and caches text on the first call
+        TextRun *GetRun(FontData &font, std::string_view text);
+        // Rasterizes into a glyph page on the first call for a codepoint
+        const Glyph &GetGlyph(FontData &font, char32_t codepoint);
+        bool AllocateInPage(int width, int height, int &page, SDL_Rect &rect);
+
+    private:
+        static constexpr int PageSize = 1024;
+        // Frames a run survives without being drawn
+        static constexpr std::uint64_t RunLifetime = 300;
+
+        std::vector<std::unique_ptr<FontData>> m_fonts;
+        std::vector<GlyphPage> m_pages;
+        FontId m_defaultFont{InvalidFontId};
+        bool m_defaultFontFailed{false};
+        std::uint64_t m_frame{0};
+    };
+} // namespace spark
+
+#endif // TEXTRENDERER_H
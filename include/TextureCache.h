@@ -0,0 +1,160 @@
+#ifndef TEXTURECACHE_H
+#define TEXTURECACHE_H
+
+#include <SDL3/SDL.h>
+#include "Singleton.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace spark
+{
+    struct JobCounter;
+
+    // Where an image ended up: its own texture, or a rectangle inside a shared atlas page
+    struct TextureRegion
+    {
+        SDL_Texture *texture{nullptr};
+        SDL_FRect rect{};
+    };
+
+    // Images keyed by path, loaded once and shared by everyone holding a Texture for that path. Decoding happens
+    // in a job off the main thread, Update uploads whatever finished. Images up to GetMaxAtlasedSize() on both
+    // sides are packed into shared atlas pages, so sprites drawn together mostly share one texture and batch into
+    // a single draw. Larger images get a texture of their own.
+    class TextureCache final : public Singleton<TextureCache>
+    {
+        friend class Singleton<TextureCache>;
+
+    public:
+        using TextureId = std::uint32_t;
+        static constexpr TextureId InvalidTextureId = ~TextureId{0};
+
+        ~TextureCache();
+
+        // Takes a reference, starting the load on the first one. Prefer the Texture wrapper.
+        TextureId Acquire(const std::string &path);
+        void AddReference(TextureId id);
+        // The image is dropped with the last reference. Atlas space is reclaimed once a page has no images left.
+        void Release(TextureId id);
+
+        bool IsReady(TextureId id) const;
+        // True if the file couldn't be read or decoded
+        bool HasFailed(TextureId id) const;
+        // Null until the image has been uploaded
+        const TextureRegion *GetRegion(TextureId id) const;
+
+        // Uploads finished decodes. Main thread, once per frame.
+        void Update();
+        // Blocks until the image is decoded and uploaded
+        void Wait(TextureId id);
+        // Waits for pending loads and destroys every SDL texture, call before the renderer goes away
+        void Clear();
+
+        // Only affect pages created afterwards
+        void SetAtlasPageSize(int size) { m_atlasPageSize = size < 256 ? 256 : size; }
+        int GetAtlasPageSize() const { return m_atlasPageSize; }
+        void SetMaxAtlasedSize(int size) { m_maxAtlasedSize = size; }
+        int GetMaxAtlasedSize() const { return m_maxAtlasedSize; }
+
+        std::size_t GetAtlasPageCount() const { return m_pages.size(); }
+        std::size_t GetLoadedCount() const { return m_idsByPath.size(); }
+
+    private:
+        // Out of line with the destructor, JobCounter is only complete in the .cpp
+        TextureCache();
+
+        // Written by the decode job, read by Update once counter is done
+        struct DecodeTask
+        {
+            std::string path;
+            int width{};
+            int height{};
+            // RGBA, with a one pixel border copied from the edges when the image is going into an atlas
+            std::vector<std::uint8_t> pixels;
+            bool isPadded{false};
+            bool isDecoded{false};
+            std::string error;
+            std::unique_ptr<JobCounter> counter;
+        };
+
+        enum class State
+        {
+            Loading,
+            Ready,
+            Failed
+        };
+
+        struct Entry
+        {
+            std::string path;
+            int references{0};
+            State state{State::Loading};
+            TextureRegion region;
+            int page{-1}; // atlas page, -1 for a texture of its own
+            std::unique_ptr<DecodeTask> task;
+        };
+
+        // Rows of images filled left to right, a new row starts on top of the tallest image of the last one
+        struct AtlasPage
+        {
+            SDL_Texture *texture{nullptr};
+            int size{0};
+            int shelfX{0};
+            int shelfY{0};
+            int shelfHeight{0};
+            int images{0};
+        };
+
+        Entry *Find(TextureId id);
+        const Entry *Find(TextureId id) const;
+        void StartDecode(Entry &entry);
+        // Runs as a job. Images small enough for the atlas get a border of repeated edge pixels, so linear
+        // filtering at their edges never picks up a neighbour on the page.
+        static void Decode(DecodeTask &task, int maxAtlasedSize);
+        void Upload(Entry &entry);
+        bool AllocateInAtlas(int width, int height, int &page, SDL_Rect &rect);
+        void FreeEntry(TextureId id);
+
+    private:
+        int m_atlasPageSize{2048};
+        int m_maxAtlasedSize{256};
+
+        std::vector<Entry> m_entries;
+        std::vector<TextureId> m_freeEntries;
+        std::unordered_map<std::string, TextureId> m_idsByPath;
+        std::vector<TextureId> m_loading;
+        std::vector<AtlasPage> m_pages;
+    };
+
+    // Counted reference to a cached image, loading starts when the first one for a path is created
+    class Texture final
+    {
+    public:
+        Texture() = default;
+        explicit Texture(const std::string &path);
+        ~Texture();
+
+        Texture(const Texture &other);
+        Texture(Texture &&other) noexcept;
+        Texture &operator=(const Texture &other);
+        Texture &operator=(Texture &&other) noexcept;
+
+        bool IsValid() const noexcept { return m_id != TextureCache::InvalidTextureId; }
+        bool IsReady() const;
+        bool HasFailed() const;
+        // Null until ready
+        const TextureRegion *GetRegion() const;
+        // 0 until ready
+        float GetWidth() const;
+        float GetHeight() const;
+        void Wait() const;
+
+    private:
+        TextureCache::TextureId m_id{TextureCache::InvalidTextureId};
+    };
+} // namespace spark
+
+#endif // TEXTURECACHE_H
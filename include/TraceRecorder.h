@@ -0,0 +1,62 @@
+#ifndef TRACERECORDER_H
+#define TRACERECORDER_H
+
+#include "Singleton.h"
+#include "Profiler.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace spark
+{
+    // Captures a run of profiler frames and writes them as Chrome Trace Event JSON, which chrome://tracing,
+    // Perfetto and speedscope open directly. Zones keep their profiler thread index as tid.
+    // Native builds write a file, the Emscripten build hands the browser a download instead.
+    class TraceRecorder final : public Singleton<TraceRecorder>
+    {
+        friend class Singleton<TraceRecorder>;
+
+    public:
+        static constexpr std::size_t DefaultFrameCount = 300;
+        static constexpr const char *DefaultFileName = "spark_trace.json";
+
+        // Starts with the next frame, ignored while a capture is already running
+        void StartCapture(std::size_t frameCount = DefaultFrameCount, const std::string &fileName = DefaultFileName);
+        bool IsCapturing() const { return m_framesRemaining > 0; }
+        std::size_t GetCapturedFrameCount() const { return m_frames.size(); }
+        std::size_t GetRequestedFrameCount() const { return m_frames.size() + m_framesRemaining; }
+
+        // Call once per frame after Profiler::EndFrame, saves the trace when the last requested frame arrives
+        void CollectFrame();
+
+        void WriteChromeTrace(std::ostream &out) const;
+
+    private:
+        TraceRecorder() = default;
+
+        struct CapturedFrame
+        {
+            std::uint64_t frameIndex;
+            std::uint64_t startNs;
+            std::uint64_t endNs;
+            std::size_t firstZone; // range in m_zones
+            std::size_t zoneCount;
+        };
+
+        bool Save() const;
+
+    private:
+        std::size_t m_framesRemaining{0};
+        std::uint64_t m_nextFrameIndex{0};
+        bool m_wasProfilerEnabled{true};
+        std::string m_fileName;
+
+        std::vector<CapturedFrame> m_frames;
+        std::vector<ProfileZone> m_zones;
+    };
+} // namespace spark
+
+#endif // TRACERECORDER_H
@@ -0,0 +1,15 @@
+#ifndef TRIANGULATION_H
+#define TRIANGULATION_H
+
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace spark
+{
+    // Triangulates the closed outline points, in either winding, and appends the triangles to indices as triples of
+    // base + point index. Convex outlines become a fan, concave ones are ear clipped. A simple polygon of n points
+    // always gives n - 2 triangles; a self-intersecting one gives as many, filled as well as a fan can.
+    void TriangulatePolygon(const std::vector<glm::vec2> &points, int base, std::vector<int> &indices);
+} // namespace spark
+
+#endif // TRIANGULATION_H
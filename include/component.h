@@ -1,7 +1,7 @@
 #ifndef COMPONENT_H
 #define COMPONENT_H
 
-#include "GameObject.h"
+#include <memory>
 namespace spark
 {
     class GameObject;
@@ -15,6 +15,21 @@ namespace spark
     private:
         GameObject *m_parent{};
     };
+
+    // Components are allocated from per-type ObjectPools, so ownership has to hand them back to the right pool
+    struct ComponentDeleter
+    {
+        void (*destroy)(Component *){nullptr};
+        void operator()(Component *component) const
+        {
+            if (component && destroy)
+                destroy(component);
+        }
+    };
+    using ComponentPtr = std::unique_ptr<Component, ComponentDeleter>;
 }
 
+// Last, so GameObject.h sees ComponentPtr when this header is the one included first
+#include "GameObject.h"
+
 #endif // COMPONENT_H
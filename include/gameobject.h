@@ -5,13 +5,23 @@
 #include <cstdint>
 #include <vector>
 #include <memory>
-#include <unordered_map>
-#include <typeindex>
+#include <array>
+#include <algorithm>
 #include <type_traits>
+#include <cassert>
+#include <functional>
+
+#include <SDL3/SDL.h>
 
 #include "Component.h"
+#include "ObjectPool.h"
+#include "ComponentTypeId.h"
+#include "GameObjectHandle.h"
+#include "TagRegistry.h"
+#include "Profiler.h"
 #include "IInitializable.h"
 #include "IUpdateable.h"
+#include "IFixedUpdateable.h"
 #include "IRenderable.h"
 #include "IImGuiRenderable.h"
 #include "IInspectorRenderable.h"
@@ -20,6 +30,7 @@ namespace spark
 {
     class Component;
     class TransformComponent;
+    class Scene;
 
     class GameObject final
     {
@@ -28,50 +39,111 @@ namespace spark
         explicit GameObject(const std::string &name);
         explicit GameObject(std::string &&name);
 
-        ~GameObject() = default;
+        ~GameObject();
 
         GameObject(const GameObject &other) = delete;
         GameObject(GameObject &&other) = delete;
         GameObject &operator=(const GameObject &other) = delete;
         GameObject &operator=(GameObject &&other) = delete;
 
+        // GameObjects live in a shared ObjectPool so the scene's objects are packed together in memory
+        static void *operator new(std::size_t size);
+        static void operator delete(void *ptr) noexcept;
+
+        // Initializes this object's components only, Scene::Init visits the children itself
         void Init();
         void Update(float dt);
+        void FixedUpdate(float fixedDt);
         void Render();
         void RenderImGui();
         void RenderInspector();
 
+        // Deferred until the scene finishes iterating when called from Update, FixedUpdate or Render, see CommandBuffer
         void SetParent(GameObject *newParent, bool keepWorldPos = true);
         GameObject *GetParent() const noexcept { return m_parent; }
         const std::vector<GameObject *> &GetChildren() const noexcept { return m_childrenRawPtrs; }
-        bool IsChild(GameObject *gameObject) const noexcept;
+        bool IsChild(const GameObject *gameObject) const noexcept { return gameObject && gameObject->m_parent == this; }
+
+        // Null until the object is added to a scene, stays the same for the object's lifetime after that
+        GameObjectHandle GetHandle() const noexcept { return m_handle; }
+        Scene *GetScene() const noexcept { return m_scene; }
 
-        void Delete() noexcept { m_isToBeDeleted = true; }
+        void Delete();
         bool GetIsToBeDeleted() const noexcept { return m_isToBeDeleted; }
 
         const std::string &GetName() const noexcept { return m_name; }
-        void SetName(const std::string &name) { m_name = name; }
-        void SetName(std::string &&name) { m_name = std::move(name); }
+        // Renames and tag changes made on a worker during the parallel update are recorded and applied after it
+        void SetName(const std::string &name);
+        void SetName(std::string &&name);
+
+        // False if the tag couldn't get a bit, see TagRegistry. Always true on a worker, where it's only recorded.
+        bool AddTag(const std::string &tag);
+        void RemoveTag(const std::string &tag);
+        bool HasTag(const std::string &tag) const;
+        // True if every tag in the mask is set
+        bool HasTags(TagMask mask) const noexcept { return (m_tagMask & mask) == mask; }
+        TagMask GetTagMask() const noexcept { return m_tagMask; }
+
+        // True when this object and its children have something to update and every updateable among them is an
+        // IParallelUpdateable. A subtree with nothing to update isn't worth sending to a worker.
+        bool IsParallelUpdateSafe() const noexcept;
+        // True on a thread running the parallel update, structural changes have to be deferred there
+        static bool IsInParallelUpdate() noexcept;
+        // True while structural changes on this thread are queued instead of applied
+        static bool IsDeferringChanges() noexcept;
+        static void DeferChange(std::function<void()> change);
+        // Aborts, in every build type, when called during the parallel update. For calls that can't be recorded
+        // for later because the caller needs their result right away.
+        static void RequireMainThreadUpdate(const char *operation);
+
+        // Removes children flagged by Delete, at any depth. Returns true if anything was removed.
+        bool RemoveDeletedChildren();
+
+        // Like Flash's cacheAsBitmap: the object and its children are drawn into a texture once and that texture
+        // is drawn in their place until something in the subtree changes. Moving, adding or removing objects and
+        // components, and editing shapes invalidate it by themselves. Call InvalidateBitmapCache for changes the
+        // engine can't see, like a script drawing something different. The texture covers the bounds of the
+        // subtree's IBoundedRenderables, plus the area on screen if it has renderables without bounds.
+        void SetCacheAsBitmap(bool enabled);
+        bool IsCacheAsBitmap() const noexcept { return m_bitmapCache != nullptr; }
+        // Redraws the bitmap of this object and of every caching ancestor on their next Render
+        void InvalidateBitmapCache() noexcept;
+        // Frees the texture, it's redrawn on the next Render. Call before the renderer goes away.
+        void ReleaseBitmapCache();
+        // World space rect the cached bitmap is drawn to, false while there's no up to date bitmap
+        bool GetBitmapCacheBounds(SDL_FRect &bounds) const noexcept;
 
         template <typename T, typename... Args>
         T *AddComponent(Args &&...args)
         {
             static_assert(std::is_base_of_v<Component, T>, "T must be a Component");
+            // Workers can't get the component back from a recorded command, they use CommandBuffer::AddComponent
+            RequireMainThreadUpdate("GameObject::AddComponent");
 
             // Check for duplicate components
-            std::type_index typeIdx = std::type_index(typeid(T));
-            if (m_componentMap.find(typeIdx) != m_componentMap.end())
+            const std::size_t typeId = GetComponentTypeId<T>();
+            if (m_componentSlots[typeId])
             {
-                return static_cast<T *>(m_componentMap[typeIdx]);
+                return static_cast<T *>(m_componentSlots[typeId]);
             }
 
-            auto component = std::make_unique<T>(this, std::forward<Args>(args)...);
-            T *rawPtr = component.get();
+            T *rawPtr = ObjectPool<T>::GetInstance().Create(this, std::forward<Args>(args)...);
+            ComponentPtr component{rawPtr, ComponentDeleter{&DestroyPooledComponent<T>}};
 
-            m_componentMap[typeIdx] = rawPtr;
+            m_componentSlots[typeId] = rawPtr;
+            m_componentMask |= ComponentMask{1} << typeId;
             m_components.emplace_back(std::move(component));
+            NotifyComponentAdded(typeId);
 
-            CacheInterfacePointers(rawPtr);
+            // Undoes RemoveComponent<TransformComponent>, GetComponent and the hierarchy read the cached pointer
+            if constexpr (std::is_same_v<T, TransformComponent>)
+            {
+                m_transform = rawPtr;
+                NotifyHierarchyChanged();
+            }
+
+            // Usable right away, but only joins Update/Render once the scene applies its deferred changes
+            RegisterInterfaces(rawPtr);
 
             return rawPtr;
         }
@@ -79,64 +151,142 @@ namespace spark
         template <typename T>
         T *GetComponent() noexcept
         {
-            std::type_index typeIdx = std::type_index(typeid(T));
-            auto it = m_componentMap.find(typeIdx);
-            return (it != m_componentMap.end()) ? static_cast<T *>(it->second) : nullptr;
+            if constexpr (std::is_same_v<T, TransformComponent>)
+            {
+                return m_transform;
+            }
+            else
+            {
+                return static_cast<T *>(m_componentSlots[GetComponentTypeId<T>()]);
+            }
         }
 
         template <typename T>
         const T *GetComponent() const noexcept
         {
-            std::type_index typeIdx = std::type_index(typeid(T));
-            auto it = m_componentMap.find(typeIdx);
-            return (it != m_componentMap.end()) ? static_cast<const T *>(it->second) : nullptr;
+            if constexpr (std::is_same_v<T, TransformComponent>)
+            {
+                return m_transform;
+            }
+            else
+            {
+                return static_cast<const T *>(m_componentSlots[GetComponentTypeId<T>()]);
+            }
         }
 
         template <typename T>
         bool HasComponent() const noexcept
         {
-            std::type_index typeIdx = std::type_index(typeid(T));
-            return m_componentMap.find(typeIdx) != m_componentMap.end();
+            return HasComponents<T>();
         }
 
+        // True if every listed component type is attached, one mask test
+        template <typename... Ts>
+        bool HasComponents() const noexcept
+        {
+            const ComponentMask mask = GetComponentMask<Ts...>();
+            return (m_componentMask & mask) == mask;
+        }
+
+        bool HasComponentMask(ComponentMask mask) const noexcept { return (m_componentMask & mask) == mask; }
+        ComponentMask GetComponentBitmask() const noexcept { return m_componentMask; }
+
         template <typename T>
         void RemoveComponent()
         {
             static_assert(std::is_base_of_v<Component, T>, "T must be a Component");
+            if (IsDeferringChanges())
+            {
+                DeferChange([this]()
+                            { RemoveComponent<T>(); });
+                return;
+            }
 
-            std::type_index typeIdx = std::type_index(typeid(T));
-            auto it = m_componentMap.find(typeIdx);
-            if (it == m_componentMap.end())
+            const std::size_t typeId = GetComponentTypeId<T>();
+            Component *target = m_componentSlots[typeId];
+            if (!target)
                 return;
 
-            Component *target = it->second;
+            if constexpr (std::is_same_v<T, TransformComponent>)
+            {
+                m_transform = nullptr;
+                NotifyHierarchyChanged();
+            }
 
             RemoveFromInterfaceCaches(target);
-            m_componentMap.erase(it);
-            std::erase_if(m_components, [target](const std::unique_ptr<Component> &comp)
+            m_componentSlots[typeId] = nullptr;
+            m_componentMask &= ~(ComponentMask{1} << typeId);
+            NotifyComponentRemoved(typeId);
+            std::erase_if(m_components, [target](const ComponentPtr &comp)
                           { return comp.get() == target; });
         }
 
         TransformComponent *GetTransform() const noexcept { return m_transform; }
 
     private:
+        friend class Scene;
+        static constexpr std::uint32_t NoSiblingIndex = ~std::uint32_t{0};
+
+        void AddChild(GameObject *child);
+        void DetachChild(GameObject *child);
+        // What Render draws without a bitmap cache: the renderables, then the children
+        void RenderSubtree();
+        // False if the subtree can't be cached and has to be drawn as usual
+        bool RenderBitmapCache();
+        bool RedrawBitmapCache();
+        void GatherRenderBounds(SDL_FRect &bounds, bool &hasBounds, bool &hasUnbounded);
+        // The key that sorts first among the subtree's renderables
+        void GatherLowestSortKey(RenderSortKey &sortKey, bool &hasSortKey) const;
+        // False on the first serial updateable, sets hasUpdateables if the subtree updates anything
+        bool AreUpdateablesParallelSafe(bool &hasUpdateables) const noexcept;
+
+        // Only allocated for objects that cache, defined in the .cpp
+        struct BitmapCache;
+        std::unique_ptr<BitmapCache> m_bitmapCache;
+
         std::string m_name{"GameObject"};
+#ifndef SPARK_DISABLE_PROFILER
+        // Profiler label for m_name, interned on the first profiled Update
+        ProfileLabel m_profileLabel{InvalidProfileLabel};
+#endif
         bool m_isToBeDeleted{false};
         GameObject *m_parent{nullptr};
+        Scene *m_scene{nullptr};
+        GameObjectHandle m_handle{};
+        // Position in the parent's m_children, or in the scene's root list, so either can find it without a search
+        std::uint32_t m_siblingIndex{NoSiblingIndex};
         std::vector<std::unique_ptr<GameObject>> m_children{};
         std::vector<GameObject *> m_childrenRawPtrs{};
 
-        std::vector<std::unique_ptr<Component>> m_components;
-        std::unordered_map<std::type_index, Component *> m_componentMap;
+        std::vector<ComponentPtr> m_components;
+        std::array<Component *, MaxComponentTypes> m_componentSlots{};
+        ComponentMask m_componentMask{0};
+        TagMask m_tagMask{0};
 
         std::vector<IInitializable *> m_initializables;
         std::vector<IUpdateable *> m_updateables;
+        std::vector<IFixedUpdateable *> m_fixedUpdateables;
+        // Updateables that aren't IParallelUpdateable, these keep the object on the main thread
+        std::uint32_t m_serialUpdateableCount{0};
         std::vector<IRenderable *> m_renderables;
+        // The m_renderables that aren't IBoundedRenderable, a camera can't cull these
+        std::vector<IRenderable *> m_unboundedRenderables;
         std::vector<IImGuiRenderable *> m_imguiRenderables;
         std::vector<IInspectorRenderable *> m_inspectorRenderables;
 
         TransformComponent *m_transform{nullptr};
 
+        template <typename T>
+        static void DestroyPooledComponent(Component *component)
+        {
+            ObjectPool<T>::GetInstance().Destroy(static_cast<T *>(component));
+        }
+
+        void NotifyHierarchyChanged();
+        // Keep the scene's query indices in step with m_componentMask
+        void NotifyComponentAdded(std::size_t typeId);
+        void NotifyComponentRemoved(std::size_t typeId);
+        void RegisterInterfaces(Component *component);
         void CacheInterfacePointers(Component *component);
         void RemoveFromInterfaceCaches(Component *component);
 
@@ -23,12 +23,21 @@ FlockingSim = {
     cohesion_weight = 1.0,
     avoidance_weight = 3.0,
     
-    show_debug = false
+    show_debug = false,
+
+    -- Broadphase: boid positions are copied into a native array and indexed once per frame,
+    -- so each boid only looks at its neighbours instead of the whole flock
+    grid = nil,
+    positions = nil,
+    neighbors = {},
+    neighbor_count = 0
 }
 
 function Init()
     FlockingSim.transform = gameObject:GetTransformComponent()
     FlockingSim.renderer = get_renderer()
+    FlockingSim.grid = SpatialGrid(FlockingSim.alignment_radius)
+    FlockingSim.positions = Vec2Array(0)
     
     -- Create initial flock
     spawn_boids(40)
@@ -132,10 +141,16 @@ function update_boids(dt)
     local mouse_x, mouse_y = get_mouse_position()
     local mouse_pos = vec3(mouse_x, mouse_y, 0)
     
+    rebuild_grid()
+    local query_radius = math.max(FlockingSim.separation_radius, FlockingSim.alignment_radius, FlockingSim.cohesion_radius)
+    
     for i, boid in ipairs(FlockingSim.boids) do
         -- Reset acceleration
         boid.acceleration = vec3(0, 0, 0)
         
+        -- Gather neighbours once (grid indices are 0-based), shared by the three behaviours
+        FlockingSim.neighbor_count = FlockingSim.grid:query_radius(boid.pos.x, boid.pos.y, query_radius, FlockingSim.neighbors, i - 1)
+        
         -- Calculate flocking forces
         local sep = separate(boid)
         local ali = align(boid)
@@ -183,20 +198,28 @@ function update_boids(dt)
     end
 end
 
+function rebuild_grid()
+    local positions = FlockingSim.positions
+    positions:resize(#FlockingSim.boids)
+    for i, boid in ipairs(FlockingSim.boids) do
+        positions:set2(i - 1, boid.pos.x, boid.pos.y)
+    end
+    FlockingSim.grid:build(positions)
+end
+
 function separate(boid)
     local desired_separation = FlockingSim.separation_radius
     local steer = vec3(0, 0, 0)
     local count = 0
     
-    for i, other in ipairs(FlockingSim.boids) do
-        if other ~= boid then
-            local distance = (boid.pos - other.pos):length()
-            if distance > 0 and distance < desired_separation then
-                local diff = (boid.pos - other.pos):normalize()
-                diff = diff / distance -- Weight by distance
-                steer = steer + diff
-                count = count + 1
-            end
+    for n = 1, FlockingSim.neighbor_count do
+        local other = FlockingSim.boids[FlockingSim.neighbors[n] + 1]
+        local distance = (boid.pos - other.pos):length()
+        if distance > 0 and distance < desired_separation then
+            local diff = (boid.pos - other.pos):normalize()
+            diff = diff / distance -- Weight by distance
+            steer = steer + diff
+            count = count + 1
         end
     end
     
@@ -214,13 +237,12 @@ function align(boid)
     local sum = vec3(0, 0, 0)
     local count = 0
     
-    for i, other in ipairs(FlockingSim.boids) do
-        if other ~= boid then
-            local distance = (boid.pos - other.pos):length()
-            if distance > 0 and distance < neighbor_dist then
-                sum = sum + other.velocity
-                count = count + 1
-            end
+    for n = 1, FlockingSim.neighbor_count do
+        local other = FlockingSim.boids[FlockingSim.neighbors[n] + 1]
+        local distance = (boid.pos - other.pos):length()
+        if distance > 0 and distance < neighbor_dist then
+            sum = sum + other.velocity
+            count = count + 1
         end
     end
     
@@ -239,13 +261,12 @@ function cohesion(boid)
     local sum = vec3(0, 0, 0)
     local count = 0
     
-    for i, other in ipairs(FlockingSim.boids) do
-        if other ~= boid then
-            local distance = (boid.pos - other.pos):length()
-            if distance > 0 and distance < neighbor_dist then
-                sum = sum + other.pos
-                count = count + 1
-            end
+    for n = 1, FlockingSim.neighbor_count do
+        local other = FlockingSim.boids[FlockingSim.neighbors[n] + 1]
+        local distance = (boid.pos - other.pos):length()
+        if distance > 0 and distance < neighbor_dist then
+            sum = sum + other.pos
+            count = count + 1
         end
     end
     
@@ -8,16 +8,29 @@ GravitySim = {
     trails = {},
     mouse_mass = 1000.0,
     gravitational_constant = 50.0,
-    max_bodies = 30,
+    max_bodies = 400,
     max_trail_length = 50,
     time = 0,
     paused = false,
-    show_forces = false
+    show_forces = false,
+
+    -- Native gravity: body positions/masses are copied into buffers and the solver
+    -- computes every pairwise attraction in C++ (Barnes-Hut once there are many bodies)
+    solver = nil,
+    positions = nil,
+    masses = nil,
+    accelerations = nil
 }
 
 function Init()
     GravitySim.transform = gameObject:GetTransformComponent()
     GravitySim.renderer = get_renderer()
+    GravitySim.solver = NBodySolver()
+    GravitySim.solver:set_gravitational_constant(GravitySim.gravitational_constant)
+    GravitySim.solver:set_softening(1.0)
+    GravitySim.positions = Vec2Array(0)
+    GravitySim.masses = FloatBuffer(0)
+    GravitySim.accelerations = Vec2Array(0)
     
     -- Create some initial bodies
     spawn_random_bodies(8)
@@ -77,16 +90,19 @@ end
 function update_physics(dt)
     local mouse_x, mouse_y = get_mouse_position()
     
-    for i, body in ipairs(GravitySim.bodies) do
-        local total_force = vec3(0, 0, 0)
-        
-        -- Calculate gravitational forces from other bodies
-        for j, other_body in ipairs(GravitySim.bodies) do
-            if i ~= j then
-                local force = calculate_gravitational_force(body, other_body)
-                total_force = total_force + force
-            end
-        end
+    -- Gravitational forces from other bodies, all at once
+    local bodies = GravitySim.bodies
+    GravitySim.positions:resize(#bodies)
+    GravitySim.masses:resize(#bodies)
+    for i, body in ipairs(bodies) do
+        GravitySim.positions:set2(i - 1, body.pos.x, body.pos.y)
+        GravitySim.masses:set(i - 1, body.mass)
+    end
+    GravitySim.solver:compute(GravitySim.positions, GravitySim.masses, GravitySim.accelerations)
+    
+    for i, body in ipairs(bodies) do
+        local ax, ay = GravitySim.accelerations:get2(i - 1)
+        local total_force = vec3(ax, ay, 0) * body.mass
         
         -- Mouse interaction forces
         local mouse_pos = vec3(mouse_x, mouse_y, 0)
@@ -125,18 +141,6 @@ function update_physics(dt)
     end
 end
 
-function calculate_gravitational_force(body1, body2)
-    local direction = body2.pos - body1.pos
-    local distance = direction:length()
-    
-    if distance < 1.0 then
-        return vec3(0, 0, 0) -- Avoid division by zero and extreme forces
-    end
-    
-    local force_magnitude = (GravitySim.gravitational_constant * body1.mass * body2.mass) / (distance * distance)
-    return direction:normalize() * force_magnitude
-end
-
 function update_trails()
     -- Remove old trail points
     local current_time = GravitySim.time
@@ -11,7 +11,11 @@ ParticleFountain = {
     wind = vec3(0, 0, 0),
     time = 0,
     mouse_force_strength = 500.0,
-    particle_lifetime = 5.0
+    particle_lifetime = 5.0,
+
+    -- Reused every frame for bulk line submission
+    line_buffer = {},
+    color_buffer = {}
 }
 
 function Init()
@@ -227,6 +231,11 @@ function cleanup_particles()
 end
 
 function draw_particles()
+    -- Collect every particle segment into flat arrays and submit them in a single call
+    local lines = ParticleFountain.line_buffer
+    local colors = ParticleFountain.color_buffer
+    local count = 0
+
     for i, particle in ipairs(ParticleFountain.particles) do
         local life_ratio = particle.life / particle.max_life
         local alpha = life_ratio * 0.8
@@ -236,19 +245,45 @@ function draw_particles()
         local g = particle.color.g * life_ratio
         local b = particle.color.b * life_ratio
         
-        ParticleFountain.renderer:set_draw_color_float(r, g, b, alpha)
-        
         -- Draw particle as small filled circle
-        draw_filled_circle(particle.pos, particle.size * life_ratio, 6)
+        count = append_filled_circle(lines, colors, count, particle.pos, particle.size * life_ratio, 6, r, g, b, alpha)
         
         -- Draw velocity trail for fast particles
         local speed = particle.velocity:length()
         if speed > 50 then
-            ParticleFountain.renderer:set_draw_color_float(r, g, b, alpha * 0.3)
             local trail_end = particle.pos - particle.velocity:normalize() * (speed * 0.05)
-            ParticleFountain.renderer:render_line(particle.pos.x, particle.pos.y, trail_end.x, trail_end.y)
+            count = append_line(lines, colors, count, particle.pos.x, particle.pos.y, trail_end.x, trail_end.y, r, g, b, alpha * 0.3)
+        end
+    end
+
+    ParticleFountain.renderer:render_line_list(lines, colors, count)
+end
+
+function append_line(lines, colors, count, x1, y1, x2, y2, r, g, b, a)
+    local base = count * 4
+    lines[base + 1] = x1
+    lines[base + 2] = y1
+    lines[base + 3] = x2
+    lines[base + 4] = y2
+    colors[base + 1] = r
+    colors[base + 2] = g
+    colors[base + 3] = b
+    colors[base + 4] = a
+    return count + 1
+end
+
+function append_filled_circle(lines, colors, count, pos, radius, segments, r, g, b, a)
+    for ring = 1, radius, 1 do
+        for i = 0, segments - 1 do
+            local angle1 = (i / segments) * 2 * math.pi
+            local angle2 = ((i + 1) / segments) * 2 * math.pi
+            count = append_line(lines, colors, count,
+                pos.x + math.cos(angle1) * ring, pos.y + math.sin(angle1) * ring,
+                pos.x + math.cos(angle2) * ring, pos.y + math.sin(angle2) * ring,
+                r, g, b, a)
         end
     end
+    return count
 end
 
 function draw_emitters()
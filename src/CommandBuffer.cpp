@@ -0,0 +1,84 @@
+#include "CommandBuffer.h"
+#include <algorithm>
+
+namespace spark
+{
+    namespace
+    {
+        thread_local CommandBuffer *t_currentBuffer{nullptr};
+    }
+
+    CommandBuffer *CommandBuffer::GetCurrent()
+    {
+        return t_currentBuffer;
+    }
+
+    CommandBuffer::Scope::Scope(CommandBuffer &buffer) : Scope{buffer, buffer.m_sortKey}
+    {
+    }
+
+    CommandBuffer::Scope::Scope(CommandBuffer &buffer, std::uint32_t sortKey)
+        : m_previous{t_currentBuffer}, m_buffer{buffer}, m_previousSortKey{buffer.m_sortKey}
+    {
+        t_currentBuffer = &buffer;
+        buffer.m_sortKey = sortKey;
+    }
+
+    CommandBuffer::Scope::~Scope()
+    {
+        // Restores rather than clears: the main thread's worker chunk sits inside the scene's own scope, and a worker
+        // waiting inside a nested ParallelFor may run another root's chunk
+        t_currentBuffer = m_previous;
+        m_buffer.m_sortKey = m_previousSortKey;
+    }
+
+    void CommandBuffer::Delete(GameObject *gameObject)
+    {
+        Push([gameObject]()
+             { gameObject->Delete(); });
+    }
+
+    void CommandBuffer::SetParent(GameObject *gameObject, GameObject *newParent, bool keepWorldPos)
+    {
+        Push([gameObject, newParent, keepWorldPos]()
+             { gameObject->SetParent(newParent, keepWorldPos); });
+    }
+
+    void CommandBuffer::Push(std::function<void()> command)
+    {
+        m_commands.push_back(Command{m_sortKey, std::move(command)});
+    }
+
+    void CommandBuffer::Playback()
+    {
+        // Moved out first: a command may record new ones if another buffer is current
+        std::vector<Command> commands;
+        commands.swap(m_commands);
+        for (Command &command : commands)
+        {
+            command.apply();
+        }
+    }
+
+    void CommandBuffer::Playback(std::vector<CommandBuffer> &buffers)
+    {
+        std::vector<Command> commands;
+        for (CommandBuffer &buffer : buffers)
+        {
+            std::move(buffer.m_commands.begin(), buffer.m_commands.end(), std::back_inserter(commands));
+            buffer.m_commands.clear();
+        }
+        if (commands.empty())
+        {
+            return;
+        }
+
+        // Stable: commands from the same root keep the order they were recorded in
+        std::stable_sort(commands.begin(), commands.end(), [](const Command &a, const Command &b)
+                         { return a.sortKey < b.sortKey; });
+        for (Command &command : commands)
+        {
+            command.apply();
+        }
+    }
+} // namespace spark
@@ -0,0 +1,145 @@
+#include "Components/CameraComponent.h"
+#include "Components/TransformComponent.h"
+#include "GameObject.h"
+#include "Scene.h"
+#include <imgui.h>
+#include <algorithm>
+#include <cmath>
+
+namespace spark
+{
+    void CameraComponent::RenderInspector()
+    {
+        if (ImGui::CollapsingHeader("Camera", ImGuiTreeNodeFlags_DefaultOpen))
+        {
+            ImGui::DragFloat("Zoom", &m_zoom, 0.01f, 0.01f, 100.0f);
+            ImGui::DragFloat("Rotation", &m_rotation, 1.0f, -360.0f, 360.0f);
+            ImGui::DragFloat4("Viewport", &m_viewport.x, 1.0f, 0.0f, 16384.0f);
+            ImGui::Checkbox("Culling", &m_isCullingEnabled);
+
+            if (Scene *scene = GetParent()->GetScene())
+            {
+                if (scene->GetCamera() == this)
+                {
+                    ImGui::Text("Drawn: %zu, culled: %zu, cached subtrees: %zu", scene->GetLastDrawnCount(), scene->GetLastCulledCount(),
+                                scene->GetLastCachedCount());
+                }
+                else if (ImGui::Button("Make Current"))
+                {
+                    MakeCurrent();
+                }
+            }
+            ImGui::Separator();
+        }
+    }
+
+    SDL_FRect CameraComponent::GetResolvedViewport() const
+    {
+        if (m_viewport.w > 0.0f && m_viewport.h > 0.0f)
+        {
+            return m_viewport;
+        }
+
+        int width = 0;
+        int height = 0;
+        SDL_GetCurrentRenderOutputSize(Renderer::GetInstance().GetSDLRenderer(), &width, &height);
+        return SDL_FRect{0.0f, 0.0f, static_cast<float>(width), static_cast<float>(height)};
+    }
+
+    glm::vec2 CameraComponent::GetPosition() const
+    {
+        const TransformComponent *transform = GetParent()->GetTransform();
+        if (!transform)
+        {
+            return glm::vec2{0.0f};
+        }
+        const glm::vec3 position = transform->GetWorldPosition();
+        return glm::vec2{position.x, position.y};
+    }
+
+    ViewTransform CameraComponent::GetViewTransform() const
+    {
+        const SDL_FRect viewport = GetResolvedViewport();
+        const glm::vec2 position = GetPosition();
+        const float radians = glm::radians(m_rotation);
+        const float cosine = std::cos(radians) * m_zoom;
+        const float sine = std::sin(radians) * m_zoom;
+
+        // Around the camera position, then out to the viewport centre
+        ViewTransform view;
+        view.xx = cosine;
+        view.yx = sine;
+        view.xy = -sine;
+        view.yy = cosine;
+        view.tx = viewport.w * 0.5f - (view.xx * position.x + view.yx * position.y);
+        view.ty = viewport.h * 0.5f - (view.xy * position.x + view.yy * position.y);
+        return view;
+    }
+
+    glm::vec2 CameraComponent::ScreenToWorld(const glm::vec2 &screen) const
+    {
+        const SDL_FRect viewport = GetResolvedViewport();
+        const float radians = glm::radians(m_rotation);
+        const float cosine = std::cos(radians) / m_zoom;
+        const float sine = std::sin(radians) / m_zoom;
+        const float x = screen.x - viewport.x - viewport.w * 0.5f;
+        const float y = screen.y - viewport.y - viewport.h * 0.5f;
+        return GetPosition() + glm::vec2{cosine * x - sine * y, sine * x + cosine * y};
+    }
+
+    glm::vec2 CameraComponent::WorldToScreen(const glm::vec2 &world) const
+    {
+        const SDL_FRect viewport = GetResolvedViewport();
+        const ViewTransform view = GetViewTransform();
+        return glm::vec2{view.xx * world.x + view.yx * world.y + view.tx + viewport.x,
+                         view.xy * world.x + view.yy * world.y + view.ty + viewport.y};
+    }
+
+    SDL_FRect CameraComponent::GetVisibleWorldBounds() const
+    {
+        const SDL_FRect viewport = GetResolvedViewport();
+        const glm::vec2 corners[4] = {ScreenToWorld({viewport.x, viewport.y}),
+                                      ScreenToWorld({viewport.x + viewport.w, viewport.y}),
+                                      ScreenToWorld({viewport.x + viewport.w, viewport.y + viewport.h}),
+                                      ScreenToWorld({viewport.x, viewport.y + viewport.h})};
+        glm::vec2 min = corners[0];
+        glm::vec2 max = corners[0];
+        for (const glm::vec2 &corner : corners)
+        {
+            min = glm::vec2{std::min(min.x, corner.x), std::min(min.y, corner.y)};
+            max = glm::vec2{std::max(max.x, corner.x), std::max(max.y, corner.y)};
+        }
+        return SDL_FRect{min.x, min.y, max.x - min.x, max.y - min.y};
+    }
+
+    void CameraComponent::BeginRender() const
+    {
+        Renderer &renderer = Renderer::GetInstance();
+        if (m_viewport.w > 0.0f && m_viewport.h > 0.0f)
+        {
+            const SDL_Rect viewport{static_cast<int>(m_viewport.x), static_cast<int>(m_viewport.y),
+                                    static_cast<int>(m_viewport.w), static_cast<int>(m_viewport.h)};
+            renderer.SetViewport(&viewport);
+        }
+        renderer.SetViewTransform(GetViewTransform());
+        renderer.SetViewTransformEnabled(true);
+    }
+
+    void CameraComponent::EndRender() const
+    {
+        Renderer &renderer = Renderer::GetInstance();
+        renderer.SetViewTransformEnabled(false);
+        if (m_viewport.w > 0.0f && m_viewport.h > 0.0f)
+        {
+            renderer.SetViewport(nullptr);
+        }
+    }
+
+    void CameraComponent::MakeCurrent()
+    {
+        if (Scene *scene = GetParent()->GetScene())
+        {
+            scene->SetCamera(this);
+        }
+    }
+} // namespace spark
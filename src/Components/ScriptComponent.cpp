@@ -1,5 +1,6 @@
 #include "Components/ScriptComponent.h"
 #include "LuaInstance.h"
+#include "GameTime.h"
 #include "imgui.h"
 #include <fstream>
 #include <sstream>
@@ -25,14 +26,21 @@ namespace spark
     void ScriptComponent::Init()
     {
         m_scriptEnv["gameObject"] = GetParent();
+#ifndef SPARK_DISABLE_PROFILER
+        m_updateLabel = Profiler::GetInstance().InternLabel("Update " + m_scriptPath);
+        m_fixedUpdateLabel = Profiler::GetInstance().InternLabel("FixedUpdate " + m_scriptPath);
+        m_renderLabel = Profiler::GetInstance().InternLabel("Render " + m_scriptPath);
+#endif
 
         m_hasInitFunction = false;
         m_hasUpdateFunction = false;
+        m_hasFixedUpdateFunction = false;
         m_hasRenderFunction = false;
         m_hasRenderImGuiFunction = false;
 
         m_luaInit = sol::nil;
         m_luaUpdate = sol::nil;
+        m_luaFixedUpdate = sol::nil;
         m_luaRender = sol::nil;
         m_luaImGuiRender = sol::nil;
 
@@ -40,6 +48,7 @@ namespace spark
         {
             m_luaInit = m_scriptEnv["Init"];
             m_luaUpdate = m_scriptEnv["Update"];
+            m_luaFixedUpdate = m_scriptEnv["FixedUpdate"];
             m_luaRender = m_scriptEnv["Render"];
             m_luaImGuiRender = m_scriptEnv["RenderImGui"];
 
@@ -65,6 +74,17 @@ namespace spark
                 std::cerr << "Script '" << m_scriptPath << "': 'Update' found but is not a function.\n";
             }
 
+            sol::object luaFixedUpdateObj = m_scriptEnv["FixedUpdate"];
+            if (luaFixedUpdateObj.is<sol::function>())
+            {
+                m_luaFixedUpdate = luaFixedUpdateObj.as<sol::protected_function>();
+                m_hasFixedUpdateFunction = true;
+            }
+            else if (luaFixedUpdateObj.valid())
+            {
+                std::cerr << "Script '" << m_scriptPath << "': 'FixedUpdate' found but is not a function.\n";
+            }
+
             sol::object luaRenderObj = m_scriptEnv["Render"];
             if (luaRenderObj.is<sol::function>())
             {
@@ -175,7 +195,9 @@ namespace spark
             return false;
         }
 
-        auto result = lua.safe_script(m_scriptContent, m_scriptEnv);
+        LuaProfileScope luaProfileScope{LuaInstance::GetInstance().GetProfiler(), m_scriptPath};
+        // "@path" makes Lua report the file path in errors, tracebacks and profiler samples
+        auto result = lua.safe_script(m_scriptContent, m_scriptEnv, "@" + m_scriptPath);
         if (!result.valid())
         {
             sol::error error = result;
@@ -192,6 +214,8 @@ namespace spark
         {
             return;
         }
+        SPARK_PROFILE_SCOPE_LABEL(m_updateLabel);
+        LuaProfileScope luaProfileScope{LuaInstance::GetInstance().GetProfiler(), m_scriptPath};
         auto result = m_luaUpdate(dt);
         if (!result.valid())
         {
@@ -200,13 +224,32 @@ namespace spark
         }
     }
 
+    void ScriptComponent::FixedUpdate(float fixedDt)
+    {
+        if (!m_hasFixedUpdateFunction)
+        {
+            return;
+        }
+        SPARK_PROFILE_SCOPE_LABEL(m_fixedUpdateLabel);
+        LuaProfileScope luaProfileScope{LuaInstance::GetInstance().GetProfiler(), m_scriptPath};
+        auto result = m_luaFixedUpdate(fixedDt);
+        if (!result.valid())
+        {
+            sol::error error = result;
+            std::cerr << "Error in Lua script FixedUpdate(): " << error.what() << "\n";
+        }
+    }
+
     void ScriptComponent::Render()
     {
         if (!m_hasRenderFunction)
         {
             return;
         }
-        auto result = m_luaRender();
+        SPARK_PROFILE_SCOPE_LABEL(m_renderLabel);
+        LuaProfileScope luaProfileScope{LuaInstance::GetInstance().GetProfiler(), m_scriptPath};
+        // Render(alpha) may blend the last two FixedUpdate states, scripts that don't care just ignore it
+        auto result = m_luaRender(GameTime::GetInstance().GetInterpolationAlpha());
         if (!result.valid())
         {
             sol::error error = result;
@@ -220,6 +263,7 @@ namespace spark
         {
             return;
         }
+        LuaProfileScope luaProfileScope{LuaInstance::GetInstance().GetProfiler(), m_scriptPath};
         auto result = m_luaImGuiRender();
         if (!result.valid())
         {
@@ -311,6 +355,8 @@ namespace spark
                 }
                 ImGui::EndPopup();
             }
+
+            RenderLuaProfiler();
             ImGui::Separator();
         }
 
@@ -468,6 +514,74 @@ namespace spark
         }
     }
 
+    void ScriptComponent::RenderLuaProfiler()
+    {
+        LuaProfiler &profiler = LuaInstance::GetInstance().GetProfiler();
+        bool isProfiling = profiler.IsScriptEnabled(m_scriptPath);
+        if (ImGui::Checkbox("Profile Lua", &isProfiling))
+        {
+            profiler.SetScriptEnabled(m_scriptPath, isProfiling);
+        }
+        if (!isProfiling && profiler.GetSampleCount(m_scriptPath) == 0)
+        {
+            return;
+        }
+
+        ImGui::SameLine();
+        if (ImGui::Button("Reset##LuaProfiler"))
+        {
+            profiler.Reset(m_scriptPath);
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Export Collapsed"))
+        {
+            const std::string exportPath = m_scriptPath + ".folded";
+            if (profiler.WriteCollapsedFile(m_scriptPath, exportPath))
+            {
+                std::cout << "Lua profile written to " << exportPath << std::endl;
+            }
+        }
+
+        int sampleInterval = profiler.GetSampleInterval();
+        if (ImGui::SliderInt("Sample Interval", &sampleInterval, 100, 10000, "%d instructions", ImGuiSliderFlags_Logarithmic))
+        {
+            profiler.SetSampleInterval(sampleInterval);
+        }
+
+        const double totalMs = static_cast<double>(profiler.GetTotalNs(m_scriptPath)) / 1.0e6;
+        ImGui::Text("Sampled: %.2f ms in %u samples", totalMs, profiler.GetSampleCount(m_scriptPath));
+
+        constexpr std::size_t MaxShownLines = 12;
+        const auto lines = profiler.GetTopLines(m_scriptPath, MaxShownLines);
+        if (lines.empty())
+        {
+            return;
+        }
+
+        if (ImGui::BeginTable("##LuaProfilerLines", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_SizingStretchProp))
+        {
+            ImGui::TableSetupColumn("Function");
+            ImGui::TableSetupColumn("Line");
+            ImGui::TableSetupColumn("Self ms");
+            ImGui::TableSetupColumn("%");
+            ImGui::TableHeadersRow();
+            for (const auto &line : lines)
+            {
+                const double selfMs = static_cast<double>(line.selfNs) / 1.0e6;
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(line.function.c_str());
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(line.location.c_str());
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f", selfMs);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.1f", totalMs > 0.0 ? selfMs / totalMs * 100.0 : 0.0);
+            }
+            ImGui::EndTable();
+        }
+    }
+
     int ScriptComponent::TextEditCallback(ImGuiInputTextCallbackData *data)
     {
         ScriptComponent *component = static_cast<ScriptComponent *>(data->UserData);
@@ -513,10 +627,12 @@ namespace spark
             std::cerr << "ReloadScript: Failed to load script content from file. Aborting reload.\n";
             m_hasInitFunction = false;
             m_hasUpdateFunction = false;
+            m_hasFixedUpdateFunction = false;
             m_hasRenderFunction = false;
             m_hasRenderImGuiFunction = false;
             m_luaInit = sol::nil;
             m_luaUpdate = sol::nil;
+            m_luaFixedUpdate = sol::nil;
             m_luaRender = sol::nil;
             m_luaImGuiRender = sol::nil;
             return false;
@@ -530,6 +646,7 @@ namespace spark
 
         if (m_hasInitFunction && m_luaInit.valid())
         {
+            LuaProfileScope luaProfileScope{LuaInstance::GetInstance().GetProfiler(), m_scriptPath};
             auto result = m_luaInit();
             if (!result.valid())
             {
@@ -677,11 +794,13 @@ namespace spark
         // Reset all Lua function flags and references
         m_hasInitFunction = false;
         m_hasUpdateFunction = false;
+        m_hasFixedUpdateFunction = false;
         m_hasRenderFunction = false;
         m_hasRenderImGuiFunction = false;
 
         m_luaInit = sol::nil;
         m_luaUpdate = sol::nil;
+        m_luaFixedUpdate = sol::nil;
         m_luaRender = sol::nil;
         m_luaImGuiRender = sol::nil;
     }
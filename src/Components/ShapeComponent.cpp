@@ -0,0 +1,353 @@
+#include "Components/ShapeComponent.h"
+#include "Components/TransformComponent.h"
+#include "GameObject.h"
+#include "Renderer.h"
+#include "Profiler.h"
+#include "Triangulation.h"
+#include <imgui.h>
+#include <algorithm>
+#include <cmath>
+
+namespace spark
+{
+    namespace
+    {
+        constexpr float Pi = 3.14159265358979f;
+        // How far the chords of an arc may stray from the curve, in local units
+        constexpr float ArcTolerance = 0.25f;
+        constexpr int MaxArcSegments = 256;
+
+        float Cross(const glm::vec2 &a, const glm::vec2 &b)
+        {
+            return a.x * b.y - a.y * b.x;
+        }
+    }
+
+    void ShapeComponent::Render()
+    {
+        if (m_isTessellationDirty)
+        {
+            Tessellate();
+        }
+        if (m_indices.empty())
+        {
+            return;
+        }
+
+        const TransformComponent *transform = GetParent()->GetTransform();
+        const glm::mat4 worldMatrix = transform ? transform->GetWorldMatrix() : glm::mat4{1.0f};
+        if (!m_areWorldVerticesValid || worldMatrix != m_worldMatrix)
+        {
+            // Shapes are flat, only the 2D part of the matrix matters
+            const float xx = worldMatrix[0][0];
+            const float xy = worldMatrix[0][1];
+            const float yx = worldMatrix[1][0];
+            const float yy = worldMatrix[1][1];
+            const float tx = worldMatrix[3][0];
+            const float ty = worldMatrix[3][1];
+
+            m_worldVertices.resize(m_localVertices.size());
+            for (std::size_t i = 0; i < m_localVertices.size(); ++i)
+            {
+                const SDL_FPoint &local = m_localVertices[i].position;
+                m_worldVertices[i].position = SDL_FPoint{xx * local.x + yx * local.y + tx, xy * local.x + yy * local.y + ty};
+                m_worldVertices[i].color = m_localVertices[i].color;
+                m_worldVertices[i].tex_coord = SDL_FPoint{0.0f, 0.0f};
+            }
+            m_worldMatrix = worldMatrix;
+            m_areWorldVerticesValid = true;
+        }
+
+        Renderer::GetInstance().RenderGeometry(nullptr, m_worldVertices.data(), static_cast<int>(m_worldVertices.size()),
+                                               m_indices.data(), static_cast<int>(m_indices.size()));
+    }
+
+    bool ShapeComponent::GetWorldBounds(SDL_FRect &bounds)
+    {
+        if (m_isTessellationDirty)
+        {
+            Tessellate();
+        }
+        if (m_indices.empty())
+        {
+            return false;
+        }
+
+        const TransformComponent *transform = GetParent()->GetTransform();
+        const glm::mat4 worldMatrix = transform ? transform->GetWorldMatrix() : glm::mat4{1.0f};
+        const glm::vec2 corners[4] = {m_localMin, glm::vec2{m_localMax.x, m_localMin.y}, m_localMax,
+                                      glm::vec2{m_localMin.x, m_localMax.y}};
+        glm::vec2 min{0.0f};
+        glm::vec2 max{0.0f};
+        for (std::size_t i = 0; i < 4; ++i)
+        {
+            const glm::vec2 world{worldMatrix[0][0] * corners[i].x + worldMatrix[1][0] * corners[i].y + worldMatrix[3][0],
+                                  worldMatrix[0][1] * corners[i].x + worldMatrix[1][1] * corners[i].y + worldMatrix[3][1]};
+            min = i == 0 ? world : glm::vec2{std::min(min.x, world.x), std::min(min.y, world.y)};
+            max = i == 0 ? world : glm::vec2{std::max(max.x, world.x), std::max(max.y, world.y)};
+        }
+        bounds = SDL_FRect{min.x, min.y, max.x - min.x, max.y - min.y};
+        return true;
+    }
+
+    void ShapeComponent::RenderInspector()
+    {
+        if (ImGui::CollapsingHeader("Shape", ImGuiTreeNodeFlags_DefaultOpen))
+        {
+            ImGui::Text("Paths: %zu", GetPathCount());
+            ImGui::Text("Triangles: %zu", GetTriangleCount());
+            ImGui::Text("Tessellations: %zu", m_tessellationCount);
+            ImGui::Separator();
+        }
+    }
+
+    void ShapeComponent::Clear()
+    {
+        m_paths.clear();
+        m_isPathOpen = false;
+        MarkPathsChanged();
+    }
+
+    void ShapeComponent::SetFill(const SDL_FColor &color)
+    {
+        m_isFilled = true;
+        m_fillColor = color;
+    }
+
+    void ShapeComponent::SetNoFill()
+    {
+        m_isFilled = false;
+    }
+
+    void ShapeComponent::SetLineStyle(float width, const SDL_FColor &color)
+    {
+        m_lineWidth = std::max(width, 0.0f);
+        m_lineColor = color;
+    }
+
+    void ShapeComponent::MoveTo(float x, float y)
+    {
+        BeginPath().points.emplace_back(x, y);
+    }
+
+    void ShapeComponent::LineTo(float x, float y)
+    {
+        if (!m_isPathOpen)
+        {
+            MoveTo(x, y);
+            return;
+        }
+
+        std::vector<glm::vec2> &points = m_paths.back().points;
+        const glm::vec2 point{x, y};
+        if (points.empty() || points.back() != point)
+        {
+            points.push_back(point);
+            MarkPathsChanged();
+        }
+    }
+
+    void ShapeComponent::Arc(float centerX, float centerY, float radius, float startDegrees, float endDegrees)
+    {
+        const float start = glm::radians(startDegrees);
+        const float angle = glm::radians(endDegrees) - start;
+        const int segments = ArcSegments(radius, angle);
+        for (int i = 0; i <= segments; ++i)
+        {
+            const float t = start + angle * (static_cast<float>(i) / segments);
+            LineTo(centerX + std::cos(t) * radius, centerY + std::sin(t) * radius);
+        }
+    }
+
+    void ShapeComponent::ClosePath()
+    {
+        if (m_isPathOpen)
+        {
+            // Closing back onto the first point would leave a zero length edge
+            std::vector<glm::vec2> &points = m_paths.back().points;
+            if (points.size() > 1 && points.back() == points.front())
+            {
+                points.pop_back();
+            }
+            m_paths.back().isClosed = true;
+            m_isPathOpen = false;
+            MarkPathsChanged();
+        }
+    }
+
+    void ShapeComponent::AddRect(float x, float y, float width, float height)
+    {
+        MoveTo(x, y);
+        LineTo(x + width, y);
+        LineTo(x + width, y + height);
+        LineTo(x, y + height);
+        ClosePath();
+    }
+
+    void ShapeComponent::AddCircle(float centerX, float centerY, float radius)
+    {
+        AddEllipse(centerX, centerY, radius, radius);
+    }
+
+    void ShapeComponent::AddEllipse(float centerX, float centerY, float radiusX, float radiusY)
+    {
+        const int segments = std::max(ArcSegments(std::max(radiusX, radiusY), 2.0f * Pi), 8);
+        Path &path = BeginPath();
+        path.points.reserve(segments);
+        for (int i = 0; i < segments; ++i)
+        {
+            const float t = 2.0f * Pi * (static_cast<float>(i) / segments);
+            path.points.emplace_back(centerX + std::cos(t) * radiusX, centerY + std::sin(t) * radiusY);
+        }
+        ClosePath();
+    }
+
+    void ShapeComponent::AddPolygon(const float *points, std::size_t pointCount)
+    {
+        if (pointCount == 0)
+        {
+            return;
+        }
+        MoveTo(points[0], points[1]);
+        for (std::size_t i = 1; i < pointCount; ++i)
+        {
+            LineTo(points[i * 2], points[i * 2 + 1]);
+        }
+        ClosePath();
+    }
+
+    std::size_t ShapeComponent::GetTriangleCount()
+    {
+        if (m_isTessellationDirty)
+        {
+            Tessellate();
+        }
+        return m_indices.size() / 3;
+    }
+
+    ShapeComponent::Path &ShapeComponent::BeginPath()
+    {
+        Path &path = m_paths.emplace_back();
+        path.isFilled = m_isFilled;
+        path.fillColor = m_fillColor;
+        path.lineWidth = m_lineWidth;
+        path.lineColor = m_lineColor;
+        m_isPathOpen = true;
+        MarkPathsChanged();
+        return path;
+    }
+
+    void ShapeComponent::MarkPathsChanged()
+    {
+        m_isTessellationDirty = true;
+        ++m_boundsVersion;
+        if (GameObject *owner = GetParent())
+        {
+            owner->InvalidateBitmapCache();
+        }
+    }
+
+    int ShapeComponent::ArcSegments(float radius, float angle)
+    {
+        const float step = radius > ArcTolerance ? 2.0f * std::acos(1.0f - ArcTolerance / radius) : Pi * 0.5f;
+        const int segments = static_cast<int>(std::ceil(std::abs(angle) / step));
+        return std::clamp(segments, 1, MaxArcSegments);
+    }
+
+    void ShapeComponent::Tessellate()
+    {
+        SPARK_PROFILE_SCOPE("ShapeComponent::Tessellate");
+        m_localVertices.clear();
+        m_indices.clear();
+        for (const Path &path : m_paths)
+        {
+            // Fill first so the outline is drawn on top of it
+            if (path.isFilled && path.isClosed && path.points.size() >= 3)
+            {
+                TessellateFill(path);
+            }
+            if (path.lineWidth > 0.0f && path.points.size() >= 2)
+            {
+                TessellateStroke(path);
+            }
+        }
+
+        m_localMin = glm::vec2{0.0f};
+        m_localMax = glm::vec2{0.0f};
+        if (!m_localVertices.empty())
+        {
+            m_localMin = m_localMax = glm::vec2{m_localVertices[0].position.x, m_localVertices[0].position.y};
+            for (const SDL_Vertex &vertex : m_localVertices)
+            {
+                m_localMin = glm::vec2{std::min(m_localMin.x, vertex.position.x), std::min(m_localMin.y, vertex.position.y)};
+                m_localMax = glm::vec2{std::max(m_localMax.x, vertex.position.x), std::max(m_localMax.y, vertex.position.y)};
+            }
+        }
+
+        m_isTessellationDirty = false;
+        m_areWorldVerticesValid = false;
+        ++m_tessellationCount;
+    }
+
+    void ShapeComponent::TessellateFill(const Path &path)
+    {
+        const std::vector<glm::vec2> &points = path.points;
+        const int base = static_cast<int>(m_localVertices.size());
+        for (const glm::vec2 &point : points)
+        {
+            AddVertex(point, path.fillColor);
+        }
+
+        TriangulatePolygon(points, base, m_indices);
+    }
+
+    void ShapeComponent::TessellateStroke(const Path &path)
+    {
+        const std::vector<glm::vec2> &points = path.points;
+        const std::size_t segmentCount = path.isClosed ? points.size() : points.size() - 1;
+        const float halfWidth = path.lineWidth * 0.5f;
+
+        const auto normalOf = [&](std::size_t segment)
+        {
+            const glm::vec2 delta = points[(segment + 1) % points.size()] - points[segment];
+            const float length = glm::length(delta);
+            return length > 0.0f ? glm::vec2{-delta.y, delta.x} * (halfWidth / length) : glm::vec2{0.0f};
+        };
+
+        // A quad per segment
+        for (std::size_t segment = 0; segment < segmentCount; ++segment)
+        {
+            const glm::vec2 &from = points[segment];
+            const glm::vec2 &to = points[(segment + 1) % points.size()];
+            const glm::vec2 normal = normalOf(segment);
+            const int base = static_cast<int>(m_localVertices.size());
+            AddVertex(from + normal, path.lineColor);
+            AddVertex(to + normal, path.lineColor);
+            AddVertex(to - normal, path.lineColor);
+            AddVertex(from - normal, path.lineColor);
+            m_indices.insert(m_indices.end(), {base, base + 1, base + 2, base, base + 2, base + 3});
+        }
+
+        // Bevel joins: the gap left on the outside of each corner is closed with a triangle
+        const std::size_t cornerCount = path.isClosed ? points.size() : points.size() - 2;
+        for (std::size_t k = 0; k < cornerCount; ++k)
+        {
+            const std::size_t corner = path.isClosed ? k : k + 1;
+            const glm::vec2 normalIn = normalOf((corner + points.size() - 1) % points.size());
+            const glm::vec2 normalOut = normalOf(corner);
+            // Turning towards the normals puts them on the inside
+            const float side = Cross(normalIn, normalOut) > 0.0f ? -1.0f : 1.0f;
+            const glm::vec2 &point = points[corner];
+            const int base = static_cast<int>(m_localVertices.size());
+            AddVertex(point, path.lineColor);
+            AddVertex(point + normalIn * side, path.lineColor);
+            AddVertex(point + normalOut * side, path.lineColor);
+            m_indices.insert(m_indices.end(), {base, base + 1, base + 2});
+        }
+    }
+
+    void ShapeComponent::AddVertex(const glm::vec2 &position, const SDL_FColor &color)
+    {
+        m_localVertices.push_back(SDL_Vertex{SDL_FPoint{position.x, position.y}, color, SDL_FPoint{0.0f, 0.0f}});
+    }
+} // namespace spark
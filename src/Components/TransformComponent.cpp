@@ -14,6 +14,7 @@ void spark::TransformComponent::SetLocalRotation(const glm::quat &rotation)
     if (m_localRotation != rotation)
     {
         m_localRotation = rotation;
+        SetDirtyRecursive();
     }
 }
 
@@ -54,7 +55,7 @@ const glm::mat4 &spark::TransformComponent::GetWorldMatrix() const
         GameObject *parentGameObject = owner->GetParent();
         if (parentGameObject)
         {
-            TransformComponent *parentTransform = parentGameObject->GetComponent<TransformComponent>();
+            TransformComponent *parentTransform = parentGameObject->GetTransform();
             if (parentTransform)
             {
                 parentWorldMatrix = parentTransform->GetWorldMatrix();
@@ -64,10 +65,22 @@ const glm::mat4 &spark::TransformComponent::GetWorldMatrix() const
     m_worldMatrix = parentWorldMatrix * localMatrix;
 
     m_isDirty = false;
+    ++m_worldVersion;
     return m_worldMatrix;
 }
 
 void spark::TransformComponent::SetDirtyRecursive()
+{
+    // Cached bitmaps of the ancestors drew this object where it was, even if the matrix is already dirty
+    GameObject *owner = GetParent();
+    if (owner)
+    {
+        owner->InvalidateBitmapCache();
+    }
+    MarkDirtyRecursive();
+}
+
+void spark::TransformComponent::MarkDirtyRecursive()
 {
     if (m_isDirty)
     {
@@ -79,31 +92,44 @@ void spark::TransformComponent::SetDirtyRecursive()
     GameObject *owner = GetParent();
     if (owner)
     {
+        // Bitmaps are cached in world space, so moving a parent also stales the caches below it
+        if (owner->IsCacheAsBitmap())
+        {
+            owner->InvalidateBitmapCache();
+        }
 
         const auto &children = owner->GetChildren();
         for (GameObject *childGameObject : children)
         {
             if (childGameObject)
             {
-                TransformComponent *childTransform = childGameObject->GetComponent<TransformComponent>();
+                TransformComponent *childTransform = childGameObject->GetTransform();
                 if (childTransform)
                 {
-                    childTransform->SetDirtyRecursive();
+                    childTransform->MarkDirtyRecursive();
                 }
             }
         }
     }
 }
 
-glm::mat4 spark::TransformComponent::CalculateLocalMatrix() const
+void spark::TransformComponent::UpdateWorldMatrix(const glm::mat4 &parentWorldMatrix)
 {
+    m_worldMatrix = parentWorldMatrix * CalculateLocalMatrix();
+    m_isDirty = false;
+    ++m_worldVersion;
+}
 
-    const glm::mat4 identityMat = glm::identity<glm::mat4>();
-    glm::mat4 transMat = glm::translate(identityMat, m_localPosition);
-    glm::mat4 rotMat = glm::mat4_cast(m_localRotation);
-    glm::mat4 scaleMat = glm::scale(identityMat, m_localScale);
-
-    return transMat * rotMat * scaleMat;
+glm::mat4 spark::TransformComponent::CalculateLocalMatrix() const
+{
+    // Same result as translate * rotate * scale, without the two full matrix products
+    glm::mat4 localMatrix = glm::mat4_cast(m_localRotation);
+    localMatrix[0] *= m_localScale.x;
+    localMatrix[1] *= m_localScale.y;
+    localMatrix[2] *= m_localScale.z;
+    localMatrix[3] = glm::vec4(m_localPosition, 1.0f);
+
+    return localMatrix;
 }
 
 glm::vec3 spark::TransformComponent::GetWorldScale() const
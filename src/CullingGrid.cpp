@@ -0,0 +1,137 @@
+#include "CullingGrid.h"
+#include <algorithm>
+#include <cmath>
+
+namespace spark
+{
+    namespace
+    {
+        // Keeps cell coordinates of far away or infinite bounds inside int range
+        constexpr float MaxCellCoordinate = 1.0e9f;
+
+        bool IsFinite(const SDL_FRect &bounds)
+        {
+            return std::isfinite(bounds.x) && std::isfinite(bounds.y) && std::isfinite(bounds.w) && std::isfinite(bounds.h);
+        }
+    }
+
+    CullingGrid::CullingGrid(float cellSize) : m_cellSize{cellSize > 0.0f ? cellSize : 256.0f},
+                                               m_invCellSize{1.0f / m_cellSize}
+    {
+    }
+
+    void CullingGrid::Update(std::uint32_t id, const SDL_FRect &bounds)
+    {
+        if (id >= m_entries.size())
+        {
+            m_entries.resize(id + 1);
+        }
+
+        Entry &entry = m_entries[id];
+        const CellRange range = RangeOf(bounds);
+        const bool isLarge = !IsFinite(bounds) || range.GetCellCount() > MaxCellsPerEntry;
+        if (isLarge)
+        {
+            if (entry.state == State::Large)
+            {
+                return;
+            }
+            Remove(id);
+            m_largeEntries.push_back(id);
+            entry.state = State::Large;
+            return;
+        }
+
+        // The common case for anything that moved a little or not at all
+        if (entry.state == State::InCells && entry.range == range)
+        {
+            return;
+        }
+        Remove(id);
+        AddToCells(id, range);
+        entry.range = range;
+        entry.state = State::InCells;
+    }
+
+    void CullingGrid::Remove(std::uint32_t id)
+    {
+        if (!Contains(id))
+        {
+            return;
+        }
+
+        Entry &entry = m_entries[id];
+        if (entry.state == State::Large)
+        {
+            auto it = std::find(m_largeEntries.begin(), m_largeEntries.end(), id);
+            *it = m_largeEntries.back();
+            m_largeEntries.pop_back();
+        }
+        else
+        {
+            RemoveFromCells(id, entry.range);
+        }
+        entry.state = State::Absent;
+    }
+
+    void CullingGrid::Clear()
+    {
+        m_cells.clear();
+        m_entries.clear();
+        m_largeEntries.clear();
+    }
+
+    CullingGrid::CellRange CullingGrid::RangeOf(const SDL_FRect &bounds) const noexcept
+    {
+        const auto cell = [this](float coordinate)
+        {
+            const float scaled = std::floor(coordinate * m_invCellSize);
+            return std::isnan(scaled) ? 0 : static_cast<int>(std::clamp(scaled, -MaxCellCoordinate, MaxCellCoordinate));
+        };
+        return CellRange{cell(bounds.x), cell(bounds.y), cell(bounds.x + bounds.w), cell(bounds.y + bounds.h)};
+    }
+
+    std::uint64_t CullingGrid::CellKey(int x, int y) noexcept
+    {
+        return (std::uint64_t{static_cast<std::uint32_t>(x)} << 32) | static_cast<std::uint32_t>(y);
+    }
+
+    void CullingGrid::AddToCells(std::uint32_t id, const CellRange &range)
+    {
+        for (int y = range.minY; y <= range.maxY; ++y)
+        {
+            for (int x = range.minX; x <= range.maxX; ++x)
+            {
+                m_cells[CellKey(x, y)].push_back(id);
+            }
+        }
+    }
+
+    void CullingGrid::RemoveFromCells(std::uint32_t id, const CellRange &range)
+    {
+        for (int y = range.minY; y <= range.maxY; ++y)
+        {
+            for (int x = range.minX; x <= range.maxX; ++x)
+            {
+                auto it = m_cells.find(CellKey(x, y));
+                if (it == m_cells.end())
+                {
+                    continue;
+                }
+
+                std::vector<std::uint32_t> &ids = it->second;
+                auto position = std::find(ids.begin(), ids.end(), id);
+                if (position != ids.end())
+                {
+                    *position = ids.back();
+                    ids.pop_back();
+                }
+                // Empty cells are dropped so far zoomed out queries only walk occupied ones
+                if (ids.empty())
+                {
+                    m_cells.erase(it);
+                }
+            }
+        }
+    }
+} // namespace spark
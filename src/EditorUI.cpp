@@ -1,5 +1,6 @@
 #include "EditorUI.h"
 #include "SceneManager.h"
+#include "Profiler.h"
 #include <imgui_impl_sdl3.h>
 #include <imgui_impl_sdlrenderer3.h>
 #include <iostream>
@@ -11,7 +12,7 @@
 namespace spark
 {
 
-    EditorUI::EditorUI() : m_sceneGraphPanel{std::make_unique<SceneGraphPanel>()}, m_inspectorPanel{std::make_unique<InspectorPanel>()}
+    EditorUI::EditorUI() : m_sceneGraphPanel{std::make_unique<SceneGraphPanel>()}, m_inspectorPanel{std::make_unique<InspectorPanel>()}, m_profilerPanel{std::make_unique<ProfilerPanel>()}
 
     {
     }
@@ -62,16 +63,24 @@ namespace spark
     }
     void EditorUI::Render(SceneManager &sceneManager)
     {
+        SPARK_PROFILE_SCOPE("EditorUI::Render");
         SetupDockspace();
         // RenderPlaybackControls();
 
+        Scene *scene = sceneManager.GetCurrentScene();
+        GameObject *selected = scene ? scene->Resolve(m_selectedGameObject) : nullptr;
         if (m_sceneGraphPanel)
         {
-            m_sceneGraphPanel->Render(sceneManager, m_selectedGameObject);
+            m_sceneGraphPanel->Render(sceneManager, selected);
         }
-        if (m_inspectorPanel && m_selectedGameObject)
+        if (m_inspectorPanel && selected)
         {
-            m_inspectorPanel->Render(sceneManager, m_selectedGameObject);
+            m_inspectorPanel->Render(sceneManager, selected);
+        }
+        m_selectedGameObject = selected ? selected->GetHandle() : GameObjectHandle{};
+        if (m_profilerPanel)
+        {
+            m_profilerPanel->Render();
         }
         sceneManager.ImGuiRender();
     }
@@ -0,0 +1,191 @@
+#include "FloatBuffer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace spark
+{
+    namespace
+    {
+        float WrapValue(float value, float minValue, float maxValue) noexcept
+        {
+            const float range = maxValue - minValue;
+            if (range <= 0.0f)
+            {
+                return minValue;
+            }
+            // fmod handles values that are several ranges away, not just one step outside
+            float wrapped = std::fmod(value - minValue, range);
+            wrapped += (wrapped < 0.0f) ? range : 0.0f;
+            // A tiny negative remainder plus range rounds up to range itself, which belongs to the next wrap
+            if (wrapped >= range)
+            {
+                wrapped = 0.0f;
+            }
+            // Adding minValue back can round up to maxValue as well, the result stays in [minValue, maxValue)
+            return std::min(wrapped + minValue, std::nextafter(maxValue, minValue));
+        }
+    }
+
+    FloatBuffer::FloatBuffer(std::size_t count, std::size_t stride) : m_data(count * std::max<std::size_t>(stride, 1), 0.0f),
+                                                                      m_stride{std::max<std::size_t>(stride, 1)}
+    {
+    }
+
+    float FloatBuffer::Get(std::size_t index) const noexcept
+    {
+        return index < m_data.size() ? m_data[index] : 0.0f;
+    }
+
+    void FloatBuffer::Set(std::size_t index, float value) noexcept
+    {
+        if (index < m_data.size())
+        {
+            m_data[index] = value;
+        }
+    }
+
+    float FloatBuffer::GetComponent(std::size_t element, std::size_t component) const noexcept
+    {
+        if (component >= m_stride)
+            return 0.0f;
+        return Get(element * m_stride + component);
+    }
+
+    void FloatBuffer::SetComponent(std::size_t element, std::size_t component, float value) noexcept
+    {
+        if (component >= m_stride)
+            return;
+        Set(element * m_stride + component, value);
+    }
+
+    void FloatBuffer::Resize(std::size_t count)
+    {
+        m_data.resize(count * m_stride, 0.0f);
+    }
+
+    void FloatBuffer::Reserve(std::size_t count)
+    {
+        m_data.reserve(count * m_stride);
+    }
+
+    void FloatBuffer::Push(const float *values, std::size_t valueCount)
+    {
+        const std::size_t offset = m_data.size();
+        m_data.resize(offset + m_stride, 0.0f);
+        std::copy_n(values, std::min(valueCount, m_stride), m_data.begin() + offset);
+    }
+
+    void FloatBuffer::SwapRemove(std::size_t element) noexcept
+    {
+        const std::size_t count = GetCount();
+        if (element >= count)
+            return;
+
+        const std::size_t last = count - 1;
+        if (element != last)
+        {
+            std::copy_n(m_data.begin() + last * m_stride, m_stride, m_data.begin() + element * m_stride);
+        }
+        m_data.resize(last * m_stride);
+    }
+
+    void FloatBuffer::CopyFrom(const FloatBuffer &other)
+    {
+        m_data = other.m_data;
+        m_stride = other.m_stride;
+    }
+
+    void FloatBuffer::Fill(float value) noexcept
+    {
+        std::fill(m_data.begin(), m_data.end(), value);
+    }
+
+    void FloatBuffer::Scale(float scale) noexcept
+    {
+        float *data = m_data.data();
+        const std::size_t size = m_data.size();
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            data[i] *= scale;
+        }
+    }
+
+    void FloatBuffer::AddScaled(const FloatBuffer &other, float scale) noexcept
+    {
+        float *data = m_data.data();
+        const float *source = other.m_data.data();
+        const std::size_t size = std::min(m_data.size(), other.m_data.size());
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            data[i] += source[i] * scale;
+        }
+    }
+
+    void FloatBuffer::Clamp(float minValue, float maxValue) noexcept
+    {
+        float *data = m_data.data();
+        const std::size_t size = m_data.size();
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            data[i] = std::min(std::max(data[i], minValue), maxValue);
+        }
+    }
+
+    void FloatBuffer::Wrap(float minValue, float maxValue) noexcept
+    {
+        for (float &value : m_data)
+        {
+            if (value < minValue || value >= maxValue)
+            {
+                value = WrapValue(value, minValue, maxValue);
+            }
+        }
+    }
+
+    void FloatBuffer::ClampComponent(std::size_t component, float minValue, float maxValue) noexcept
+    {
+        if (component >= m_stride)
+            return;
+
+        for (std::size_t i = component; i < m_data.size(); i += m_stride)
+        {
+            m_data[i] = std::min(std::max(m_data[i], minValue), maxValue);
+        }
+    }
+
+    void FloatBuffer::WrapComponent(std::size_t component, float minValue, float maxValue) noexcept
+    {
+        if (component >= m_stride)
+            return;
+
+        for (std::size_t i = component; i < m_data.size(); i += m_stride)
+        {
+            if (m_data[i] < minValue || m_data[i] >= maxValue)
+            {
+                m_data[i] = WrapValue(m_data[i], minValue, maxValue);
+            }
+        }
+    }
+
+    void FloatBuffer::ClampLength(float maxLength) noexcept
+    {
+        const float maxLengthSq = maxLength * maxLength;
+        for (std::size_t offset = 0; offset + m_stride <= m_data.size(); offset += m_stride)
+        {
+            float lengthSq = 0.0f;
+            for (std::size_t c = 0; c < m_stride; ++c)
+            {
+                lengthSq += m_data[offset + c] * m_data[offset + c];
+            }
+
+            if (lengthSq > maxLengthSq)
+            {
+                const float scale = maxLength / std::sqrt(lengthSq);
+                for (std::size_t c = 0; c < m_stride; ++c)
+                {
+                    m_data[offset + c] *= scale;
+                }
+            }
+        }
+    }
+} // namespace spark
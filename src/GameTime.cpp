@@ -0,0 +1,46 @@
+#include "GameTime.h"
+#include <algorithm>
+
+namespace spark
+{
+    void GameTime::SetFixedTimestepEnabled(bool enabled)
+    {
+        m_isFixedTimestepEnabled = enabled;
+        m_accumulator = 0.0;
+        m_interpolationAlpha = 1.0f;
+    }
+
+    void GameTime::SetFixedRate(float hz)
+    {
+        m_fixedDeltaTime = 1.0f / std::clamp(hz, 1.0f, 1000.0f);
+    }
+
+    int GameTime::Advance(float frameDt)
+    {
+        m_deltaTime = std::max(frameDt, 0.0f);
+        if (!m_isFixedTimestepEnabled)
+        {
+            m_variableStep = std::min(m_deltaTime, m_fixedDeltaTime * m_maxSubsteps);
+            m_fixedTime += m_variableStep;
+            m_interpolationAlpha = 1.0f;
+            return 1;
+        }
+
+        // Accumulated in double so the remainder doesn't drift over long sessions
+        m_accumulator += m_deltaTime;
+        int steps = static_cast<int>(m_accumulator / m_fixedDeltaTime);
+        if (steps > m_maxSubsteps)
+        {
+            steps = m_maxSubsteps;
+            m_accumulator = 0.0;
+        }
+        else
+        {
+            m_accumulator -= steps * static_cast<double>(m_fixedDeltaTime);
+        }
+
+        m_fixedTime += steps * static_cast<double>(m_fixedDeltaTime);
+        m_interpolationAlpha = std::clamp(static_cast<float>(m_accumulator / m_fixedDeltaTime), 0.0f, 1.0f);
+        return steps;
+    }
+} // namespace spark
@@ -0,0 +1,235 @@
+#include "JobSystem.h"
+
+namespace spark
+{
+    namespace
+    {
+        // Past this the main thread mostly waits on memory bandwidth anyway
+        constexpr std::size_t MaxWorkers = 15;
+
+        // Queue owned by the current thread, 0 for threads outside the pool
+        thread_local std::size_t t_queueIndex = 0;
+    }
+
+    JobSystem::JobSystem()
+    {
+        std::size_t workerCount = 0;
+#ifndef SPARK_JOBS_SINGLE_THREADED
+        const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+        workerCount = std::min<std::size_t>(hardwareThreads > 1 ? hardwareThreads - 1 : 0, MaxWorkers);
+#endif
+
+        m_queues.reserve(workerCount + 1);
+        for (std::size_t i = 0; i <= workerCount; ++i)
+        {
+            m_queues.push_back(std::make_unique<WorkQueue>());
+        }
+        m_workers.reserve(workerCount);
+        for (std::size_t i = 1; i <= workerCount; ++i)
+        {
+            m_workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+        }
+    }
+
+    std::size_t JobSystem::GetCurrentThreadIndex()
+    {
+        return t_queueIndex;
+    }
+
+    JobSystem::~JobSystem()
+    {
+        {
+            std::lock_guard lock{m_sleepMutex};
+            m_isRunning.store(false, std::memory_order_relaxed);
+        }
+        m_wakeCondition.notify_all();
+        for (std::thread &worker : m_workers)
+        {
+            worker.join();
+        }
+    }
+
+    void JobSystem::Schedule(std::function<void()> task, JobCounter &counter, JobCounter *dependency)
+    {
+        // Owned by the job from here on, InvokeTask frees it after running
+        auto *heapTask = new std::function<void()>(std::move(task));
+        Schedule(Job{&JobSystem::InvokeTask, heapTask, 0, 0, &counter}, dependency);
+    }
+
+    void JobSystem::Schedule(const Job &job, JobCounter *dependency)
+    {
+        if (job.counter)
+        {
+            job.counter->pending.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (dependency)
+        {
+            // Same lock Execute takes when the dependency hits zero, so the job is either parked or pushed, never lost
+            std::lock_guard lock{dependency->mutex};
+            if (dependency->pending.load(std::memory_order_acquire) > 0)
+            {
+                dependency->continuations.push_back(job);
+                return;
+            }
+        }
+        Push(job);
+    }
+
+    void JobSystem::ScheduleBackground(std::function<void()> task, JobCounter &counter)
+    {
+        counter.pending.fetch_add(1, std::memory_order_relaxed);
+        auto *heapTask = new std::function<void()>(std::move(task));
+        {
+            std::lock_guard lock{m_backgroundQueue.mutex};
+            m_backgroundQueue.jobs.push_back(Job{&JobSystem::InvokeTask, heapTask, 0, 0, &counter});
+        }
+        m_queuedJobs.fetch_add(1, std::memory_order_release);
+
+        if (!m_workers.empty())
+        {
+            {
+                std::lock_guard lock{m_sleepMutex};
+            }
+            m_wakeCondition.notify_one();
+        }
+    }
+
+    void JobSystem::Wait(JobCounter &counter)
+    {
+        while (!counter.IsDone())
+        {
+            // Its own background jobs too, or a thread waiting on a decode nobody has picked up would only spin, and
+            // without workers nobody ever would
+            if (!TryRunOne(t_queueIndex) && !TryRunBackground(&counter))
+            {
+                std::this_thread::yield();
+            }
+        }
+        // The last job may still be inside Execute's critical section, the counter can't go away before it leaves
+        std::lock_guard lock{counter.mutex};
+    }
+
+    void JobSystem::InvokeTask(void *data, std::size_t, std::size_t)
+    {
+        std::unique_ptr<std::function<void()>> task{static_cast<std::function<void()> *>(data)};
+        (*task)();
+    }
+
+    void JobSystem::Push(const Job &job)
+    {
+        WorkQueue &queue = *m_queues[t_queueIndex];
+        {
+            std::lock_guard lock{queue.mutex};
+            queue.jobs.push_back(job);
+        }
+        m_queuedJobs.fetch_add(1, std::memory_order_release);
+
+        if (!m_workers.empty())
+        {
+            // Empty critical section: a worker that just saw no work is either already waiting or will see this job
+            {
+                std::lock_guard lock{m_sleepMutex};
+            }
+            m_wakeCondition.notify_one();
+        }
+    }
+
+    bool JobSystem::TryRunOne(std::size_t queueIndex)
+    {
+        Job job{};
+        bool hasJob = false;
+        {
+            WorkQueue &own = *m_queues[queueIndex];
+            std::lock_guard lock{own.mutex};
+            if (!own.jobs.empty())
+            {
+                job = own.jobs.back();
+                own.jobs.pop_back();
+                hasJob = true;
+            }
+        }
+
+        const std::size_t queueCount = m_queues.size();
+        for (std::size_t offset = 1; !hasJob && offset < queueCount; ++offset)
+        {
+            WorkQueue &victim = *m_queues[(queueIndex + offset) % queueCount];
+            std::lock_guard lock{victim.mutex};
+            if (!victim.jobs.empty())
+            {
+                job = victim.jobs.front();
+                victim.jobs.pop_front();
+                hasJob = true;
+            }
+        }
+
+        if (!hasJob)
+        {
+            return false;
+        }
+        m_queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+        Execute(job);
+        return true;
+    }
+
+    bool JobSystem::TryRunBackground(const JobCounter *only)
+    {
+        Job job{};
+        {
+            std::lock_guard lock{m_backgroundQueue.mutex};
+            std::deque<Job> &jobs = m_backgroundQueue.jobs;
+            const auto it = only ? std::find_if(jobs.begin(), jobs.end(), [only](const Job &queued)
+                                                { return queued.counter == only; })
+                                 : jobs.begin();
+            if (it == jobs.end())
+            {
+                return false;
+            }
+            job = *it;
+            jobs.erase(it);
+        }
+        m_queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+        Execute(job);
+        return true;
+    }
+
+    void JobSystem::Execute(const Job &job)
+    {
+        job.function(job.data, job.begin, job.end);
+
+        JobCounter *counter = job.counter;
+        if (!counter)
+        {
+            return;
+        }
+
+        std::vector<Job> released;
+        {
+            std::lock_guard lock{counter->mutex};
+            if (counter->pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                released.swap(counter->continuations);
+            }
+        }
+        for (const Job &continuation : released)
+        {
+            Push(continuation);
+        }
+    }
+
+    void JobSystem::WorkerLoop(std::size_t queueIndex)
+    {
+        t_queueIndex = queueIndex;
+        while (m_isRunning.load(std::memory_order_relaxed))
+        {
+            if (TryRunOne(queueIndex) || TryRunBackground(nullptr))
+            {
+                continue;
+            }
+
+            std::unique_lock lock{m_sleepMutex};
+            m_wakeCondition.wait(lock, [this]
+                                 { return m_queuedJobs.load(std::memory_order_acquire) > 0 || !m_isRunning.load(std::memory_order_relaxed); });
+        }
+    }
+} // namespace spark
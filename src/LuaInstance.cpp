@@ -3,14 +3,329 @@
 #include <glm/glm.hpp>
 #include <Components/TransformComponent.h>
 #include <Components/ScriptComponent.h>
+#include <Components/ParticleEmitterComponent.h>
+#include <Components/ShapeComponent.h>
+#include <Components/CameraComponent.h>
 #include <Window.h>
 #include <Renderer.h>
+#include <FloatBuffer.h>
+#include <SpatialGrid.h>
+#include <NBodySolver.h>
+#include <TraceRecorder.h>
+#include <GameTime.h>
+#include <SceneManager.h>
+#include <TagRegistry.h>
+#include <TextureCache.h>
+#include <TextRenderer.h>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <limits>
+#include <vector>
 
 namespace spark
 {
+    namespace
+    {
+        // Scratch storage reused by the bulk draw bindings, so a call doesn't allocate once warmed up
+        std::vector<float> g_coordScratch;
+        std::vector<float> g_colorScratch;
+
+        // Copies the first `count` numbers of a flat Lua array with raw reads (no per-element usertypes or tables)
+        void ReadFloatArray(const sol::table &table, std::size_t count, std::vector<float> &buffer)
+        {
+            lua_State *L = table.lua_state();
+            table.push();
+            buffer.resize(count);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                lua_rawgeti(L, -1, static_cast<lua_Integer>(i + 1));
+                buffer[i] = static_cast<float>(lua_tonumber(L, -1));
+                lua_pop(L, 1);
+            }
+            lua_pop(L, 1);
+        }
+
+        // Bulk draw sources can be a FloatBuffer (read in place) or a flat Lua number table (copied to scratch)
+        std::size_t AvailableFloats(const sol::object &source)
+        {
+            if (source.is<FloatBuffer>())
+            {
+                return source.as<const FloatBuffer &>().GetFloatCount();
+            }
+            if (source.get_type() == sol::type::table)
+            {
+                return source.as<sol::table>().size();
+            }
+            return 0;
+        }
+
+        const float *ReadFloats(const sol::object &source, std::size_t count, std::vector<float> &scratch)
+        {
+            if (source.is<FloatBuffer>())
+            {
+                return source.as<const FloatBuffer &>().Data();
+            }
+            ReadFloatArray(source.as<sol::table>(), count, scratch);
+            return scratch.data();
+        }
+
+        std::vector<std::uint32_t> g_indexScratch;
+
+        // Optional rect/point arguments: nil (or anything else) becomes nullptr, which the Renderer reads as "whole"
+        const SDL_FRect *OptionalRect(const sol::object &rect)
+        {
+            return rect.is<SDL_FRect>() ? &rect.as<const SDL_FRect &>() : nullptr;
+        }
+
+        const SDL_FPoint *OptionalPoint(const sol::object &point)
+        {
+            return point.is<SDL_FPoint>() ? &point.as<const SDL_FPoint &>() : nullptr;
+        }
+
+        // Scripts give source rects in the image's own pixels, these become a rect inside its atlas page. Clamped to
+        // the image, so a sub-rect can never sample a neighbour. False while the texture is still loading.
+        bool ResolveTextureSource(const Texture &texture, const sol::object &srcrect, SDL_Texture *&sdlTexture, SDL_FRect &source)
+        {
+            const TextureRegion *region = texture.GetRegion();
+            if (!region)
+            {
+                return false;
+            }
+
+            sdlTexture = region->texture;
+            source = region->rect;
+            if (const SDL_FRect *rect = OptionalRect(srcrect))
+            {
+                const float left = std::clamp(rect->x, 0.0f, region->rect.w);
+                const float top = std::clamp(rect->y, 0.0f, region->rect.h);
+                const float right = std::clamp(rect->x + rect->w, left, region->rect.w);
+                const float bottom = std::clamp(rect->y + rect->h, top, region->rect.h);
+                source = SDL_FRect{region->rect.x + left, region->rect.y + top, right - left, bottom - top};
+            }
+            return source.w > 0.0f && source.h > 0.0f;
+        }
+
+        // What load_font hands to scripts, the fonts themselves live in the TextRenderer
+        struct LuaFont
+        {
+            TextRenderer::FontId id{TextRenderer::InvalidFontId};
+        };
+
+        TextRenderer::FontId FontOrDefault(const sol::optional<LuaFont> &font)
+        {
+            return font ? font->id : TextRenderer::GetInstance().GetDefaultFont();
+        }
+
+        // Filter behind a Lua GameObjectQuery, built once by the script and reused every frame
+        struct GameObjectQuery
+        {
+            ComponentMask components{0};
+            TagMask tags{0};
+            // Tags nothing has used yet. Queries are usually built in Init, before any object carries the tag, so
+            // these are looked up again by every Begin and moved into the mask once they exist.
+            std::vector<std::string> unresolvedTags;
+            // Set for unknown component names, which can't match anything
+            bool matchesNothing{false};
+            const std::vector<GameObject *> *candidates{nullptr};
+
+            void Begin()
+            {
+                std::erase_if(unresolvedTags, [this](const std::string &tag)
+                              {
+                                  const std::size_t tagId = TagRegistry::GetInstance().FindTagId(tag);
+                                  if (tagId == TagRegistry::InvalidTagId)
+                                  {
+                                      return false;
+                                  }
+                                  tags |= TagMask{1} << tagId;
+                                  return true; });
+
+                Scene *scene = SceneManager::GetInstance().GetCurrentScene();
+                const bool canMatch = scene && !matchesNothing && unresolvedTags.empty();
+                candidates = canMatch ? &scene->GetQueryCandidates(components, tags) : nullptr;
+            }
+
+            bool Matches(const GameObject *gameObject) const
+            {
+                return gameObject->HasComponentMask(components) && gameObject->HasTags(tags);
+            }
+        };
+
+        // Layers outside the int8 range are clamped rather than wrapped around
+        RenderSortKey SortKey(int layer, sol::optional<float> depth)
+        {
+            return RenderSortKey{static_cast<std::int8_t>(std::clamp(layer, -128, 127)), depth.value_or(0.0f)};
+        }
+
+        std::size_t ComponentTypeIdFromName(const std::string &name)
+        {
+            if (name == "TransformComponent")
+                return GetComponentTypeId<TransformComponent>();
+            if (name == "ScriptComponent")
+                return GetComponentTypeId<ScriptComponent>();
+            if (name == "ParticleEmitterComponent")
+                return GetComponentTypeId<ParticleEmitterComponent>();
+            if (name == "ShapeComponent")
+                return GetComponentTypeId<ShapeComponent>();
+            if (name == "CameraComponent")
+                return GetComponentTypeId<CameraComponent>();
+            return MaxComponentTypes;
+        }
+
+        // Generic-for step over one of the scene's index lists. The list is the loop state (light userdata), the
+        // control value is the 1-based position of the previous object, so a loop allocates nothing of its own.
+        int NextIndexedGameObject(lua_State *L)
+        {
+            const auto *list = static_cast<const std::vector<GameObject *> *>(lua_touserdata(L, 1));
+            const auto position = static_cast<std::size_t>(lua_tointeger(L, 2));
+            if (!list || position >= list->size())
+            {
+                lua_pushnil(L);
+                return 1;
+            }
+            lua_pushinteger(L, static_cast<lua_Integer>(position + 1));
+            sol::stack::push(L, (*list)[position]);
+            return 2;
+        }
+
+        // Iterated in place of a list when there's no current scene
+        const std::vector<GameObject *> g_noGameObjects;
+
+        std::tuple<lua_CFunction, sol::lightuserdata_value, lua_Integer> IterateGameObjects(const std::vector<GameObject *> &list)
+        {
+            return {&NextIndexedGameObject, sol::lightuserdata_value{const_cast<std::vector<GameObject *> *>(&list)}, 0};
+        }
+
+        // Like NextIndexedGameObject but the state is the query userdata itself, which keeps it alive for the loop.
+        // The control value is a cursor into the candidate list rather than a count of matches.
+        int NextQueryMatch(lua_State *L)
+        {
+            const GameObjectQuery &query = sol::stack::get<GameObjectQuery &>(L, 1);
+            auto position = static_cast<std::size_t>(lua_tointeger(L, 2));
+            while (query.candidates && position < query.candidates->size())
+            {
+                GameObject *gameObject = (*query.candidates)[position++];
+                if (query.Matches(gameObject))
+                {
+                    lua_pushinteger(L, static_cast<lua_Integer>(position));
+                    sol::stack::push(L, gameObject);
+                    return 2;
+                }
+            }
+            lua_pushnil(L);
+            return 1;
+        }
+
+        int EachQueryMatch(lua_State *L)
+        {
+            sol::stack::get<GameObjectQuery &>(L, 1).Begin();
+            lua_pushcfunction(L, &NextQueryMatch);
+            lua_pushvalue(L, 1);
+            lua_pushinteger(L, 0);
+            return 3;
+        }
+
+        // Spatial queries take their point set the same way the bulk draw functions do. A FloatBuffer keeps its
+        // stride (x, y are the first two components of each element), a flat table is read as x, y pairs.
+        void BuildSpatialGrid(SpatialGrid &grid, const sol::object &points, const sol::optional<int> &count)
+        {
+            std::size_t stride = 2;
+            if (points.is<FloatBuffer>())
+            {
+                stride = std::max<std::size_t>(points.as<const FloatBuffer &>().GetStride(), 2);
+            }
+
+            const std::size_t available = AvailableFloats(points) / stride;
+            const std::size_t pointCount = count ? std::min(static_cast<std::size_t>(std::max(*count, 0)), available) : available;
+            if (pointCount == 0)
+            {
+                grid.Clear();
+                return;
+            }
+            grid.Build(ReadFloats(points, pointCount * stride, g_coordScratch), pointCount, stride);
+        }
+
+        // Writes query results (0-based point indices) into a caller-owned table or FloatBuffer and returns how many
+        // there are. A table only has slots 1..n written, anything after that is left over from earlier queries.
+        std::size_t WriteIndices(const std::vector<std::uint32_t> &indices, const sol::object &out)
+        {
+            if (out.is<FloatBuffer>())
+            {
+                FloatBuffer &buffer = out.as<FloatBuffer &>();
+                buffer.Resize((indices.size() + buffer.GetStride() - 1) / buffer.GetStride());
+                for (std::size_t i = 0; i < indices.size(); ++i)
+                {
+                    buffer.Set(i, static_cast<float>(indices[i]));
+                }
+            }
+            else if (out.get_type() == sol::type::table)
+            {
+                lua_State *L = out.lua_state();
+                out.push();
+                for (std::size_t i = 0; i < indices.size(); ++i)
+                {
+                    lua_pushinteger(L, static_cast<lua_Integer>(indices[i]));
+                    lua_rawseti(L, -2, static_cast<lua_Integer>(i + 1));
+                }
+                lua_pop(L, 1);
+            }
+            return indices.size();
+        }
+
+        std::uint32_t ToExcludeIndex(const sol::optional<int> &exclude)
+        {
+            return (exclude && *exclude >= 0) ? static_cast<std::uint32_t>(*exclude) : SpatialGrid::NoIndex;
+        }
+
+        NBodyMethod ToNBodyMethod(const sol::optional<std::string> &name)
+        {
+            if (name && *name == "direct")
+                return NBodyMethod::Direct;
+            if (name && *name == "tree")
+                return NBodyMethod::BarnesHut;
+            return NBodyMethod::Auto;
+        }
+
+        using FlatListFn = bool (Renderer::*)(const float *, int, const float *);
+
+        // Shared body of render_line_list / render_fill_rect_list / render_point_list.
+        // colors (r, g, b, a per primitive) has to cover every primitive, nil draws them all in the draw color.
+        bool SubmitFlatList(Renderer &renderer, FlatListFn submit, int floatsPerPrimitive,
+                            const sol::object &coords, const sol::object &colors, const sol::optional<int> &count)
+        {
+            const int available = static_cast<int>(AvailableFloats(coords)) / floatsPerPrimitive;
+            const int primitiveCount = count ? std::clamp(*count, 0, available) : available;
+            if (primitiveCount == 0)
+            {
+                return true;
+            }
+
+            const float *coordData = ReadFloats(coords, static_cast<std::size_t>(primitiveCount * floatsPerPrimitive), g_coordScratch);
+
+            const float *colorData = nullptr;
+            if (colors.valid() && colors.get_type() != sol::type::lua_nil)
+            {
+                const std::size_t colorCount = static_cast<std::size_t>(primitiveCount) * 4;
+                const std::size_t availableColors = AvailableFloats(colors);
+                if (availableColors < colorCount)
+                {
+                    // Thrown through sol's call wrapper, which unwinds and raises it as a Lua error in the script
+                    throw sol::error("colors has " + std::to_string(availableColors) + " values, " + std::to_string(primitiveCount) +
+                                     " primitives need " + std::to_string(colorCount));
+                }
+                colorData = ReadFloats(colors, colorCount, g_colorScratch);
+            }
+            return (renderer.*submit)(coordData, primitiveCount, colorData);
+        }
+    }
+
     void LuaInstance::Init()
     {
         m_Lua.open_libraries(sol::lib::base, sol::lib::package, sol::lib::math, sol::lib::table);
+        m_profiler.Attach(m_Lua.lua_state());
         SetupBindings();
     }
     void LuaInstance::SetupBindings()
@@ -43,6 +358,96 @@ namespace spark
             sol::meta_function::to_string, [](const glm::vec3 &v)
             { return "{ x= " + std::to_string(v.x) + ", y= " + std::to_string(v.y) + ", z= " + std::to_string(v.z) + " }"; });
 
+        // Native float arrays (0-based indices), see FloatBuffer.h
+        m_Lua.new_usertype<spark::FloatBuffer>(
+            "FloatBuffer",
+            sol::call_constructor, sol::factories([](std::size_t count)
+                                                  { return spark::FloatBuffer(count, 1); }, [](std::size_t count, std::size_t stride)
+                                                  { return spark::FloatBuffer(count, stride); }),
+            "size", &spark::FloatBuffer::GetCount,
+            "stride", &spark::FloatBuffer::GetStride,
+            "float_count", &spark::FloatBuffer::GetFloatCount,
+            "get", &spark::FloatBuffer::Get,
+            "set", &spark::FloatBuffer::Set,
+            "get_component", &spark::FloatBuffer::GetComponent,
+            "set_component", &spark::FloatBuffer::SetComponent,
+            "get2", [](const spark::FloatBuffer &buffer, std::size_t element)
+            { return std::make_tuple(buffer.GetComponent(element, 0), buffer.GetComponent(element, 1)); },
+            "set2", [](spark::FloatBuffer &buffer, std::size_t element, float x, float y)
+            {
+                buffer.SetComponent(element, 0, x);
+                buffer.SetComponent(element, 1, y); },
+            "push", [](spark::FloatBuffer &buffer, sol::variadic_args args)
+            {
+                float values[16]{};
+                std::size_t count = 0;
+                for (auto value : args)
+                {
+                    if (count == std::size(values))
+                        break;
+                    values[count++] = value.as<float>();
+                }
+                buffer.Push(values, count); },
+            "resize", &spark::FloatBuffer::Resize,
+            "reserve", &spark::FloatBuffer::Reserve,
+            "clear", &spark::FloatBuffer::Clear,
+            "swap_remove", &spark::FloatBuffer::SwapRemove,
+            "copy_from", &spark::FloatBuffer::CopyFrom,
+            "fill", &spark::FloatBuffer::Fill,
+            "scale", &spark::FloatBuffer::Scale,
+            "add_scaled", &spark::FloatBuffer::AddScaled,
+            "clamp", &spark::FloatBuffer::Clamp,
+            "wrap", &spark::FloatBuffer::Wrap,
+            "clamp_component", &spark::FloatBuffer::ClampComponent,
+            "wrap_component", &spark::FloatBuffer::WrapComponent,
+            "clamp_length", &spark::FloatBuffer::ClampLength,
+            sol::meta_function::length, &spark::FloatBuffer::GetCount);
+
+        m_Lua.set_function("Vec2Array", [](std::size_t count)
+                           { return spark::FloatBuffer(count, 2); });
+
+        // Broadphase over 2D points, see SpatialGrid.h. Query results are 0-based indices into the built point set.
+        m_Lua.new_usertype<spark::SpatialGrid>(
+            "SpatialGrid",
+            sol::call_constructor, sol::factories([]()
+                                                  { return spark::SpatialGrid(); }, [](float cellSize)
+                                                  { return spark::SpatialGrid(cellSize); }),
+            "set_cell_size", &spark::SpatialGrid::SetCellSize,
+            "get_cell_size", &spark::SpatialGrid::GetCellSize,
+            "size", &spark::SpatialGrid::GetPointCount,
+            "clear", &spark::SpatialGrid::Clear,
+            "build", [](spark::SpatialGrid &grid, sol::object points, sol::optional<int> count)
+            { BuildSpatialGrid(grid, points, count); },
+            "query_radius", [](const spark::SpatialGrid &grid, float x, float y, float radius, sol::object out, sol::optional<int> exclude)
+            {
+                grid.QueryRadius(x, y, radius, g_indexScratch, ToExcludeIndex(exclude));
+                return WriteIndices(g_indexScratch, out); },
+            "query_nearest", [](const spark::SpatialGrid &grid, float x, float y, int k, sol::object out, sol::optional<int> exclude, sol::optional<float> maxRadius)
+            {
+                grid.QueryNearest(x, y, static_cast<std::size_t>(std::max(k, 0)), g_indexScratch, ToExcludeIndex(exclude),
+                                  maxRadius.value_or(std::numeric_limits<float>::max()));
+                return WriteIndices(g_indexScratch, out); });
+
+        // Gravity on native body buffers (Vec2Array positions/velocities, FloatBuffer masses), see NBodySolver.h.
+        // The optional method is "auto" (default), "direct" or "tree".
+        m_Lua.new_usertype<spark::NBodySolver>(
+            "NBodySolver",
+            sol::call_constructor, sol::constructors<spark::NBodySolver()>(),
+            "set_gravitational_constant", &spark::NBodySolver::SetGravitationalConstant,
+            "get_gravitational_constant", &spark::NBodySolver::GetGravitationalConstant,
+            "set_theta", &spark::NBodySolver::SetTheta,
+            "get_theta", &spark::NBodySolver::GetTheta,
+            "set_softening", &spark::NBodySolver::SetSoftening,
+            "get_softening", &spark::NBodySolver::GetSoftening,
+            "set_direct_threshold", [](spark::NBodySolver &solver, int count)
+            { solver.SetDirectThreshold(static_cast<std::size_t>(std::max(count, 0))); },
+            "compute", [](spark::NBodySolver &solver, const spark::FloatBuffer &positions, const spark::FloatBuffer &masses,
+                          spark::FloatBuffer &accelerations, sol::optional<std::string> method)
+            { solver.ComputeAccelerations(positions, masses, accelerations, ToNBodyMethod(method)); },
+            "step", [](spark::NBodySolver &solver, spark::FloatBuffer &positions, spark::FloatBuffer &velocities,
+                       const spark::FloatBuffer &masses, float dt, sol::optional<std::string> method)
+            { solver.Step(positions, velocities, masses, dt, ToNBodyMethod(method)); });
+
         m_Lua.new_usertype<glm::quat>(
             "quat", sol::constructors<glm::quat(), glm::quat(float, float, float, float)>(),
             "x", &glm::quat::x,
@@ -121,10 +526,25 @@ namespace spark
                                             //"get_sdl_renderer", &spark::Renderer::GetSDLRenderer,
                                             "clear", &spark::Renderer::Clear,
                                             "present", &spark::Renderer::Present,
+                                            "flush", &spark::Renderer::Flush,
+
+                                            // Batching stats of the last presented frame: draw calls, primitives
+                                            "get_frame_stats", [](spark::Renderer &renderer)
+                                            {
+                                                const spark::RenderStats &stats = renderer.GetFrameStats();
+                                                return std::make_tuple(stats.drawCalls, stats.primitivesSubmitted); },
 
                                             // Render scale functions
                                             "set_render_scale", &spark::Renderer::SetRenderScale,
                                             "get_render_scale", &spark::Renderer::GetRenderScale,
+                                            // While a camera renders the scene draws are in world space, turn the view off for HUD drawing
+                                            "set_view_enabled", &spark::Renderer::SetViewTransformEnabled,
+                                            "is_view_enabled", &spark::Renderer::IsViewTransformEnabled,
+                                            // Layers are -128 to 127, lower ones draw first. A script's draws default to layer 0, depth 0.
+                                            "set_sort_key", [](spark::Renderer &renderer, int layer, sol::optional<float> depth)
+                                            { renderer.SetSortKey(SortKey(layer, depth)); },
+                                            "set_layer_batched", [](spark::Renderer &renderer, int layer, bool batched)
+                                            { renderer.SetLayerBatched(SortKey(layer, 0.0f).layer, batched); },
 
                                             // Draw color functions
                                             "set_draw_color", &spark::Renderer::SetDrawColor,
@@ -142,15 +562,68 @@ namespace spark
                                             "render_rect", &spark::Renderer::RenderRect,
                                             "render_rects", &spark::Renderer::RenderRects,
                                             "render_fill_rect", &spark::Renderer::RenderFillRect,
-                                            "render_fill_rects", &spark::Renderer::RenderFillRects
-
-                                            // Texture rendering
-                                            // "render_texture", &spark::Renderer::RenderTexture,
-                                            // "render_texture_rotated", &spark::Renderer::RenderTextureRotated,
-                                            // "render_texture_affine", &spark::Renderer::RenderTextureAffine,
-                                            // "render_texture_tiled", &spark::Renderer::RenderTextureTiled,
-                                            // "render_texture_9grid", &spark::Renderer::RenderTexture9Grid,
-                                            // "render_texture_9grid_tiled", &spark::Renderer::RenderTexture9GridTiled,
+                                            "render_fill_rects", &spark::Renderer::RenderFillRects,
+
+                                            // Bulk rendering from flat number arrays, one call per frame instead of one per primitive:
+                                            // Every array can be a plain Lua table or a FloatBuffer (used in place, no copy).
+                                            // render_line_list(coords, [colors], [count]) where coords = { x1, y1, x2, y2, ... }
+                                            // render_fill_rect_list(rects, [colors], [count]) where rects = { x, y, w, h, ... }
+                                            // render_point_list(points, [colors], [count]) where points = { x, y, ... }
+                                            // colors = { r, g, b, a, ... } (0-1 floats) per primitive, nil uses the draw color.
+                                            // count limits how many primitives are read, so the tables can be reused between frames.
+                                            "render_line_list", [](spark::Renderer &renderer, const sol::object &coords, const sol::object &colors, sol::optional<int> count)
+                                            { return SubmitFlatList(renderer, &spark::Renderer::RenderLineList, 4, coords, colors, count); },
+                                            "render_fill_rect_list", [](spark::Renderer &renderer, const sol::object &rects, const sol::object &colors, sol::optional<int> count)
+                                            { return SubmitFlatList(renderer, &spark::Renderer::RenderFillRectList, 4, rects, colors, count); },
+                                            "render_point_list", [](spark::Renderer &renderer, const sol::object &points, const sol::object &colors, sol::optional<int> count)
+                                            { return SubmitFlatList(renderer, &spark::Renderer::RenderPointList, 2, points, colors, count); },
+
+                                            // Texture rendering, with Textures from load_texture. Source rects are in the image's pixels,
+                                            // nil source means the whole image and nil destination the whole screen. Nothing is drawn
+                                            // (and false returned) while the texture is still loading.
+                                            // render_texture(texture, src, dst)
+                                            // render_texture_rotated(texture, src, dst, angle, [center], [flip])
+                                            // render_texture_affine(texture, src, origin, right, down)
+                                            // render_texture_tiled(texture, src, scale, dst)
+                                            // render_texture_9grid(texture, src, left, right, top, bottom, scale, dst)
+                                            // render_texture_9grid_tiled(texture, src, left, right, top, bottom, scale, dst, tile_scale)
+                                            "render_texture", [](spark::Renderer &renderer, const spark::Texture &texture, const sol::object &srcrect, const sol::object &dstrect)
+                                            {
+                                                SDL_Texture *sdlTexture = nullptr;
+                                                SDL_FRect source;
+                                                return ResolveTextureSource(texture, srcrect, sdlTexture, source) &&
+                                                       renderer.RenderTexture(sdlTexture, &source, OptionalRect(dstrect)); },
+                                            "render_texture_rotated", [](spark::Renderer &renderer, const spark::Texture &texture, const sol::object &srcrect, const sol::object &dstrect, double angle, const sol::object &center, sol::optional<int> flip)
+                                            {
+                                                SDL_Texture *sdlTexture = nullptr;
+                                                SDL_FRect source;
+                                                return ResolveTextureSource(texture, srcrect, sdlTexture, source) &&
+                                                       renderer.RenderTextureRotated(sdlTexture, &source, OptionalRect(dstrect), angle, OptionalPoint(center),
+                                                                                     static_cast<SDL_FlipMode>(flip.value_or(SDL_FLIP_NONE))); },
+                                            "render_texture_affine", [](spark::Renderer &renderer, const spark::Texture &texture, const sol::object &srcrect, const sol::object &origin, const sol::object &right, const sol::object &down)
+                                            {
+                                                SDL_Texture *sdlTexture = nullptr;
+                                                SDL_FRect source;
+                                                return ResolveTextureSource(texture, srcrect, sdlTexture, source) &&
+                                                       renderer.RenderTextureAffine(sdlTexture, &source, OptionalPoint(origin), OptionalPoint(right), OptionalPoint(down)); },
+                                            "render_texture_tiled", [](spark::Renderer &renderer, const spark::Texture &texture, const sol::object &srcrect, float scale, const sol::object &dstrect)
+                                            {
+                                                SDL_Texture *sdlTexture = nullptr;
+                                                SDL_FRect source;
+                                                return ResolveTextureSource(texture, srcrect, sdlTexture, source) &&
+                                                       renderer.RenderTextureTiled(sdlTexture, &source, scale, OptionalRect(dstrect)); },
+                                            "render_texture_9grid", [](spark::Renderer &renderer, const spark::Texture &texture, const sol::object &srcrect, float leftWidth, float rightWidth, float topHeight, float bottomHeight, float scale, const sol::object &dstrect)
+                                            {
+                                                SDL_Texture *sdlTexture = nullptr;
+                                                SDL_FRect source;
+                                                return ResolveTextureSource(texture, srcrect, sdlTexture, source) &&
+                                                       renderer.RenderTexture9Grid(sdlTexture, &source, leftWidth, rightWidth, topHeight, bottomHeight, scale, OptionalRect(dstrect)); },
+                                            "render_texture_9grid_tiled", [](spark::Renderer &renderer, const spark::Texture &texture, const sol::object &srcrect, float leftWidth, float rightWidth, float topHeight, float bottomHeight, float scale, const sol::object &dstrect, float tileScale)
+                                            {
+                                                SDL_Texture *sdlTexture = nullptr;
+                                                SDL_FRect source;
+                                                return ResolveTextureSource(texture, srcrect, sdlTexture, source) &&
+                                                       renderer.RenderTexture9GridTiled(sdlTexture, &source, leftWidth, rightWidth, topHeight, bottomHeight, scale, OptionalRect(dstrect), tileScale); }
 
                                             // Geometry rendering
                                             //"render_geometry", &spark::Renderer::RenderGeometry,
@@ -160,6 +633,71 @@ namespace spark
         m_Lua.set_function("get_renderer", []() -> spark::Renderer &
                            { return spark::Renderer::GetInstance(); });
 
+        // load_texture(path, [wait]): shared with every other load of the same path. Decodes in the background
+        // unless wait is true, check is_ready() or just draw it, which does nothing until it's there.
+        m_Lua.new_usertype<spark::Texture>("Texture", sol::no_constructor,
+                                           "is_ready", &spark::Texture::IsReady,
+                                           "has_failed", &spark::Texture::HasFailed,
+                                           "width", &spark::Texture::GetWidth,
+                                           "height", &spark::Texture::GetHeight,
+                                           "wait", &spark::Texture::Wait);
+        m_Lua.set_function("load_texture", [](const std::string &path, sol::optional<bool> wait)
+                           {
+                               spark::Texture texture{path};
+                               if (wait.value_or(false))
+                               {
+                                   texture.Wait();
+                               }
+                               return texture; });
+        m_Lua["FLIP_NONE"] = static_cast<int>(SDL_FLIP_NONE);
+        m_Lua["FLIP_HORIZONTAL"] = static_cast<int>(SDL_FLIP_HORIZONTAL);
+        m_Lua["FLIP_VERTICAL"] = static_cast<int>(SDL_FLIP_VERTICAL);
+
+        // load_font(path, size): nil if it isn't a usable font. Without a font, draw_text and measure_text use the
+        // editor's font. Text is drawn in the renderer's draw color, strings drawn last frame aren't laid out again.
+        m_Lua.new_usertype<LuaFont>("Font", sol::no_constructor,
+                                    "line_height", [](const LuaFont &font)
+                                    { return spark::TextRenderer::GetInstance().GetLineHeight(font.id); });
+        m_Lua.set_function("load_font", [](const std::string &path, float size) -> sol::optional<LuaFont>
+                           {
+                               const auto id = spark::TextRenderer::GetInstance().LoadFont(path, size);
+                               if (id == spark::TextRenderer::InvalidFontId)
+                               {
+                                   return sol::nullopt;
+                               }
+                               return LuaFont{id}; });
+        m_Lua.set_function("draw_text", [](std::string_view text, float x, float y, sol::optional<LuaFont> font)
+                           { return spark::TextRenderer::GetInstance().DrawText(FontOrDefault(font), text, x, y); });
+        m_Lua.set_function("measure_text", [](std::string_view text, sol::optional<LuaFont> font)
+                           {
+                               const SDL_FPoint size = spark::TextRenderer::GetInstance().MeasureText(FontOrDefault(font), text);
+                               return std::make_tuple(size.x, size.y); });
+
+        // capture_trace([frames], [file_name]): records the next frames and saves them as Chrome trace JSON
+        m_Lua.set_function("capture_trace", [](sol::optional<int> frames, sol::optional<std::string> fileName)
+                           {
+                               const int frameCount = frames.value_or(static_cast<int>(spark::TraceRecorder::DefaultFrameCount));
+                               spark::TraceRecorder::GetInstance().StartCapture(static_cast<std::size_t>(std::max(frameCount, 1)),
+                                                                                fileName.value_or(spark::TraceRecorder::DefaultFileName)); });
+        // Fixed timestep, FixedUpdate(dt) in scripts runs at this rate
+        m_Lua.set_function("get_interpolation_alpha", []() -> float
+                           { return spark::GameTime::GetInstance().GetInterpolationAlpha(); });
+        m_Lua.set_function("get_fixed_delta_time", []() -> float
+                           { return spark::GameTime::GetInstance().GetFixedDeltaTime(); });
+        m_Lua.set_function("get_fixed_update_rate", []() -> float
+                           { return spark::GameTime::GetInstance().GetFixedRate(); });
+        m_Lua.set_function("set_fixed_update_rate", [](float hz)
+                           { spark::GameTime::GetInstance().SetFixedRate(hz); });
+        m_Lua.set_function("set_max_substeps", [](int maxSubsteps)
+                           { spark::GameTime::GetInstance().SetMaxSubsteps(maxSubsteps); });
+        m_Lua.set_function("set_fixed_timestep_enabled", [](bool enabled)
+                           { spark::GameTime::GetInstance().SetFixedTimestepEnabled(enabled); });
+        m_Lua.set_function("get_fixed_time", []() -> double
+                           { return spark::GameTime::GetInstance().GetFixedTime(); });
+
+        m_Lua.set_function("is_capturing_trace", []() -> bool
+                           { return spark::TraceRecorder::GetInstance().IsCapturing(); });
+
         m_Lua.new_usertype<spark::TransformComponent>("TransformComponent", sol::no_constructor, sol::base_classes, sol::bases<spark::Component>(),
                                                       "SetLocalPosition", &spark::TransformComponent::SetLocalPosition,
                                                       "GetLocalPosition", &spark::TransformComponent::GetLocalPosition,
@@ -174,9 +712,189 @@ namespace spark
 
         m_Lua.new_usertype<spark::ScriptComponent>("ScriptComponent", sol::no_constructor, sol::base_classes, sol::bases<spark::Component>(),
                                                    "ReloadScript", &spark::ScriptComponent::ReloadScript);
+
+        // Settings are exposed as setters so scripts can tune an emitter without copying the whole settings struct
+        m_Lua.new_usertype<spark::ParticleEmitterComponent>("ParticleEmitterComponent", sol::no_constructor, sol::base_classes, sol::bases<spark::Component>(),
+                                                            "burst", [](spark::ParticleEmitterComponent &emitter, int count)
+                                                            { emitter.Burst(static_cast<std::size_t>(std::max(count, 0))); },
+                                                            "clear", &spark::ParticleEmitterComponent::Clear,
+                                                            "set_emitting", &spark::ParticleEmitterComponent::SetEmitting,
+                                                            "is_emitting", &spark::ParticleEmitterComponent::IsEmitting,
+                                                            "get_particle_count", &spark::ParticleEmitterComponent::GetParticleCount,
+                                                            "set_max_particles", [](spark::ParticleEmitterComponent &emitter, int maxParticles)
+                                                            { emitter.SetMaxParticles(static_cast<std::size_t>(std::max(maxParticles, 0))); },
+                                                            "set_emission_rate", [](spark::ParticleEmitterComponent &emitter, float rate)
+                                                            { emitter.GetSettings().emissionRate = rate; },
+                                                            "set_lifetime", [](spark::ParticleEmitterComponent &emitter, float minLifetime, float maxLifetime)
+                                                            { emitter.GetSettings().lifetimeMin = minLifetime; emitter.GetSettings().lifetimeMax = maxLifetime; },
+                                                            "set_speed", [](spark::ParticleEmitterComponent &emitter, float minSpeed, float maxSpeed)
+                                                            { emitter.GetSettings().speedMin = minSpeed; emitter.GetSettings().speedMax = maxSpeed; },
+                                                            "set_direction", [](spark::ParticleEmitterComponent &emitter, float degrees, float spread)
+                                                            { emitter.GetSettings().direction = degrees; emitter.GetSettings().spread = spread; },
+                                                            "set_gravity", [](spark::ParticleEmitterComponent &emitter, float x, float y)
+                                                            { emitter.GetSettings().gravity = {x, y}; },
+                                                            "set_wind", [](spark::ParticleEmitterComponent &emitter, float x, float y)
+                                                            { emitter.GetSettings().wind = {x, y}; },
+                                                            "set_drag", [](spark::ParticleEmitterComponent &emitter, float drag)
+                                                            { emitter.GetSettings().drag = drag; },
+                                                            "set_size", [](spark::ParticleEmitterComponent &emitter, float sizeStart, float sizeEnd)
+                                                            { emitter.GetSettings().sizeStart = sizeStart; emitter.GetSettings().sizeEnd = sizeEnd; },
+                                                            "set_color_start", [](spark::ParticleEmitterComponent &emitter, float r, float g, float b, float a)
+                                                            { emitter.GetSettings().colorStart = {r, g, b, a}; },
+                                                            "set_color_end", [](spark::ParticleEmitterComponent &emitter, float r, float g, float b, float a)
+                                                            { emitter.GetSettings().colorEnd = {r, g, b, a}; },
+                                                            "set_offset", [](spark::ParticleEmitterComponent &emitter, float x, float y)
+                                                            { emitter.GetSettings().offset = {x, y}; },
+                                                            "set_sort_key", [](spark::ParticleEmitterComponent &emitter, int layer, sol::optional<float> depth)
+                                                            { emitter.SetSortKey(SortKey(layer, depth)); });
+
+        // Build the shape once (in Init, or whenever it should change) instead of redrawing it every frame. Colors are
+        // 0-1 floats, alpha defaults to 1. polygon takes a flat {x1, y1, x2, y2, ...} table or a FloatBuffer.
+        m_Lua.new_usertype<spark::ShapeComponent>("ShapeComponent", sol::no_constructor, sol::base_classes, sol::bases<spark::Component>(),
+                                                  "clear", &spark::ShapeComponent::Clear,
+                                                  "set_fill", [](spark::ShapeComponent &shape, float r, float g, float b, sol::optional<float> a)
+                                                  { shape.SetFill({r, g, b, a.value_or(1.0f)}); },
+                                                  "set_no_fill", &spark::ShapeComponent::SetNoFill,
+                                                  "set_line_style", [](spark::ShapeComponent &shape, float width, float r, float g, float b, sol::optional<float> a)
+                                                  { shape.SetLineStyle(width, {r, g, b, a.value_or(1.0f)}); },
+                                                  "move_to", &spark::ShapeComponent::MoveTo,
+                                                  "line_to", &spark::ShapeComponent::LineTo,
+                                                  "arc", &spark::ShapeComponent::Arc,
+                                                  "close_path", &spark::ShapeComponent::ClosePath,
+                                                  "rect", &spark::ShapeComponent::AddRect,
+                                                  "circle", &spark::ShapeComponent::AddCircle,
+                                                  "ellipse", &spark::ShapeComponent::AddEllipse,
+                                                  "polygon", [](spark::ShapeComponent &shape, const sol::object &points)
+                                                  {
+                                                      const std::size_t count = AvailableFloats(points) / 2;
+                                                      shape.AddPolygon(ReadFloats(points, count * 2, g_coordScratch), count); },
+                                                  "get_path_count", &spark::ShapeComponent::GetPathCount,
+                                                  "get_triangle_count", &spark::ShapeComponent::GetTriangleCount,
+                                                  "set_sort_key", [](spark::ShapeComponent &shape, int layer, sol::optional<float> depth)
+                                                  { shape.SetSortKey(SortKey(layer, depth)); });
+
+        // The camera shows its object's position at the centre of its viewport. Screen coordinates are window
+        // pixels, e.g. the mouse position. get_visible_bounds returns x, y, w, h of the world area in view.
+        m_Lua.new_usertype<spark::CameraComponent>("CameraComponent", sol::no_constructor, sol::base_classes, sol::bases<spark::Component>(),
+                                                   "set_zoom", &spark::CameraComponent::SetZoom,
+                                                   "get_zoom", &spark::CameraComponent::GetZoom,
+                                                   "set_rotation", &spark::CameraComponent::SetRotation,
+                                                   "get_rotation", &spark::CameraComponent::GetRotation,
+                                                   "set_viewport", [](spark::CameraComponent &camera, float x, float y, float w, float h)
+                                                   { camera.SetViewport({x, y, w, h}); },
+                                                   "reset_viewport", [](spark::CameraComponent &camera)
+                                                   { camera.SetViewport({0.0f, 0.0f, 0.0f, 0.0f}); },
+                                                   "screen_to_world", [](const spark::CameraComponent &camera, float x, float y)
+                                                   {
+                                                       const glm::vec2 world = camera.ScreenToWorld({x, y});
+                                                       return std::make_tuple(world.x, world.y); },
+                                                   "world_to_screen", [](const spark::CameraComponent &camera, float x, float y)
+                                                   {
+                                                       const glm::vec2 screen = camera.WorldToScreen({x, y});
+                                                       return std::make_tuple(screen.x, screen.y); },
+                                                   "get_visible_bounds", [](const spark::CameraComponent &camera)
+                                                   {
+                                                       const SDL_FRect bounds = camera.GetVisibleWorldBounds();
+                                                       return std::make_tuple(bounds.x, bounds.y, bounds.w, bounds.h); },
+                                                   "set_culling_enabled", &spark::CameraComponent::SetCullingEnabled,
+                                                   "is_culling_enabled", &spark::CameraComponent::IsCullingEnabled,
+                                                   "make_current", &spark::CameraComponent::MakeCurrent);
+
+        // Handles are the safe way for a script to hold on to another object across frames: they resolve to nil once
+        // the object has been deleted, where a stored GameObject would dangle. They resolve against the current scene,
+        // so a handle kept across a scene switch is nil too rather than naming an unrelated object.
+        m_Lua.new_usertype<spark::GameObjectHandle>("GameObjectHandle", sol::no_constructor,
+                                                    "index", sol::readonly(&spark::GameObjectHandle::index),
+                                                    "generation", sol::readonly(&spark::GameObjectHandle::generation),
+                                                    "valid", [](const spark::GameObjectHandle &handle) -> bool
+                                                    {
+                                                        Scene *scene = SceneManager::GetInstance().GetCurrentScene();
+                                                        return scene && scene->Resolve(handle) != nullptr; },
+                                                    "get", [](const spark::GameObjectHandle &handle) -> spark::GameObject *
+                                                    {
+                                                        Scene *scene = SceneManager::GetInstance().GetCurrentScene();
+                                                        return scene ? scene->Resolve(handle) : nullptr; },
+                                                    sol::meta_function::equal_to, [](const spark::GameObjectHandle &a, const spark::GameObjectHandle &b) -> bool
+                                                    { return a == b; });
+
+        m_Lua.set_function("get_game_object", [](const spark::GameObjectHandle &handle) -> spark::GameObject *
+                           {
+                               Scene *scene = SceneManager::GetInstance().GetCurrentScene();
+                               return scene ? scene->Resolve(handle) : nullptr; });
+
+        // Scene queries, on the current scene. The iterators are used as `for _, go in game_objects_with_tag("enemy") do`.
+        m_Lua.set_function("find_game_object", [](const std::string &name) -> spark::GameObject *
+                           {
+                               Scene *scene = SceneManager::GetInstance().GetCurrentScene();
+                               return scene ? scene->FindGameObject(name) : nullptr; });
+        m_Lua.set_function("find_game_objects", [](const std::string &name)
+                           {
+                               Scene *scene = SceneManager::GetInstance().GetCurrentScene();
+                               return IterateGameObjects(scene ? scene->FindGameObjects(name) : g_noGameObjects); });
+        m_Lua.set_function("game_objects_with_tag", [](const std::string &tag)
+                           {
+                               Scene *scene = SceneManager::GetInstance().GetCurrentScene();
+                               return IterateGameObjects(scene ? scene->GetGameObjectsWithTag(tag) : g_noGameObjects); });
+
+        // Component and tag filter, e.g. GameObjectQuery():with("ParticleEmitterComponent"):tagged("enemy").
+        // Build it once and keep it, then loop with query:each() or use first() and count().
+        m_Lua.new_usertype<GameObjectQuery>("GameObjectQuery", sol::constructors<GameObjectQuery()>(),
+                                            "with", [](sol::object self, const std::string &componentName) -> sol::object
+                                            {
+                                                GameObjectQuery &query = self.as<GameObjectQuery &>();
+                                                const std::size_t typeId = ComponentTypeIdFromName(componentName);
+                                                if (typeId >= MaxComponentTypes)
+                                                {
+                                                    std::cerr << "GameObjectQuery: unknown component \"" << componentName << "\"\n";
+                                                    query.matchesNothing = true;
+                                                }
+                                                else
+                                                {
+                                                    query.components |= ComponentMask{1} << typeId;
+                                                }
+                                                return self; },
+                                            "tagged", [](sol::object self, const std::string &tag) -> sol::object
+                                            {
+                                                GameObjectQuery &query = self.as<GameObjectQuery &>();
+                                                const std::size_t tagId = TagRegistry::GetInstance().FindTagId(tag);
+                                                if (tagId == TagRegistry::InvalidTagId)
+                                                {
+                                                    // Not registering it here, a typo would use up one of the MaxTags ids
+                                                    query.unresolvedTags.push_back(tag);
+                                                }
+                                                else
+                                                {
+                                                    query.tags |= TagMask{1} << tagId;
+                                                }
+                                                return self; },
+                                            "each", &EachQueryMatch,
+                                            "first", [](GameObjectQuery &query) -> spark::GameObject *
+                                            {
+                                                query.Begin();
+                                                if (!query.candidates)
+                                                    return nullptr;
+                                                auto it = std::find_if(query.candidates->begin(), query.candidates->end(), [&](const GameObject *go)
+                                                                       { return query.Matches(go); });
+                                                return it != query.candidates->end() ? *it : nullptr; },
+                                            "count", [](GameObjectQuery &query) -> std::size_t
+                                            {
+                                                query.Begin();
+                                                if (!query.candidates)
+                                                    return 0;
+                                                return static_cast<std::size_t>(std::count_if(query.candidates->begin(), query.candidates->end(), [&](const GameObject *go)
+                                                                                               { return query.Matches(go); })); });
+
         m_Lua.new_usertype<spark::GameObject>("GameObject", sol::no_constructor, "GetName", &spark::GameObject::GetName, "GetParent", &spark::GameObject::GetParent,
+                                              // Newer bindings are snake_case like the rest of the Lua API, the PascalCase ones above
+                                              // and below are kept for existing scripts
+                                              "get_handle", &spark::GameObject::GetHandle,
+                                              "set_name", [](spark::GameObject &go, const std::string &name)
+                                              { go.SetName(name); },
+                                              "add_tag", &spark::GameObject::AddTag, "remove_tag", &spark::GameObject::RemoveTag, "has_tag", &spark::GameObject::HasTag,
                                               // sol2 typically handles default arguments well for member functions.
                                               "SetParent", &spark::GameObject::SetParent,
+                                              "set_cache_as_bitmap", &spark::GameObject::SetCacheAsBitmap, "is_cache_as_bitmap", &spark::GameObject::IsCacheAsBitmap,
+                                              "invalidate_bitmap_cache", &spark::GameObject::InvalidateBitmapCache,
 
                                               // Children access:
                                               // Lua typically uses 1-based indexing. These bindings expose 0-based (C++) access.
@@ -210,7 +928,10 @@ namespace spark
                                               // These use lambdas to call the templated GetComponent<T>() method.
                                               "GetTransformComponent", [](spark::GameObject &go)
                                               { return go.GetComponent<spark::TransformComponent>(); }, "GetScriptComponent", [](spark::GameObject &go)
-                                              { return go.GetComponent<spark::ScriptComponent>(); },
+                                              { return go.GetComponent<spark::ScriptComponent>(); }, "get_particle_emitter_component", [](spark::GameObject &go)
+                                              { return go.GetComponent<spark::ParticleEmitterComponent>(); }, "get_shape_component", [](spark::GameObject &go)
+                                              { return go.GetComponent<spark::ShapeComponent>(); }, "get_camera_component", [](spark::GameObject &go)
+                                              { return go.GetComponent<spark::CameraComponent>(); },
                                               // Example for another component type (if you have, e.g., RenderComponent):
                                               // "GetRenderComponent", [](spark::GameObject& go) {
                                               //     return go.GetComponent<spark::RenderComponent>();
@@ -228,7 +949,10 @@ namespace spark
                 // The GameObject::AddComponent template takes (Args&&... args)
                 // The ScriptComponent constructor is (GameObject* parent, const std::string& scriptPath)
                 // The 'this' (parent GameObject*) is implicitly handled by AddComponent.
-                return go.AddComponent<spark::ScriptComponent>(scriptPath); }
+                return go.AddComponent<spark::ScriptComponent>(scriptPath); }, "add_particle_emitter_component", [](spark::GameObject &go)
+                                              { return go.AddComponent<spark::ParticleEmitterComponent>(); }, "add_shape_component", [](spark::GameObject &go)
+                                              { return go.AddComponent<spark::ShapeComponent>(); }, "add_camera_component", [](spark::GameObject &go)
+                                              { return go.AddComponent<spark::CameraComponent>(); }
                                               // Example for another component type with arguments:
                                               // "AddLightComponent", [](spark::GameObject& go, float intensity, const glm::vec3& color) {
                                               //    return go.AddComponent<spark::LightComponent>(intensity, color);
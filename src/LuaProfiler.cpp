@@ -0,0 +1,257 @@
+#include "LuaProfiler.h"
+#include "LuaInstance.h"
+#include "Profiler.h"
+#include <lua.hpp>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+namespace spark
+{
+    namespace
+    {
+        // Deeper frames are cut off, the outermost ones are kept
+        constexpr int MaxSampledDepth = 64;
+
+        void AppendFunctionName(std::string &out, const lua_Debug &ar)
+        {
+            if (ar.name)
+            {
+                out += ar.name;
+            }
+            else if (ar.what && ar.what[0] == 'm') // "main"
+            {
+                out += "main chunk";
+            }
+            else if (ar.what && ar.what[0] == 'C')
+            {
+                out += "[C]";
+            }
+            else
+            {
+                out += "function@";
+                out += std::to_string(ar.linedefined);
+            }
+        }
+
+        void AppendLocation(std::string &out, const lua_Debug &ar)
+        {
+            out += ar.short_src;
+            out += ':';
+            out += std::to_string(ar.currentline);
+        }
+    }
+
+    void LuaProfiler::SetScriptEnabled(const std::string &scriptPath, bool enabled)
+    {
+        ScriptProfile &profile = m_scripts[scriptPath];
+        if (profile.isEnabled == enabled)
+        {
+            return;
+        }
+
+        profile.isEnabled = enabled;
+        m_enabledScripts += enabled ? 1 : -1;
+        if (!enabled && m_currentScript == &profile)
+        {
+            m_currentScript = nullptr;
+        }
+        UpdateHook();
+    }
+
+    bool LuaProfiler::IsScriptEnabled(const std::string &scriptPath) const
+    {
+        auto it = m_scripts.find(scriptPath);
+        return it != m_scripts.end() && it->second.isEnabled;
+    }
+
+    void LuaProfiler::SetSampleInterval(int instructions)
+    {
+        m_sampleInterval = std::max(instructions, 1);
+        UpdateHook();
+    }
+
+    void LuaProfiler::UpdateHook()
+    {
+        if (!m_state)
+        {
+            return;
+        }
+
+        if (IsActive())
+        {
+            lua_sethook(m_state, &LuaProfiler::Hook, LUA_MASKCOUNT, m_sampleInterval);
+        }
+        else
+        {
+            lua_sethook(m_state, nullptr, 0, 0);
+        }
+    }
+
+    void LuaProfiler::EnterScript(const std::string &scriptPath)
+    {
+        m_enclosingScripts.push_back(m_currentScript);
+        auto it = m_scripts.find(scriptPath);
+        if (it == m_scripts.end() || !it->second.isEnabled)
+        {
+            m_currentScript = nullptr;
+            return;
+        }
+        m_currentScript = &it->second;
+        m_lastSampleNs = Profiler::NowNs();
+    }
+
+    void LuaProfiler::LeaveScript()
+    {
+        if (m_enclosingScripts.empty())
+        {
+            m_currentScript = nullptr;
+            return;
+        }
+
+        // Back to the script that made the call, unless it was disabled in the meantime. Time after the inner
+        // script's last sample isn't attributed, the stack it belonged to is gone.
+        ScriptProfile *enclosing = m_enclosingScripts.back();
+        m_enclosingScripts.pop_back();
+        m_currentScript = enclosing && enclosing->isEnabled ? enclosing : nullptr;
+        m_lastSampleNs = Profiler::NowNs();
+    }
+
+    void LuaProfiler::Hook(lua_State *L, lua_Debug *ar)
+    {
+        if (ar->event == LUA_HOOKCOUNT)
+        {
+            LuaInstance::GetInstance().GetProfiler().Sample(L);
+        }
+    }
+
+    void LuaProfiler::Sample(lua_State *L)
+    {
+        if (!m_currentScript)
+        {
+            return;
+        }
+
+        const std::uint64_t now = Profiler::NowNs();
+        const std::uint64_t elapsed = now - m_lastSampleNs;
+        m_lastSampleNs = now;
+
+        lua_Debug frames[MaxSampledDepth];
+        int depth = 0;
+        while (depth < MaxSampledDepth && lua_getstack(L, depth, &frames[depth]))
+        {
+            lua_getinfo(L, "Sln", &frames[depth]);
+            ++depth;
+        }
+        if (depth == 0)
+        {
+            return;
+        }
+
+        // Outermost frame first, as the collapsed format expects
+        std::string &stack = m_stackScratch;
+        stack.clear();
+        for (int level = depth - 1; level >= 0; --level)
+        {
+            if (!stack.empty())
+            {
+                stack += ';';
+            }
+            AppendFunctionName(stack, frames[level]);
+            stack += " (";
+            AppendLocation(stack, frames[level]);
+            stack += ')';
+        }
+
+        ScriptProfile &profile = *m_currentScript;
+        profile.totalNs += elapsed;
+        ++profile.samples;
+        profile.stacks[stack] += elapsed;
+
+        // Flat view: the innermost frame is where the time was spent
+        std::string &location = m_locationScratch;
+        location.clear();
+        AppendLocation(location, frames[0]);
+        LineStats &line = profile.lines[location];
+        if (line.function.empty())
+        {
+            AppendFunctionName(line.function, frames[0]);
+            line.location = location;
+        }
+        line.selfNs += elapsed;
+        ++line.samples;
+    }
+
+    std::uint64_t LuaProfiler::GetTotalNs(const std::string &scriptPath) const
+    {
+        auto it = m_scripts.find(scriptPath);
+        return it != m_scripts.end() ? it->second.totalNs : 0;
+    }
+
+    std::uint32_t LuaProfiler::GetSampleCount(const std::string &scriptPath) const
+    {
+        auto it = m_scripts.find(scriptPath);
+        return it != m_scripts.end() ? it->second.samples : 0;
+    }
+
+    std::vector<LuaProfiler::LineStats> LuaProfiler::GetTopLines(const std::string &scriptPath, std::size_t maxLines) const
+    {
+        std::vector<LineStats> lines;
+        auto it = m_scripts.find(scriptPath);
+        if (it == m_scripts.end())
+        {
+            return lines;
+        }
+
+        lines.reserve(it->second.lines.size());
+        for (const auto &[location, stats] : it->second.lines)
+        {
+            lines.push_back(stats);
+        }
+        const std::size_t count = std::min(maxLines, lines.size());
+        std::partial_sort(lines.begin(), lines.begin() + count, lines.end(), [](const LineStats &a, const LineStats &b)
+                          { return a.selfNs > b.selfNs; });
+        lines.resize(count);
+        return lines;
+    }
+
+    void LuaProfiler::Reset(const std::string &scriptPath)
+    {
+        auto it = m_scripts.find(scriptPath);
+        if (it == m_scripts.end())
+        {
+            return;
+        }
+        ScriptProfile &profile = it->second;
+        profile.totalNs = 0;
+        profile.samples = 0;
+        profile.stacks.clear();
+        profile.lines.clear();
+    }
+
+    void LuaProfiler::ExportCollapsed(const std::string &scriptPath, std::ostream &out) const
+    {
+        auto it = m_scripts.find(scriptPath);
+        if (it == m_scripts.end())
+        {
+            return;
+        }
+        for (const auto &[stack, ns] : it->second.stacks)
+        {
+            // Weights are microseconds, the usual unit for time-weighted collapsed stacks
+            out << scriptPath << ';' << stack << ' ' << std::max<std::uint64_t>(ns / 1000, 1) << '\n';
+        }
+    }
+
+    bool LuaProfiler::WriteCollapsedFile(const std::string &scriptPath, const std::string &filePath) const
+    {
+        std::ofstream file(filePath);
+        if (!file.is_open())
+        {
+            std::cerr << "LuaProfiler: failed to open " << filePath << " for writing\n";
+            return false;
+        }
+        ExportCollapsed(scriptPath, file);
+        return !file.fail();
+    }
+} // namespace spark
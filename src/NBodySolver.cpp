@@ -0,0 +1,350 @@
+#include "NBodySolver.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace spark
+{
+    namespace
+    {
+        constexpr std::int32_t LeafCapacity = 8;
+        // Deep enough for any float layout, stops coincident bodies from splitting forever
+        constexpr int MaxTreeDepth = 24;
+        // Without softening a body's own (zero) offset would divide 0 by 0
+        constexpr float MinSofteningSq = 1e-12f;
+        // Bodies per job. Each body costs O(n) direct or O(log n) tree interactions, so small chunks already pay off.
+        constexpr std::size_t DirectGrainSize = 64;
+        constexpr std::size_t TreeGrainSize = 256;
+    }
+
+    void NBodySolver::ComputeAccelerations(const float *positions, std::size_t positionStride, const float *masses, std::size_t count,
+                                           float *accelerations, NBodyMethod method)
+    {
+        if (!positions || !masses || !accelerations || count == 0 || positionStride < 2)
+        {
+            return;
+        }
+
+        LoadBodies(positions, positionStride, masses, count);
+
+        const bool useTree = method == NBodyMethod::BarnesHut || (method == NBodyMethod::Auto && count > m_directThreshold);
+        JobSystem &jobSystem = JobSystem::GetInstance();
+        if (!useTree)
+        {
+            jobSystem.ParallelFor(0, count, DirectGrainSize, [this, accelerations](std::size_t begin, std::size_t end)
+                                  { ComputeDirectRange(begin, end, accelerations); });
+            return;
+        }
+
+        BuildTree();
+        // Non-finite bodies aren't in the tree order, give them no acceleration rather than leaving garbage
+        std::fill(accelerations, accelerations + count * 2, 0.0f);
+        // The tree is read-only from here, and every body writes only its own two floats
+        jobSystem.ParallelFor(0, m_treeOrder.size(), TreeGrainSize, [this, accelerations](std::size_t begin, std::size_t end)
+                              { ComputeTreeRange(begin, end, accelerations); });
+    }
+
+    void NBodySolver::ComputeAccelerations(const FloatBuffer &positions, const FloatBuffer &masses, FloatBuffer &accelerations,
+                                           NBodyMethod method)
+    {
+        const std::size_t count = std::min(positions.GetStride() >= 2 ? positions.GetCount() : 0, masses.GetFloatCount());
+        if (accelerations.GetStride() != 2)
+        {
+            accelerations = FloatBuffer(count, 2);
+        }
+        accelerations.Resize(count);
+        ComputeAccelerations(positions.Data(), positions.GetStride(), masses.Data(), count, accelerations.Data(), method);
+    }
+
+    void NBodySolver::Step(FloatBuffer &positions, FloatBuffer &velocities, const FloatBuffer &masses, float dt, NBodyMethod method)
+    {
+        if (positions.GetStride() < 2 || velocities.GetStride() < 2)
+        {
+            return;
+        }
+
+        const std::size_t count = std::min({positions.GetCount(), velocities.GetCount(), masses.GetFloatCount()});
+        m_accelerationScratch.resize(count * 2);
+        ComputeAccelerations(positions.Data(), positions.GetStride(), masses.Data(), count, m_accelerationScratch.data(), method);
+
+        float *position = positions.Data();
+        float *velocity = velocities.Data();
+        const std::size_t positionStride = positions.GetStride();
+        const std::size_t velocityStride = velocities.GetStride();
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            float *v = velocity + i * velocityStride;
+            float *p = position + i * positionStride;
+            v[0] += m_accelerationScratch[i * 2] * dt;
+            v[1] += m_accelerationScratch[i * 2 + 1] * dt;
+            p[0] += v[0] * dt;
+            p[1] += v[1] * dt;
+        }
+    }
+
+    void NBodySolver::LoadBodies(const float *positions, std::size_t positionStride, const float *masses, std::size_t count)
+    {
+        m_x.resize(count);
+        m_y.resize(count);
+        m_mass.resize(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            m_x[i] = positions[i * positionStride];
+            m_y[i] = positions[i * positionStride + 1];
+            m_mass[i] = masses[i];
+        }
+    }
+
+    void NBodySolver::ComputeDirectRange(std::size_t begin, std::size_t end, float *accelerations) const
+    {
+        const std::size_t count = m_x.size();
+        const float *x = m_x.data();
+        const float *y = m_y.data();
+        const float *mass = m_mass.data();
+        const float softeningSq = std::max(m_softening * m_softening, MinSofteningSq);
+
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            const float xi = x[i];
+            const float yi = y[i];
+            float ax = 0.0f;
+            float ay = 0.0f;
+            // Branch-free: the j == i term has a zero offset and contributes nothing
+            for (std::size_t j = 0; j < count; ++j)
+            {
+                const float dx = x[j] - xi;
+                const float dy = y[j] - yi;
+                const float distanceSq = dx * dx + dy * dy + softeningSq;
+                const float invDistance = 1.0f / std::sqrt(distanceSq);
+                const float scale = mass[j] * invDistance * invDistance * invDistance;
+                ax += dx * scale;
+                ay += dy * scale;
+            }
+            accelerations[i * 2] = ax * m_gravitationalConstant;
+            accelerations[i * 2 + 1] = ay * m_gravitationalConstant;
+        }
+    }
+
+    void NBodySolver::BuildTree()
+    {
+        const std::size_t count = m_x.size();
+        m_nodes.clear();
+        m_nextBody.assign(count, -1);
+
+        float minX = std::numeric_limits<float>::max();
+        float minY = std::numeric_limits<float>::max();
+        float maxX = std::numeric_limits<float>::lowest();
+        float maxY = std::numeric_limits<float>::lowest();
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (!std::isfinite(m_x[i]) || !std::isfinite(m_y[i]))
+                continue;
+            minX = std::min(minX, m_x[i]);
+            maxX = std::max(maxX, m_x[i]);
+            minY = std::min(minY, m_y[i]);
+            maxY = std::max(maxY, m_y[i]);
+        }
+        if (minX > maxX)
+        {
+            minX = maxX = minY = maxY = 0.0f;
+        }
+
+        // The root is a square around every finite body, padded so bodies on the max edge still fall inside
+        const float halfSize = std::max(maxX - minX, maxY - minY) * 0.5f * 1.001f + 1e-3f;
+        m_nodes.reserve(count / 2 + 1);
+        m_nodes.push_back(Node{(minX + maxX) * 0.5f, (minY + maxY) * 0.5f, halfSize, 0.0f, 0.0f, 0.0f, -1, -1, 0});
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            // Non-finite bodies are left out of the tree, they feel forces but exert none
+            if (std::isfinite(m_x[i]) && std::isfinite(m_y[i]))
+            {
+                InsertBody(static_cast<std::int32_t>(i), 0, 0);
+            }
+        }
+
+        for (Node &node : m_nodes)
+        {
+            if (node.mass != 0.0f)
+            {
+                node.massX /= node.mass;
+                node.massY /= node.mass;
+            }
+            else
+            {
+                node.massX = node.centerX;
+                node.massY = node.centerY;
+            }
+        }
+
+        // Lay the bodies out leaf by leaf in depth-first order, so each leaf is one contiguous run and bodies
+        // walked one after another share most of their traversal. Leaves then store an offset instead of a list.
+        m_treeOrder.clear();
+        m_treeX.clear();
+        m_treeY.clear();
+        m_treeMass.clear();
+        std::vector<std::int32_t> stack{0};
+        while (!stack.empty())
+        {
+            Node &node = m_nodes[stack.back()];
+            stack.pop_back();
+            if (node.firstChild >= 0)
+            {
+                for (std::int32_t child = 3; child >= 0; --child)
+                {
+                    stack.push_back(node.firstChild + child);
+                }
+                continue;
+            }
+
+            const std::int32_t start = static_cast<std::int32_t>(m_treeOrder.size());
+            for (std::int32_t body = node.firstBody; body >= 0; body = m_nextBody[body])
+            {
+                m_treeOrder.push_back(body);
+                m_treeX.push_back(m_x[body]);
+                m_treeY.push_back(m_y[body]);
+                m_treeMass.push_back(m_mass[body]);
+            }
+            node.firstBody = start;
+        }
+    }
+
+    std::int32_t NBodySolver::ChildFor(const Node &node, float x, float y) const
+    {
+        const std::int32_t quadrant = (x >= node.centerX ? 1 : 0) | (y >= node.centerY ? 2 : 0);
+        return node.firstChild + quadrant;
+    }
+
+    void NBodySolver::InsertBody(std::int32_t body, std::int32_t node, int depth)
+    {
+        const float x = m_x[body];
+        const float y = m_y[body];
+        const float mass = m_mass[body];
+
+        while (true)
+        {
+            Node &current = m_nodes[node];
+            current.massX += x * mass;
+            current.massY += y * mass;
+            current.mass += mass;
+
+            if (current.firstChild >= 0)
+            {
+                node = ChildFor(current, x, y);
+                ++depth;
+                continue;
+            }
+
+            m_nextBody[body] = current.firstBody;
+            current.firstBody = body;
+            ++current.bodyCount;
+            if (current.bodyCount > LeafCapacity && depth < MaxTreeDepth)
+            {
+                SplitLeaf(node, depth);
+            }
+            return;
+        }
+    }
+
+    void NBodySolver::SplitLeaf(std::int32_t node, int depth)
+    {
+        const std::int32_t firstChild = static_cast<std::int32_t>(m_nodes.size());
+        const float quarter = m_nodes[node].halfSize * 0.5f;
+        const float centerX = m_nodes[node].centerX;
+        const float centerY = m_nodes[node].centerY;
+        // Quadrant bit 0 is +x, bit 1 is +y, matching ChildFor
+        for (std::int32_t quadrant = 0; quadrant < 4; ++quadrant)
+        {
+            m_nodes.push_back(Node{centerX + ((quadrant & 1) ? quarter : -quarter),
+                                   centerY + ((quadrant & 2) ? quarter : -quarter),
+                                   quarter, 0.0f, 0.0f, 0.0f, -1, -1, 0});
+        }
+
+        // push_back may have moved the nodes, so re-fetch before touching the parent
+        Node &parent = m_nodes[node];
+        std::int32_t body = parent.firstBody;
+        parent.firstChild = firstChild;
+        parent.firstBody = -1;
+        parent.bodyCount = 0;
+
+        // The parent already holds these bodies' mass, reinsert them from its children
+        while (body >= 0)
+        {
+            const std::int32_t next = m_nextBody[body];
+            InsertBody(body, ChildFor(m_nodes[node], m_x[body], m_y[body]), depth + 1);
+            body = next;
+        }
+    }
+
+    void NBodySolver::ComputeTreeRange(std::size_t begin, std::size_t end, float *accelerations) const
+    {
+        const float softeningSq = std::max(m_softening * m_softening, MinSofteningSq);
+        const float thetaSq = m_theta * m_theta;
+        const float *treeX = m_treeX.data();
+        const float *treeY = m_treeY.data();
+        const float *treeMass = m_treeMass.data();
+
+        // Depth-first walk, at most 3 siblings are left pending per level
+        std::int32_t stack[MaxTreeDepth * 3 + 4];
+
+        // begin/end index the tree order, results are written at each body's original index
+        for (std::size_t k = begin; k < end; ++k)
+        {
+            const float xi = treeX[k];
+            const float yi = treeY[k];
+            float ax = 0.0f;
+            float ay = 0.0f;
+
+            int top = 0;
+            stack[top++] = 0;
+            while (top > 0)
+            {
+                const Node &node = m_nodes[stack[--top]];
+                if (node.mass == 0.0f)
+                    continue;
+
+                if (node.firstChild < 0)
+                {
+                    // The body's own entry has a zero offset and contributes nothing, as in ComputeDirect
+                    const std::int32_t last = node.firstBody + node.bodyCount;
+                    for (std::int32_t j = node.firstBody; j < last; ++j)
+                    {
+                        const float dx = treeX[j] - xi;
+                        const float dy = treeY[j] - yi;
+                        const float distanceSq = dx * dx + dy * dy + softeningSq;
+                        const float invDistance = 1.0f / std::sqrt(distanceSq);
+                        const float scale = treeMass[j] * invDistance * invDistance * invDistance;
+                        ax += dx * scale;
+                        ay += dy * scale;
+                    }
+                    continue;
+                }
+
+                const float dx = node.massX - xi;
+                const float dy = node.massY - yi;
+                const float distanceSq = dx * dx + dy * dy;
+                const float size = node.halfSize * 2.0f;
+                // A node containing the body is always opened, so no body ever attracts itself
+                const bool containsBody = std::abs(xi - node.centerX) <= node.halfSize && std::abs(yi - node.centerY) <= node.halfSize;
+                if (!containsBody && size * size < thetaSq * distanceSq)
+                {
+                    const float invDistance = 1.0f / std::sqrt(distanceSq + softeningSq);
+                    const float scale = node.mass * invDistance * invDistance * invDistance;
+                    ax += dx * scale;
+                    ay += dy * scale;
+                    continue;
+                }
+
+                for (std::int32_t child = 0; child < 4; ++child)
+                {
+                    stack[top++] = node.firstChild + child;
+                }
+            }
+
+            const std::size_t i = static_cast<std::size_t>(m_treeOrder[k]);
+            accelerations[i * 2] = ax * m_gravitationalConstant;
+            accelerations[i * 2 + 1] = ay * m_gravitationalConstant;
+        }
+    }
+} // namespace spark
@@ -0,0 +1,137 @@
+#include "Profiler.h"
+#include <chrono>
+
+namespace spark
+{
+    std::uint64_t Profiler::NowNs()
+    {
+        using namespace std::chrono;
+        return static_cast<std::uint64_t>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+    }
+
+    ProfileLabel Profiler::InternLabel(std::string_view name)
+    {
+        std::lock_guard lock{m_labelMutex};
+        auto it = m_labelIds.find(std::string{name});
+        if (it != m_labelIds.end())
+        {
+            return it->second;
+        }
+
+        const ProfileLabel label = static_cast<ProfileLabel>(m_labelNames.size());
+        m_labelNames.emplace_back(name);
+        m_labelIds.emplace(m_labelNames.back(), label);
+        return label;
+    }
+
+    const char *Profiler::GetLabelName(ProfileLabel label) const
+    {
+        std::lock_guard lock{m_labelMutex};
+        // deque never moves existing elements on push_back, so the pointer outlives the lock
+        return label < m_labelNames.size() ? m_labelNames[label].c_str() : "<unknown>";
+    }
+
+    Profiler::ThreadState &Profiler::GetThreadState()
+    {
+        // Each thread finds its own buffer without going through the lock after the first zone
+        thread_local ThreadState *threadState{nullptr};
+        if (!threadState)
+        {
+            std::lock_guard lock{m_threadMutex};
+            auto state = std::make_unique<ThreadState>();
+            state->threadIndex = static_cast<std::uint32_t>(m_threads.size());
+            threadState = state.get();
+            m_threads.emplace_back(std::move(state));
+        }
+        return *threadState;
+    }
+
+    bool Profiler::BeginZone(ProfileLabel label)
+    {
+        if (!m_isRecording.load(std::memory_order_relaxed))
+        {
+            return false;
+        }
+
+        ThreadState &state = GetThreadState();
+        if (state.zones.size() >= MaxZonesPerFrame)
+        {
+            ++state.droppedZones;
+            return false;
+        }
+
+        state.openZones.push_back(static_cast<std::uint32_t>(state.zones.size()));
+        state.zones.push_back(ProfileZone{label, state.threadIndex, static_cast<std::uint32_t>(state.openZones.size() - 1), NowNs(), 0});
+        return true;
+    }
+
+    void Profiler::EndZone()
+    {
+        ThreadState &state = GetThreadState();
+        if (state.openZones.empty())
+        {
+            return;
+        }
+        state.zones[state.openZones.back()].endNs = NowNs();
+        state.openZones.pop_back();
+    }
+
+    void Profiler::BeginFrame()
+    {
+        m_isRecording.store(m_isEnabled.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        m_frameStartNs = NowNs();
+    }
+
+    void Profiler::EndFrame()
+    {
+        const std::uint64_t frameIndex = m_publishedFrames.load(std::memory_order_relaxed);
+        ProfileFrame &frame = m_frames[frameIndex % FrameHistory];
+        frame.frameIndex = frameIndex;
+        frame.endNs = NowNs();
+        frame.startNs = m_frameStartNs ? m_frameStartNs : frame.endNs;
+        frame.zones.clear();
+        frame.droppedZones = 0;
+
+        {
+            std::lock_guard lock{m_threadMutex};
+            for (auto &state : m_threads)
+            {
+                frame.droppedZones += state->droppedZones;
+                state->droppedZones = 0;
+
+                if (state->openZones.empty())
+                {
+                    frame.zones.insert(frame.zones.end(), state->zones.begin(), state->zones.end());
+                    state->zones.clear();
+                    continue;
+                }
+
+                // Zones still open (a frame ended inside a scope) carry over to the next frame
+                std::vector<ProfileZone> stillOpen;
+                for (std::uint32_t &index : state->openZones)
+                {
+                    stillOpen.push_back(state->zones[index]);
+                    index = static_cast<std::uint32_t>(stillOpen.size() - 1);
+                }
+                for (const ProfileZone &zone : state->zones)
+                {
+                    if (zone.endNs != 0)
+                    {
+                        frame.zones.push_back(zone);
+                    }
+                }
+                state->zones = std::move(stillOpen);
+            }
+        }
+
+        m_frameStartNs = 0;
+        // Publish: readers that acquire this count see the frame's contents
+        m_publishedFrames.store(frameIndex + 1, std::memory_order_release);
+    }
+
+    const ProfileFrame *Profiler::GetLatestFrame() const
+    {
+        const std::uint64_t count = GetFrameCount();
+        return count ? &GetFrame(count - 1) : nullptr;
+    }
+} // namespace spark
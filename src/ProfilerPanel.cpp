@@ -0,0 +1,295 @@
+#include "ProfilerPanel.h"
+#include "TraceRecorder.h"
+#include <imgui.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <unordered_map>
+
+namespace spark
+{
+    namespace
+    {
+        constexpr float NsToMs = 1.0e-6f;
+
+        ImU32 LabelColor(ProfileLabel label)
+        {
+            // Golden-ratio hue steps keep neighbouring labels apart
+            const float hue = std::fmod(static_cast<float>(label) * 0.618034f, 1.0f);
+            return ImColor::HSV(hue, 0.45f, 0.85f);
+        }
+
+        struct ZoneTotals
+        {
+            ProfileLabel label{};
+            std::uint32_t calls{};
+            std::uint64_t totalNs{};
+            std::uint64_t selfNs{};
+        };
+    }
+
+    void ProfilerPanel::Render()
+    {
+        ImGui::Begin("Profiler", nullptr, ImGuiWindowFlags_NoCollapse);
+
+        Profiler &profiler = Profiler::GetInstance();
+        bool isEnabled = profiler.IsEnabled();
+        if (ImGui::Checkbox("Record", &isEnabled))
+        {
+            profiler.SetEnabled(isEnabled);
+        }
+        ImGui::SameLine();
+        bool isPaused = m_isPaused;
+        if (ImGui::Checkbox("Pause", &isPaused))
+        {
+            if (isPaused && profiler.GetFrameCount() > 0)
+            {
+                PinFrame(profiler.GetFrameCount() - 1);
+            }
+            m_isPaused = isPaused;
+        }
+        ImGui::SameLine();
+        TraceRecorder &traceRecorder = TraceRecorder::GetInstance();
+        if (traceRecorder.IsCapturing())
+        {
+            ImGui::Text("Capturing trace %zu/%zu", traceRecorder.GetCapturedFrameCount(), traceRecorder.GetRequestedFrameCount());
+        }
+        else if (ImGui::Button("Capture Trace (F9)"))
+        {
+            traceRecorder.StartCapture();
+        }
+
+        if (!m_isPaused)
+        {
+            RefreshHistory();
+        }
+
+        const ProfileFrame *frame = m_isPaused ? &m_pinnedFrame : profiler.GetLatestFrame();
+        if (!frame)
+        {
+            ImGui::Text("No frames recorded yet");
+            ImGui::End();
+            return;
+        }
+
+        RenderFrameHistory();
+
+        ImGui::Text("Frame %llu: %.2f ms, %zu zones", static_cast<unsigned long long>(frame->frameIndex),
+                    static_cast<float>(frame->endNs - frame->startNs) * NsToMs, frame->zones.size());
+        if (frame->droppedZones > 0)
+        {
+            ImGui::SameLine();
+            ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.0f, 1.0f), "(%u dropped)", frame->droppedZones);
+        }
+
+        RenderFlameGraph(*frame);
+        ImGui::Separator();
+        RenderZoneTable(*frame);
+
+        ImGui::End();
+    }
+
+    void ProfilerPanel::RefreshHistory()
+    {
+        const Profiler &profiler = Profiler::GetInstance();
+        const std::uint64_t count = profiler.GetFrameCount();
+        const std::uint64_t available = std::min<std::uint64_t>(count, Profiler::FrameHistory);
+        m_historyFirstFrame = count - available;
+
+        m_frameTimes.resize(static_cast<std::size_t>(available));
+        for (std::uint64_t i = 0; i < available; ++i)
+        {
+            const ProfileFrame &frame = profiler.GetFrame(m_historyFirstFrame + i);
+            m_frameTimes[static_cast<std::size_t>(i)] = static_cast<float>(frame.endNs - frame.startNs) * NsToMs;
+        }
+    }
+
+    void ProfilerPanel::PinFrame(std::uint64_t frameIndex)
+    {
+        m_pinnedFrame = Profiler::GetInstance().GetFrame(frameIndex);
+    }
+
+    void ProfilerPanel::RenderFrameHistory()
+    {
+        if (m_frameTimes.empty())
+        {
+            return;
+        }
+
+        const float slowest = *std::max_element(m_frameTimes.begin(), m_frameTimes.end());
+        // Keep the 60 fps budget visible as a reference height
+        const float scaleMax = std::max(slowest, 1000.0f / 30.0f);
+        char overlay[64];
+        std::snprintf(overlay, sizeof(overlay), "max %.2f ms (16.7 ms = 60 fps)", slowest);
+        ImGui::PlotHistogram("##FrameHistory", m_frameTimes.data(), static_cast<int>(m_frameTimes.size()), 0, overlay, 0.0f, scaleMax,
+                             ImVec2(-1.0f, 80.0f));
+
+        // Clicking a bar pauses on that frame
+        if (ImGui::IsItemHovered() && ImGui::IsMouseClicked(ImGuiMouseButton_Left))
+        {
+            const float width = ImGui::GetItemRectSize().x;
+            const float t = width > 0.0f ? (ImGui::GetMousePos().x - ImGui::GetItemRectMin().x) / width : 0.0f;
+            const std::size_t bar = std::min(static_cast<std::size_t>(std::max(t, 0.0f) * m_frameTimes.size()), m_frameTimes.size() - 1);
+            const std::uint64_t frameIndex = m_historyFirstFrame + bar;
+            // While live, the oldest slot may already hold a newer frame
+            if (frameIndex + Profiler::FrameHistory > Profiler::GetInstance().GetFrameCount())
+            {
+                PinFrame(frameIndex);
+                m_isPaused = true;
+            }
+        }
+    }
+
+    void ProfilerPanel::RenderFlameGraph(const ProfileFrame &frame)
+    {
+        const Profiler &profiler = Profiler::GetInstance();
+        const std::uint64_t frameNs = std::max<std::uint64_t>(frame.endNs - frame.startNs, 1);
+        const float rowHeight = ImGui::GetTextLineHeightWithSpacing();
+        const float width = std::max(ImGui::GetContentRegionAvail().x, 1.0f);
+        ImDrawList *drawList = ImGui::GetWindowDrawList();
+
+        std::uint32_t threadCount = 0;
+        for (const ProfileZone &zone : frame.zones)
+        {
+            threadCount = std::max(threadCount, zone.threadIndex + 1);
+        }
+
+        for (std::uint32_t thread = 0; thread < threadCount; ++thread)
+        {
+            std::uint32_t maxDepth = 0;
+            bool hasZones = false;
+            for (const ProfileZone &zone : frame.zones)
+            {
+                if (zone.threadIndex == thread)
+                {
+                    maxDepth = std::max(maxDepth, zone.depth);
+                    hasZones = true;
+                }
+            }
+            if (!hasZones)
+            {
+                continue;
+            }
+
+            ImGui::Text("Thread %u", thread);
+            const ImVec2 origin = ImGui::GetCursorScreenPos();
+            const float height = static_cast<float>(maxDepth + 1) * rowHeight;
+            ImGui::PushID(static_cast<int>(thread));
+            ImGui::InvisibleButton("##FlameGraph", ImVec2(width, height));
+            const bool isHovered = ImGui::IsItemHovered();
+            ImGui::PopID();
+            const ImVec2 mouse = ImGui::GetMousePos();
+
+            for (const ProfileZone &zone : frame.zones)
+            {
+                if (zone.threadIndex != thread)
+                    continue;
+
+                // Zones carried over from the previous frame are clipped to this one
+                const std::uint64_t clippedStart = std::clamp(zone.startNs, frame.startNs, frame.endNs);
+                const std::uint64_t clippedEnd = std::clamp(zone.endNs, clippedStart, frame.endNs);
+                const std::uint64_t start = clippedStart - frame.startNs;
+                const std::uint64_t end = clippedEnd - frame.startNs;
+                const float x0 = origin.x + width * static_cast<float>(start) / static_cast<float>(frameNs);
+                const float x1 = origin.x + width * static_cast<float>(end) / static_cast<float>(frameNs);
+                const float y0 = origin.y + static_cast<float>(zone.depth) * rowHeight;
+                const float y1 = y0 + rowHeight - 1.0f;
+                if (x1 - x0 < 1.0f)
+                {
+                    drawList->AddLine(ImVec2(x0, y0), ImVec2(x0, y1), LabelColor(zone.label));
+                    continue;
+                }
+
+                drawList->AddRectFilled(ImVec2(x0, y0), ImVec2(x1, y1), LabelColor(zone.label));
+                const char *name = profiler.GetLabelName(zone.label);
+                if (x1 - x0 > 24.0f)
+                {
+                    const ImVec4 clip(x0, y0, x1 - 2.0f, y1);
+                    drawList->AddText(nullptr, 0.0f, ImVec2(x0 + 2.0f, y0), IM_COL32(20, 20, 20, 255), name, nullptr, 0.0f, &clip);
+                }
+
+                if (isHovered && mouse.x >= x0 && mouse.x < x1 && mouse.y >= y0 && mouse.y < y1)
+                {
+                    const float ms = static_cast<float>(zone.endNs - zone.startNs) * NsToMs;
+                    ImGui::SetTooltip("%s\n%.3f ms (%.1f%% of frame)", name, ms, 100.0f * ms / (static_cast<float>(frameNs) * NsToMs));
+                }
+            }
+        }
+    }
+
+    void ProfilerPanel::RenderZoneTable(const ProfileFrame &frame)
+    {
+        // Self time = duration minus direct children. Zones are grouped by thread with parents before children,
+        // so a stack indexed by depth finds each zone's parent.
+        std::unordered_map<ProfileLabel, ZoneTotals> totals;
+        std::vector<std::uint64_t> childNs(frame.zones.size(), 0);
+        std::vector<std::size_t> stack;
+        std::uint32_t currentThread = ~0u;
+        for (std::size_t i = 0; i < frame.zones.size(); ++i)
+        {
+            const ProfileZone &zone = frame.zones[i];
+            if (zone.threadIndex != currentThread)
+            {
+                stack.clear();
+                currentThread = zone.threadIndex;
+            }
+            while (stack.size() > zone.depth)
+            {
+                stack.pop_back();
+            }
+
+            const std::uint64_t duration = zone.endNs - zone.startNs;
+            if (!stack.empty())
+            {
+                childNs[stack.back()] += duration;
+            }
+            stack.push_back(i);
+        }
+
+        for (std::size_t i = 0; i < frame.zones.size(); ++i)
+        {
+            const ProfileZone &zone = frame.zones[i];
+            const std::uint64_t duration = zone.endNs - zone.startNs;
+            ZoneTotals &entry = totals[zone.label];
+            entry.label = zone.label;
+            ++entry.calls;
+            entry.totalNs += duration;
+            entry.selfNs += duration - std::min(duration, childNs[i]);
+        }
+
+        std::vector<ZoneTotals> rows;
+        rows.reserve(totals.size());
+        for (const auto &[label, entry] : totals)
+        {
+            rows.push_back(entry);
+        }
+        std::sort(rows.begin(), rows.end(), [](const ZoneTotals &a, const ZoneTotals &b)
+                  { return a.selfNs > b.selfNs; });
+
+        const ImGuiTableFlags flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_ScrollY | ImGuiTableFlags_Resizable;
+        if (ImGui::BeginTable("##ZoneTable", 4, flags, ImVec2(0.0f, ImGui::GetContentRegionAvail().y)))
+        {
+            ImGui::TableSetupScrollFreeze(0, 1);
+            ImGui::TableSetupColumn("Zone");
+            ImGui::TableSetupColumn("Calls", ImGuiTableColumnFlags_WidthFixed);
+            ImGui::TableSetupColumn("Self ms", ImGuiTableColumnFlags_WidthFixed);
+            ImGui::TableSetupColumn("Total ms", ImGuiTableColumnFlags_WidthFixed);
+            ImGui::TableHeadersRow();
+
+            const Profiler &profiler = Profiler::GetInstance();
+            for (const ZoneTotals &row : rows)
+            {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(profiler.GetLabelName(row.label));
+                ImGui::TableNextColumn();
+                ImGui::Text("%u", row.calls);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", static_cast<float>(row.selfNs) * NsToMs);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", static_cast<float>(row.totalNs) * NsToMs);
+            }
+            ImGui::EndTable();
+        }
+    }
+}
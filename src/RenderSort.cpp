@@ -0,0 +1,31 @@
+#include "RenderSort.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace spark
+{
+    namespace
+    {
+        constexpr std::uint64_t MaxTextureRank = (1u << 12) - 1;
+        constexpr std::uint64_t MaxBlendModeRank = (1u << 4) - 1;
+
+        // Flips the bits so unsigned comparison orders the keys like the floats
+        std::uint32_t DepthBits(float depth)
+        {
+            if (std::isnan(depth) || depth == 0.0f)
+            {
+                depth = 0.0f;
+            }
+            const std::uint32_t bits = std::bit_cast<std::uint32_t>(depth);
+            return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+        }
+    }
+
+    std::uint64_t PackSortKey(const RenderSortKey &key, std::uint64_t textureRank, std::uint64_t blendModeRank)
+    {
+        const auto layer = static_cast<std::uint64_t>(key.layer + 128);
+        return layer << 56 | std::min(textureRank, MaxTextureRank) << 44 | std::min(blendModeRank, MaxBlendModeRank) << 40 |
+               std::uint64_t{DepthBits(key.depth)} << 8;
+    }
+} // namespace spark
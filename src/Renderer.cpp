@@ -1,10 +1,37 @@
 #include "Renderer.h"
 #include "Window.h"
+#include "Profiler.h"
+#include "RenderSort.h"
 #include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <utility>
 namespace spark
 {
+    namespace
+    {
+        template <typename T>
+        std::uint64_t RankOf(std::vector<T> &seen, T value)
+        {
+            // A frame rarely has more than a handful of textures between flushes, a linear scan beats hashing
+            auto it = std::find(seen.begin(), seen.end(), value);
+            if (it == seen.end())
+            {
+                seen.push_back(value);
+                it = seen.end() - 1;
+            }
+            return static_cast<std::uint64_t>(it - seen.begin());
+        }
+    }
+
     Renderer::Renderer() : m_SDLRenderer{std::unique_ptr<SDL_Renderer, SDLRendererDeleter>(SDL_CreateRenderer(Window::GetInstance().GetSDLWindow(), nullptr))}
     {
+        m_batchVertices.reserve(4096);
+        m_batchIndices.reserve(6144);
+        if (m_SDLRenderer)
+        {
+            SDL_GetRenderDrawBlendMode(m_SDLRenderer.get(), &m_blendMode);
+        }
     }
 
     SDL_Renderer *Renderer::GetSDLRenderer() const
@@ -36,6 +63,8 @@ namespace spark
 
     bool Renderer::SetRenderScale(float scaleX, float scaleY)
     {
+        // Queued geometry must be drawn with the scale that was active when it was submitted
+        Flush();
         return SDL_SetRenderScale(m_SDLRenderer.get(), scaleX, scaleY);
     }
 
@@ -46,11 +75,14 @@ namespace spark
 
     bool Renderer::SetDrawColor(Uint8 r, Uint8 g, Uint8 b, Uint8 a)
     {
+        // Batched primitives carry their color per vertex, so a color change never breaks a batch
+        m_drawColor = SDL_FColor{r / 255.0f, g / 255.0f, b / 255.0f, a / 255.0f};
         return SDL_SetRenderDrawColor(m_SDLRenderer.get(), r, g, b, a);
     }
 
     bool Renderer::SetDrawColorFloat(float r, float g, float b, float a)
     {
+        m_drawColor = SDL_FColor{r, g, b, a};
         return SDL_SetRenderDrawColorFloat(m_SDLRenderer.get(), r, g, b, a);
     }
 
@@ -64,86 +96,695 @@ namespace spark
         return SDL_GetRenderDrawColorFloat(m_SDLRenderer.get(), r, g, b, a);
     }
 
+    bool Renderer::SetDrawBlendMode(SDL_BlendMode blendMode)
+    {
+        // Queued commands carry the blend mode they were submitted with, so this doesn't need a flush
+        m_blendMode = blendMode;
+        return SDL_SetRenderDrawBlendMode(m_SDLRenderer.get(), blendMode);
+    }
+
+    SDL_BlendMode Renderer::GetDrawBlendMode() const
+    {
+        return m_blendMode;
+    }
+
     bool Renderer::Clear()
     {
+        // Anything queued before the clear would be wiped by it anyway, but keep SDL's command order intact
+        Flush();
         return SDL_RenderClear(m_SDLRenderer.get());
     }
 
     bool Renderer::Present()
     {
+        Flush();
+        m_lastFrameStats = m_frameStats;
+        m_frameStats = {};
         return SDL_RenderPresent(m_SDLRenderer.get());
     }
 
+    bool Renderer::Flush()
+    {
+        if (m_batchIndices.empty())
+        {
+            m_batchVertices.clear();
+            m_commands.clear();
+            return true;
+        }
+
+        SPARK_PROFILE_SCOPE("Renderer::Flush");
+        // Applied once per batch here rather than in every Push function
+        if (m_isViewEnabled)
+        {
+            const ViewTransform &view = m_view;
+            for (SDL_Vertex &vertex : m_batchVertices)
+            {
+                const SDL_FPoint world = vertex.position;
+                vertex.position.x = view.xx * world.x + view.yx * world.y + view.tx;
+                vertex.position.y = view.xy * world.x + view.yy * world.y + view.ty;
+            }
+        }
+
+        const auto indexCount = [this](std::size_t command)
+        {
+            const std::uint32_t end = command + 1 < m_commands.size() ? m_commands[command + 1].firstIndex
+                                                                      : static_cast<std::uint32_t>(m_batchIndices.size());
+            return static_cast<int>(end - m_commands[command].firstIndex);
+        };
+
+        bool result = true;
+        SDL_BlendMode appliedBlendMode = m_blendMode;
+        if (m_commands.size() == 1)
+        {
+            result = DrawBatch(m_commands[0].texture, m_commands[0].blendMode, m_batchIndices.data(), indexCount(0), appliedBlendMode);
+        }
+        else
+        {
+            m_sortItems.clear();
+            for (std::uint32_t i = 0; i < m_commands.size(); ++i)
+            {
+                m_sortItems.push_back(SortItem{m_commands[i].key, i});
+            }
+            RadixSort(m_sortItems, m_sortScratch);
+
+            // Every command shares m_batchVertices, a batch only gathers the indices of its run of commands
+            m_sortedIndices.clear();
+            const DrawCommand *batch = &m_commands[m_sortItems.front().command];
+            for (const SortItem &item : m_sortItems)
+            {
+                const DrawCommand &command = m_commands[item.command];
+                if (command.texture != batch->texture || command.blendMode != batch->blendMode)
+                {
+                    result &= DrawBatch(batch->texture, batch->blendMode, m_sortedIndices.data(), static_cast<int>(m_sortedIndices.size()), appliedBlendMode);
+                    m_sortedIndices.clear();
+                    batch = &command;
+                }
+                const int *first = m_batchIndices.data() + command.firstIndex;
+                m_sortedIndices.insert(m_sortedIndices.end(), first, first + indexCount(item.command));
+            }
+            result &= DrawBatch(batch->texture, batch->blendMode, m_sortedIndices.data(), static_cast<int>(m_sortedIndices.size()), appliedBlendMode);
+        }
+
+        if (appliedBlendMode != m_blendMode)
+        {
+            SDL_SetRenderDrawBlendMode(m_SDLRenderer.get(), m_blendMode);
+        }
+        m_batchVertices.clear();
+        m_batchIndices.clear();
+        m_commands.clear();
+        m_textureRanks.clear();
+        m_blendModeRanks.clear();
+        return result;
+    }
+
+    bool Renderer::DrawBatch(SDL_Texture *texture, SDL_BlendMode blendMode, const int *indices, int indexCount, SDL_BlendMode &appliedBlendMode)
+    {
+        if (blendMode != appliedBlendMode)
+        {
+            SDL_SetRenderDrawBlendMode(m_SDLRenderer.get(), blendMode);
+            appliedBlendMode = blendMode;
+        }
+        // The batch is already in sorted order, splitting it only bounds the size of each submission.
+        // SDL only reads the vertices the indices refer to.
+        bool result = true;
+        for (int first = 0; first < indexCount; first += MaxDrawIndices)
+        {
+            ++m_frameStats.drawCalls;
+            result &= SDL_RenderGeometry(m_SDLRenderer.get(), texture, m_batchVertices.data(), static_cast<int>(m_batchVertices.size()),
+                                         indices + first, std::min(MaxDrawIndices, indexCount - first));
+        }
+        return result;
+    }
+
+    void Renderer::SetViewTransform(const ViewTransform &view)
+    {
+        // Queued vertices belong to the old view
+        if (m_isViewEnabled)
+        {
+            Flush();
+        }
+        m_view = view;
+    }
+
+    void Renderer::SetViewTransformEnabled(bool enabled)
+    {
+        if (enabled != m_isViewEnabled)
+        {
+            Flush();
+            m_isViewEnabled = enabled;
+        }
+    }
+
+    bool Renderer::SetViewport(const SDL_Rect *viewport)
+    {
+        Flush();
+        return SDL_SetRenderViewport(m_SDLRenderer.get(), viewport);
+    }
+
+    bool Renderer::PushRenderTarget(SDL_Texture *texture)
+    {
+        SDL_Texture *previousTarget = GetRenderTarget();
+        if (!SDL_SetRenderTarget(m_SDLRenderer.get(), texture))
+        {
+            return false;
+        }
+        m_queuedTargets.push_back(QueuedTarget{previousTarget, std::exchange(m_batchVertices, {}), std::exchange(m_batchIndices, {}),
+                                               std::exchange(m_commands, {}), std::exchange(m_textureRanks, {}),
+                                               std::exchange(m_blendModeRanks, {}), std::exchange(m_sortKey, {}),
+                                               std::exchange(m_view, {}), std::exchange(m_isViewEnabled, false)});
+        return true;
+    }
+
+    bool Renderer::PopRenderTarget()
+    {
+        if (m_queuedTargets.empty())
+        {
+            std::cerr << "PopRenderTarget without a matching PushRenderTarget\n";
+            return false;
+        }
+        bool result = Flush();
+        QueuedTarget &queued = m_queuedTargets.back();
+        result &= SDL_SetRenderTarget(m_SDLRenderer.get(), queued.target);
+        m_batchVertices = std::move(queued.vertices);
+        m_batchIndices = std::move(queued.indices);
+        m_commands = std::move(queued.commands);
+        m_textureRanks = std::move(queued.textureRanks);
+        m_blendModeRanks = std::move(queued.blendModeRanks);
+        m_sortKey = queued.sortKey;
+        m_view = queued.view;
+        m_isViewEnabled = queued.isViewEnabled;
+        m_queuedTargets.pop_back();
+        return result;
+    }
+
+    SDL_Texture *Renderer::GetRenderTarget() const
+    {
+        return SDL_GetRenderTarget(m_SDLRenderer.get());
+    }
+
+    void Renderer::SetLayerBatched(std::int8_t layer, bool batched)
+    {
+        m_batchedLayers[LayerIndex(layer)] = batched;
+    }
+
+    std::uint64_t Renderer::MakeSortKey(SDL_Texture *texture)
+    {
+        if (!m_batchedLayers[LayerIndex(m_sortKey.layer)])
+        {
+            return PackSortKey(m_sortKey, 0, 0);
+        }
+        return PackSortKey(m_sortKey, RankOf(m_textureRanks, texture), RankOf(m_blendModeRanks, m_blendMode));
+    }
+
+    void Renderer::PrepareBatch(SDL_Texture *texture, int vertexCount)
+    {
+        m_frameStats.verticesSubmitted += vertexCount;
+
+        const std::uint64_t key = MakeSortKey(texture);
+        if (!m_commands.empty())
+        {
+            const DrawCommand &last = m_commands.back();
+            if (last.key == key && last.texture == texture && last.blendMode == m_blendMode)
+            {
+                return;
+            }
+        }
+        m_commands.push_back(DrawCommand{key, texture, m_blendMode, static_cast<std::uint32_t>(m_batchIndices.size())});
+    }
+
+    void Renderer::PushQuad(float x0, float y0, float x1, float y1, float x2, float y2, float x3, float y3, const SDL_FColor &color)
+    {
+        PrepareBatch(nullptr, 4);
+
+        const int base = static_cast<int>(m_batchVertices.size());
+        m_batchVertices.push_back({{x0, y0}, color, {0.0f, 0.0f}});
+        m_batchVertices.push_back({{x1, y1}, color, {0.0f, 0.0f}});
+        m_batchVertices.push_back({{x2, y2}, color, {0.0f, 0.0f}});
+        m_batchVertices.push_back({{x3, y3}, color, {0.0f, 0.0f}});
+
+        const int quadIndices[6] = {base, base + 1, base + 2, base, base + 2, base + 3};
+        m_batchIndices.insert(m_batchIndices.end(), quadIndices, quadIndices + 6);
+    }
+
+    void Renderer::PushRect(float x, float y, float w, float h, const SDL_FColor &color)
+    {
+        PushQuad(x, y, x + w, y, x + w, y + h, x, y + h, color);
+    }
+
+    void Renderer::PushLine(float x1, float y1, float x2, float y2, const SDL_FColor &color)
+    {
+        // Built in screen space and mapped back through the inverse view, which Flush applies again, so lines
+        // stay 1px wide whatever the view's zoom
+        const ViewTransform view = m_isViewEnabled ? m_view : ViewTransform{};
+        const float determinant = view.xx * view.yy - view.yx * view.xy;
+        if (determinant == 0.0f)
+        {
+            return;
+        }
+        const auto toScreen = [&view](float x, float y)
+        {
+            return SDL_FPoint{view.xx * x + view.yx * y + view.tx, view.xy * x + view.yy * y + view.ty};
+        };
+        const auto toWorld = [&view, determinant](float x, float y)
+        {
+            x -= view.tx;
+            y -= view.ty;
+            return SDL_FPoint{(view.yy * x - view.yx * y) / determinant, (view.xx * y - view.xy * x) / determinant};
+        };
+
+        const SDL_FPoint start = toScreen(x1, y1);
+        const SDL_FPoint end = toScreen(x2, y2);
+        const float dx = end.x - start.x;
+        const float dy = end.y - start.y;
+        const float length = SDL_sqrtf(dx * dx + dy * dy);
+        SDL_FPoint corners[4];
+        if (length < 1e-4f)
+        {
+            corners[0] = toWorld(start.x, start.y);
+            corners[1] = toWorld(start.x + 1.0f, start.y);
+            corners[2] = toWorld(start.x + 1.0f, start.y + 1.0f);
+            corners[3] = toWorld(start.x, start.y + 1.0f);
+        }
+        else
+        {
+            // A 1px wide quad through the pixel centers, extended half a pixel past both endpoints
+            // so the endpoint pixels are covered the same way SDL_RenderLine covers them
+            const float ux = dx / length * 0.5f;
+            const float uy = dy / length * 0.5f;
+            const float ax = start.x + 0.5f - ux;
+            const float ay = start.y + 0.5f - uy;
+            const float bx = end.x + 0.5f + ux;
+            const float by = end.y + 0.5f + uy;
+
+            // (-uy, ux) is the half-pixel normal
+            corners[0] = toWorld(ax - uy, ay + ux);
+            corners[1] = toWorld(bx - uy, by + ux);
+            corners[2] = toWorld(bx + uy, by - ux);
+            corners[3] = toWorld(ax + uy, ay - ux);
+        }
+        PushQuad(corners[0].x, corners[0].y, corners[1].x, corners[1].y, corners[2].x, corners[2].y, corners[3].x, corners[3].y, color);
+    }
+
     bool Renderer::RenderPoint(float x, float y)
     {
-        return SDL_RenderPoint(m_SDLRenderer.get(), x, y);
+        ++m_frameStats.primitivesSubmitted;
+        PushRect(x, y, 1.0f, 1.0f, m_drawColor);
+        return true;
     }
 
     bool Renderer::RenderPoints(const SDL_FPoint *points, int count)
     {
-        return SDL_RenderPoints(m_SDLRenderer.get(), points, count);
+        if (!points || count < 0)
+            return false;
+
+        m_frameStats.primitivesSubmitted += count;
+        for (int i = 0; i < count; ++i)
+        {
+            PushRect(points[i].x, points[i].y, 1.0f, 1.0f, m_drawColor);
+        }
+        return true;
     }
 
     bool Renderer::RenderLine(float x1, float y1, float x2, float y2)
     {
-        return SDL_RenderLine(m_SDLRenderer.get(), x1, y1, x2, y2);
+        ++m_frameStats.primitivesSubmitted;
+        PushLine(x1, y1, x2, y2, m_drawColor);
+        return true;
     }
 
     bool Renderer::RenderLines(const SDL_FPoint *points, int count)
     {
-        return SDL_RenderLines(m_SDLRenderer.get(), points, count);
+        if (!points || count < 0)
+            return false;
+
+        // Connected polyline, same as SDL_RenderLines
+        m_frameStats.primitivesSubmitted += std::max(0, count - 1);
+        for (int i = 0; i + 1 < count; ++i)
+        {
+            PushLine(points[i].x, points[i].y, points[i + 1].x, points[i + 1].y, m_drawColor);
+        }
+        return true;
     }
 
     bool Renderer::RenderRect(const SDL_FRect *rect)
     {
-        return SDL_RenderRect(m_SDLRenderer.get(), rect);
+        if (!rect)
+            return false;
+
+        ++m_frameStats.primitivesSubmitted;
+        const float x = rect->x;
+        const float y = rect->y;
+        const float w = rect->w;
+        const float h = rect->h;
+        if (w <= 2.0f || h <= 2.0f)
+        {
+            PushRect(x, y, w, h, m_drawColor);
+            return true;
+        }
+
+        // Outline as four 1px strips that don't overlap at the corners
+        PushRect(x, y, w, 1.0f, m_drawColor);
+        PushRect(x, y + h - 1.0f, w, 1.0f, m_drawColor);
+        PushRect(x, y + 1.0f, 1.0f, h - 2.0f, m_drawColor);
+        PushRect(x + w - 1.0f, y + 1.0f, 1.0f, h - 2.0f, m_drawColor);
+        return true;
     }
 
     bool Renderer::RenderRects(const SDL_FRect *rects, int count)
     {
-        return SDL_RenderRects(m_SDLRenderer.get(), rects, count);
+        if (!rects || count < 0)
+            return false;
+
+        for (int i = 0; i < count; ++i)
+        {
+            RenderRect(&rects[i]);
+        }
+        return true;
     }
 
     bool Renderer::RenderFillRect(const SDL_FRect *rect)
     {
-        return SDL_RenderFillRect(m_SDLRenderer.get(), rect);
+        if (!rect)
+            return false;
+
+        ++m_frameStats.primitivesSubmitted;
+        PushRect(rect->x, rect->y, rect->w, rect->h, m_drawColor);
+        return true;
     }
 
     bool Renderer::RenderFillRects(const SDL_FRect *rects, int count)
     {
-        return SDL_RenderFillRects(m_SDLRenderer.get(), rects, count);
-    }
-
-    // bool Renderer::RenderTexture(SDL_Texture *texture, const SDL_FRect *srcrect, const SDL_FRect *dstrect)
-    // {
-    //     return false;
-    // }
-    // bool Renderer::RenderTextureRotated(SDL_Texture *texture, const SDL_FRect *srcrect, const SDL_FRect *dstrect, double angle, const SDL_FPoint *center, SDL_FlipMode flip)
-    // {
-    //     return false;
-    // }
-    // bool Renderer::RenderTextureAffine(SDL_Texture *texture, const SDL_FRect *srcrect, const SDL_FPoint *origin, const SDL_FPoint *right, const SDL_FPoint *down)
-    // {
-    //     return false;
-    // }
-    // bool Renderer::RenderTextureTiled(SDL_Texture *texture, const SDL_FRect *srcrect, float scale, const SDL_FRect *dstrect)
-    // {
-    //     return false;
-    // }
-    // bool Renderer::RenderTexture9Grid(SDL_Texture *texture, const SDL_FRect *srcrect, float left_width, float right_width, float top_height, float bottom_height, float scale, const SDL_FRect *dstrect)
-    // {
-    //     return false;
-    // }
-    // bool Renderer::RenderTexture9GridTiled(SDL_Texture *texture, const SDL_FRect *srcrect, float left_width, float right_width, float top_height, float bottom_height, float scale, const SDL_FRect *dstrect, float tileScale)
-    // {
-    //     return false;
-    // }
-    // bool Renderer::RenderGeometry(SDL_Texture *texture, const SDL_Vertex *vertices, int num_vertices, const int *indices, int num_indices)
-    // {
-    //     return false;
-    // }
-    // bool Renderer::RenderGeometryRaw(SDL_Texture *texture, const float *xy, int xy_stride, const SDL_FColor *color, int color_stride, const float *uv, int uv_stride, int num_vertices, const void *indices, int num_indices, int size_indices)
-    // {
-    //     return false;
-    // }
+        if (!rects || count < 0)
+            return false;
+
+        m_frameStats.primitivesSubmitted += count;
+        for (int i = 0; i < count; ++i)
+        {
+            PushRect(rects[i].x, rects[i].y, rects[i].w, rects[i].h, m_drawColor);
+        }
+        return true;
+    }
+
+    bool Renderer::RenderLineList(const float *coords, int count, const float *colors)
+    {
+        if (!coords || count < 0)
+            return false;
+
+        m_frameStats.primitivesSubmitted += count;
+        for (int i = 0; i < count; ++i)
+        {
+            const float *line = coords + i * 4;
+            const SDL_FColor color = colors ? SDL_FColor{colors[i * 4], colors[i * 4 + 1], colors[i * 4 + 2], colors[i * 4 + 3]} : m_drawColor;
+            PushLine(line[0], line[1], line[2], line[3], color);
+        }
+        return true;
+    }
+
+    bool Renderer::RenderFillRectList(const float *rects, int count, const float *colors)
+    {
+        if (!rects || count < 0)
+            return false;
+
+        m_frameStats.primitivesSubmitted += count;
+        for (int i = 0; i < count; ++i)
+        {
+            const float *rect = rects + i * 4;
+            const SDL_FColor color = colors ? SDL_FColor{colors[i * 4], colors[i * 4 + 1], colors[i * 4 + 2], colors[i * 4 + 3]} : m_drawColor;
+            PushRect(rect[0], rect[1], rect[2], rect[3], color);
+        }
+        return true;
+    }
+
+    bool Renderer::RenderPointList(const float *points, int count, const float *colors)
+    {
+        if (!points || count < 0)
+            return false;
+
+        m_frameStats.primitivesSubmitted += count;
+        for (int i = 0; i < count; ++i)
+        {
+            const SDL_FColor color = colors ? SDL_FColor{colors[i * 4], colors[i * 4 + 1], colors[i * 4 + 2], colors[i * 4 + 3]} : m_drawColor;
+            PushRect(points[i * 2], points[i * 2 + 1], 1.0f, 1.0f, color);
+        }
+        return true;
+    }
+
+    SDL_Vertex *Renderer::AllocateQuads(SDL_Texture *texture, int quadCount)
+    {
+        if (quadCount <= 0)
+            return nullptr;
+
+        // A single oversized request is still submitted as one batch
+        PrepareBatch(texture, quadCount * 4);
+        m_frameStats.primitivesSubmitted += quadCount;
+
+        const int base = static_cast<int>(m_batchVertices.size());
+        m_batchVertices.resize(m_batchVertices.size() + static_cast<size_t>(quadCount) * 4);
+
+        const size_t indexOffset = m_batchIndices.size();
+        m_batchIndices.resize(indexOffset + static_cast<size_t>(quadCount) * 6);
+        int *indices = m_batchIndices.data() + indexOffset;
+        for (int quad = 0; quad < quadCount; ++quad)
+        {
+            const int first = base + quad * 4;
+            indices[0] = first;
+            indices[1] = first + 1;
+            indices[2] = first + 2;
+            indices[3] = first;
+            indices[4] = first + 2;
+            indices[5] = first + 3;
+            indices += 6;
+        }
+
+        return m_batchVertices.data() + base;
+    }
+
+    bool Renderer::RenderGeometry(SDL_Texture *texture, const SDL_Vertex *vertices, int num_vertices, const int *indices, int num_indices)
+    {
+        if (!vertices || num_vertices <= 0)
+            return false;
+
+        PrepareBatch(texture, num_vertices);
+
+        const int base = static_cast<int>(m_batchVertices.size());
+        m_batchVertices.insert(m_batchVertices.end(), vertices, vertices + num_vertices);
+        if (indices && num_indices > 0)
+        {
+            m_frameStats.primitivesSubmitted += num_indices / 3;
+            m_batchIndices.reserve(m_batchIndices.size() + num_indices);
+            for (int i = 0; i < num_indices; ++i)
+            {
+                m_batchIndices.push_back(base + indices[i]);
+            }
+        }
+        else
+        {
+            m_frameStats.primitivesSubmitted += num_vertices / 3;
+            m_batchIndices.reserve(m_batchIndices.size() + num_vertices);
+            for (int i = 0; i < num_vertices; ++i)
+            {
+                m_batchIndices.push_back(base + i);
+            }
+        }
+        return true;
+    }
+
+    bool Renderer::RenderGeometryRaw(SDL_Texture *texture, const float *xy, int xy_stride, const SDL_FColor *color, int color_stride, const float *uv, int uv_stride, int num_vertices, const void *indices, int num_indices, int size_indices)
+    {
+        // Arbitrary strides/index sizes aren't worth repacking, draw it directly
+        Flush();
+        ++m_frameStats.drawCalls;
+        m_frameStats.primitivesSubmitted += (indices ? num_indices : num_vertices) / 3;
+        m_frameStats.verticesSubmitted += num_vertices;
+        return SDL_RenderGeometryRaw(m_SDLRenderer.get(), texture, xy, xy_stride, color, color_stride, uv, uv_stride, num_vertices, indices, num_indices, size_indices);
+    }
+
+    // Textured draws go through the same batch as primitives, one SDL_RenderGeometry per run of draws sharing a
+    // texture. With images packed into atlas pages (see TextureCache) that's usually one draw for many sprites.
+    bool Renderer::RenderTexture(SDL_Texture *texture, const SDL_FRect *srcrect, const SDL_FRect *dstrect)
+    {
+        SDL_FRect source;
+        SDL_FRect destination;
+        if (!ResolveTextureRects(texture, srcrect, dstrect, source, destination))
+            return false;
+
+        const SDL_FPoint corners[4] = {{destination.x, destination.y},
+                                       {destination.x + destination.w, destination.y},
+                                       {destination.x + destination.w, destination.y + destination.h},
+                                       {destination.x, destination.y + destination.h}};
+        PushTexturedQuad(texture, corners, source, SDL_FLIP_NONE);
+        return true;
+    }
+
+    bool Renderer::RenderTextureRotated(SDL_Texture *texture, const SDL_FRect *srcrect, const SDL_FRect *dstrect, double angle, const SDL_FPoint *center, SDL_FlipMode flip)
+    {
+        SDL_FRect source;
+        SDL_FRect destination;
+        if (!ResolveTextureRects(texture, srcrect, dstrect, source, destination))
+            return false;
+
+        // Clockwise in degrees around center, which is relative to the destination's top left
+        const SDL_FPoint pivot = center ? *center : SDL_FPoint{destination.w * 0.5f, destination.h * 0.5f};
+        const float radians = static_cast<float>(angle) * (SDL_PI_F / 180.0f);
+        const float cosine = SDL_cosf(radians);
+        const float sine = SDL_sinf(radians);
+        const float originX = destination.x + pivot.x;
+        const float originY = destination.y + pivot.y;
+        const auto transform = [&](float x, float y)
+        {
+            x -= pivot.x;
+            y -= pivot.y;
+            return SDL_FPoint{originX + x * cosine - y * sine, originY + x * sine + y * cosine};
+        };
+
+        const SDL_FPoint corners[4] = {transform(0.0f, 0.0f), transform(destination.w, 0.0f),
+                                       transform(destination.w, destination.h), transform(0.0f, destination.h)};
+        PushTexturedQuad(texture, corners, source, flip);
+        return true;
+    }
+
+    bool Renderer::RenderTextureAffine(SDL_Texture *texture, const SDL_FRect *srcrect, const SDL_FPoint *origin, const SDL_FPoint *right, const SDL_FPoint *down)
+    {
+        SDL_FRect source;
+        SDL_FRect target;
+        if (!ResolveTextureRects(texture, srcrect, nullptr, source, target))
+            return false;
+
+        // Missing points default to the corners of the render target, like SDL_RenderTextureAffine
+        const SDL_FPoint topLeft = origin ? *origin : SDL_FPoint{target.x, target.y};
+        const SDL_FPoint topRight = right ? *right : SDL_FPoint{target.x + target.w, target.y};
+        const SDL_FPoint bottomLeft = down ? *down : SDL_FPoint{target.x, target.y + target.h};
+        const SDL_FPoint corners[4] = {topLeft, topRight,
+                                       {topRight.x + bottomLeft.x - topLeft.x, topRight.y + bottomLeft.y - topLeft.y},
+                                       bottomLeft};
+        PushTexturedQuad(texture, corners, source, SDL_FLIP_NONE);
+        return true;
+    }
+
+    bool Renderer::RenderTextureTiled(SDL_Texture *texture, const SDL_FRect *srcrect, float scale, const SDL_FRect *dstrect)
+    {
+        SDL_FRect source;
+        SDL_FRect destination;
+        if (scale <= 0.0f || !ResolveTextureRects(texture, srcrect, dstrect, source, destination))
+            return false;
+
+        PushTiled(texture, source, source.w * scale, source.h * scale, destination);
+        return true;
+    }
+
+    bool Renderer::RenderTexture9Grid(SDL_Texture *texture, const SDL_FRect *srcrect, float left_width, float right_width, float top_height, float bottom_height, float scale, const SDL_FRect *dstrect)
+    {
+        return RenderTexture9GridTiled(texture, srcrect, left_width, right_width, top_height, bottom_height, scale, dstrect, 0.0f);
+    }
+
+    bool Renderer::RenderTexture9GridTiled(SDL_Texture *texture, const SDL_FRect *srcrect, float left_width, float right_width, float top_height, float bottom_height, float scale, const SDL_FRect *dstrect, float tileScale)
+    {
+        SDL_FRect source;
+        SDL_FRect destination;
+        if (!ResolveTextureRects(texture, srcrect, dstrect, source, destination))
+            return false;
+
+        if (scale <= 0.0f)
+        {
+            scale = 1.0f;
+        }
+
+        // Columns and rows of the grid in the source and in the destination, corners keep their scaled size
+        const float sourceX[4] = {source.x, source.x + left_width, source.x + source.w - right_width, source.x + source.w};
+        const float sourceY[4] = {source.y, source.y + top_height, source.y + source.h - bottom_height, source.y + source.h};
+        const float destinationX[4] = {destination.x, destination.x + left_width * scale,
+                                       destination.x + destination.w - right_width * scale, destination.x + destination.w};
+        const float destinationY[4] = {destination.y, destination.y + top_height * scale,
+                                       destination.y + destination.h - bottom_height * scale, destination.y + destination.h};
+
+        for (int row = 0; row < 3; ++row)
+        {
+            for (int column = 0; column < 3; ++column)
+            {
+                const SDL_FRect cellSource{sourceX[column], sourceY[row], sourceX[column + 1] - sourceX[column], sourceY[row + 1] - sourceY[row]};
+                const SDL_FRect cellDestination{destinationX[column], destinationY[row],
+                                                destinationX[column + 1] - destinationX[column], destinationY[row + 1] - destinationY[row]};
+                if (cellSource.w <= 0.0f || cellSource.h <= 0.0f || cellDestination.w <= 0.0f || cellDestination.h <= 0.0f)
+                    continue;
+
+                // Edges repeat along their length and the center both ways, corners are never tiled
+                const bool tileX = tileScale > 0.0f && column == 1;
+                const bool tileY = tileScale > 0.0f && row == 1;
+                PushTiled(texture, cellSource, tileX ? cellSource.w * tileScale : cellDestination.w,
+                          tileY ? cellSource.h * tileScale : cellDestination.h, cellDestination);
+            }
+        }
+        return true;
+    }
+
+    bool Renderer::ResolveTextureRects(SDL_Texture *texture, const SDL_FRect *srcrect, const SDL_FRect *dstrect, SDL_FRect &source, SDL_FRect &destination)
+    {
+        float textureWidth = 0.0f;
+        float textureHeight = 0.0f;
+        if (!texture || !SDL_GetTextureSize(texture, &textureWidth, &textureHeight))
+            return false;
+
+        source = srcrect ? *srcrect : SDL_FRect{0.0f, 0.0f, textureWidth, textureHeight};
+        if (dstrect)
+        {
+            destination = *dstrect;
+        }
+        else
+        {
+            int outputWidth = 0;
+            int outputHeight = 0;
+            SDL_GetCurrentRenderOutputSize(m_SDLRenderer.get(), &outputWidth, &outputHeight);
+            destination = SDL_FRect{0.0f, 0.0f, static_cast<float>(outputWidth), static_cast<float>(outputHeight)};
+        }
+        return source.w > 0.0f && source.h > 0.0f;
+    }
+
+    void Renderer::PushTexturedQuad(SDL_Texture *texture, const SDL_FPoint (&corners)[4], const SDL_FRect &source, SDL_FlipMode flip)
+    {
+        float textureWidth = 1.0f;
+        float textureHeight = 1.0f;
+        SDL_GetTextureSize(texture, &textureWidth, &textureHeight);
+
+        float u0 = source.x / textureWidth;
+        float v0 = source.y / textureHeight;
+        float u1 = (source.x + source.w) / textureWidth;
+        float v1 = (source.y + source.h) / textureHeight;
+        if (flip & SDL_FLIP_HORIZONTAL)
+            std::swap(u0, u1);
+        if (flip & SDL_FLIP_VERTICAL)
+            std::swap(v0, v1);
+
+        // SDL_RenderTexture would apply the texture's color and alpha mod, keep that behaviour
+        SDL_FColor color{1.0f, 1.0f, 1.0f, 1.0f};
+        SDL_GetTextureColorModFloat(texture, &color.r, &color.g, &color.b);
+        SDL_GetTextureAlphaModFloat(texture, &color.a);
+
+        SDL_Vertex *vertices = AllocateQuads(texture, 1);
+        vertices[0] = {corners[0], color, {u0, v0}};
+        vertices[1] = {corners[1], color, {u1, v0}};
+        vertices[2] = {corners[2], color, {u1, v1}};
+        vertices[3] = {corners[3], color, {u0, v1}};
+    }
+
+    void Renderer::PushTiled(SDL_Texture *texture, const SDL_FRect &source, float tileWidth, float tileHeight, const SDL_FRect &destination)
+    {
+        if (tileWidth <= 0.0f || tileHeight <= 0.0f)
+            return;
+
+        // Tiles are quads cut from the source rect rather than UV wrapping, which would repeat the whole atlas page
+        for (float y = 0.0f; y < destination.h; y += tileHeight)
+        {
+            const float height = std::min(tileHeight, destination.h - y);
+            for (float x = 0.0f; x < destination.w; x += tileWidth)
+            {
+                const float width = std::min(tileWidth, destination.w - x);
+                const SDL_FRect tileSource{source.x, source.y, source.w * (width / tileWidth), source.h * (height / tileHeight)};
+                const SDL_FPoint corners[4] = {{destination.x + x, destination.y + y},
+                                               {destination.x + x + width, destination.y + y},
+                                               {destination.x + x + width, destination.y + y + height},
+                                               {destination.x + x, destination.y + y + height}};
+                PushTexturedQuad(texture, corners, tileSource, SDL_FLIP_NONE);
+            }
+        }
+    }
 }
\ No newline at end of file
@@ -1,11 +1,68 @@
 #include "Scene.h"
 #include "GameObject.h"
+#include "Components/TransformComponent.h"
+#include "Components/CameraComponent.h"
+#include "IBoundedRenderable.h"
+#include "Renderer.h"
+#include "Profiler.h"
+#include "JobSystem.h"
 #include <ranges>
 #include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <bit>
 
 namespace spark
 {
-    Scene::Scene(const std::string &name) : m_name{name}
+    namespace
+    {
+        // Below this many transforms scheduling costs more than it saves
+        constexpr std::size_t ParallelTransformThreshold = 4096;
+        // Top-level subtrees handed to one job at minimum
+        constexpr std::size_t SubtreesPerJob = 16;
+        // Fewer parallel-safe roots than this are just updated in place
+        constexpr std::size_t MinParallelRoots = 2;
+        constexpr std::size_t RootsPerJob = 4;
+
+        constexpr std::uint32_t NotIndexed = ~std::uint32_t{0};
+
+        std::uint32_t NextSceneId()
+        {
+            // 0 is left for default constructed handles, which belong to no scene
+            static std::atomic<std::uint32_t> nextId{1};
+            return nextId.fetch_add(1, std::memory_order_relaxed);
+        }
+        const std::vector<GameObject *> NoGameObjects;
+
+        void InsertIndexed(std::vector<GameObject *> &list, std::uint32_t &position, GameObject *gameObject)
+        {
+            position = static_cast<std::uint32_t>(list.size());
+            list.push_back(gameObject);
+        }
+
+        // Swap-and-pop, positionOf gives the stored position of the object that moves into the hole
+        template <typename PositionOf>
+        void EraseIndexed(std::vector<GameObject *> &list, std::uint32_t &position, PositionOf positionOf)
+        {
+            if (position == NotIndexed)
+            {
+                return;
+            }
+            GameObject *last = list.back();
+            list[position] = last;
+            positionOf(last) = position;
+            list.pop_back();
+            position = NotIndexed;
+        }
+
+        // Touching edges count, so lines and points lying on the view's border are still drawn
+        bool Overlaps(const SDL_FRect &a, const SDL_FRect &b)
+        {
+            return a.x <= b.x + b.w && b.x <= a.x + a.w && a.y <= b.y + b.h && b.y <= a.y + a.h;
+        }
+    }
+
+    Scene::Scene(const std::string &name) : m_name{name}, m_id{NextSceneId()}
     {
     }
 
@@ -13,65 +70,491 @@ namespace spark
     {
         if (!gameObject)
             return;
+        GameObject::RequireMainThreadUpdate("Scene::AddGameObject");
         GameObject *rawPtr = gameObject.get();
-        bool isAlreadyPresent = std::ranges::any_of(m_gameObjects, [&](const auto &go)
-                                                    { return go.get() == rawPtr; });
-        if (!isAlreadyPresent)
+        const bool isPending = std::ranges::any_of(m_pendingGameObjects, [&](const auto &go)
+                                                   { return go.get() == rawPtr; });
+        if (IsRoot(rawPtr) || isPending)
+        {
+            // Already owned by the scene, the duplicate pointer mustn't destroy it
+            gameObject.release();
+            return;
+        }
+
+        // Handles are valid from here on, even while the object waits in the pending list
+        RegisterGameObject(rawPtr);
+        if (GameObject::IsDeferringChanges())
         {
-            m_gameObjects.emplace_back(std::move(gameObject));
+            m_pendingGameObjects.emplace_back(std::move(gameObject));
+            return;
         }
+        InsertRoot(std::move(gameObject));
     }
 
     GameObject *Scene::EmplaceGameObject()
     {
-        auto &ref = m_gameObjects.emplace_back(std::make_unique<GameObject>());
-        return ref.get();
+        GameObject *gameObject = new GameObject();
+        AddGameObject(std::unique_ptr<GameObject>{gameObject});
+        return gameObject;
     }
     GameObject *Scene::EmplaceGameObject(const std::string &name)
     {
-        auto &ref = m_gameObjects.emplace_back(std::make_unique<GameObject>(name));
-        return ref.get();
+        GameObject *gameObject = new GameObject(name);
+        AddGameObject(std::unique_ptr<GameObject>{gameObject});
+        return gameObject;
     }
 
     void Scene::RemoveGameObject(GameObject *gameObject)
     {
-        std::erase_if(m_gameObjects, [&](const auto &go)
-                      { return go.get() == gameObject; });
+        if (GameObject::IsDeferringChanges())
+        {
+            GameObject::DeferChange([this, gameObject]()
+                                    { RemoveGameObject(gameObject); });
+            return;
+        }
+
+        // Destroyed when the detached pointer goes out of scope
+        DetachRoot(gameObject);
     }
 
     GameObject *Scene::PopGameObject(GameObject *gameObject)
     {
-        // Find the given GO in the list
-        const auto it = std::ranges::find_if(m_gameObjects,
-                                             [&](const std::unique_ptr<GameObject> &ptr)
-                                             { return ptr.get() == gameObject; });
+        return DetachRoot(gameObject).release();
+    }
 
-        // If found
-        if (it != m_gameObjects.end())
+    GameObject *Scene::Resolve(GameObjectHandle handle) const noexcept
+    {
+        if (handle.sceneId != m_id || handle.index >= m_handleSlots.size())
         {
-            // store the found object's raw ptr
-            auto tmp = it->get();
+            return nullptr;
+        }
+        const HandleSlot &slot = m_handleSlots[handle.index];
+        return slot.generation == handle.generation ? slot.gameObject : nullptr;
+    }
+
+    bool Scene::IsRoot(const GameObject *gameObject) const noexcept
+    {
+        const std::size_t index = gameObject->m_siblingIndex;
+        return !gameObject->m_parent && index < m_gameObjects.size() && m_gameObjects[index].get() == gameObject;
+    }
 
-            // Release the unique pointer from its cleanup/management duties
-            //(to prevent the destructor from being called when we remove it from the owning vector)
-            it->release();
-            // Remove the released unique pointer from the vector
-            // Which would be a unique pointer to nullptr
-            m_gameObjects.erase(it);
-            return tmp;
+    void Scene::InsertRoot(std::unique_ptr<GameObject> gameObject)
+    {
+        gameObject->m_siblingIndex = static_cast<std::uint32_t>(m_gameObjects.size());
+        m_gameObjects.emplace_back(std::move(gameObject));
+        MarkHierarchyDirty();
+    }
+
+    std::unique_ptr<GameObject> Scene::DetachRoot(GameObject *gameObject)
+    {
+        if (!gameObject || !IsRoot(gameObject))
+        {
+            return nullptr;
         }
-        return nullptr;
+
+        // Order preserving, the roots after it shift down one. Root order is update and draw order, so removing
+        // one object must not move an unrelated one in front of others.
+        const std::size_t index = gameObject->m_siblingIndex;
+        std::unique_ptr<GameObject> detached = std::move(m_gameObjects[index]);
+        m_gameObjects.erase(m_gameObjects.begin() + static_cast<std::ptrdiff_t>(index));
+        for (std::size_t i = index; i < m_gameObjects.size(); ++i)
+        {
+            m_gameObjects[i]->m_siblingIndex = static_cast<std::uint32_t>(i);
+        }
+        detached->m_siblingIndex = GameObject::NoSiblingIndex;
+        MarkHierarchyDirty();
+        return detached;
     }
 
-    std::vector<GameObject *> Scene::GetAllGameObjects() const
+    void Scene::RegisterGameObject(GameObject *gameObject)
     {
-        std::vector<GameObject *> rawPtrs;
-        rawPtrs.reserve(m_gameObjects.size());
-        for (const auto &go : m_gameObjects)
+        if (gameObject->m_scene)
+        {
+            return;
+        }
+
+        std::uint32_t index;
+        if (!m_freeHandleSlots.empty())
+        {
+            index = m_freeHandleSlots.back();
+            m_freeHandleSlots.pop_back();
+        }
+        else
+        {
+            index = static_cast<std::uint32_t>(m_handleSlots.size());
+            m_handleSlots.push_back(HandleSlot{nullptr, 0});
+        }
+
+        m_handleSlots[index].gameObject = gameObject;
+        gameObject->m_scene = this;
+        gameObject->m_handle = GameObjectHandle{index, m_handleSlots[index].generation, m_id};
+
+        if (index >= m_indexPositions.size())
+        {
+            m_indexPositions.resize(index + 1);
+        }
+        IndexPositions &positions = m_indexPositions[index];
+        positions.components.fill(NotIndexed);
+        positions.tags.fill(NotIndexed);
+        positions.unboundedRenderer = NotIndexed;
+        positions.renderOrder = NotIndexed;
+        InsertIndexed(m_allGameObjects, positions.all, gameObject);
+        InsertIndexed(m_nameIndex[gameObject->GetName()], positions.name, gameObject);
+        for (ComponentMask mask = gameObject->GetComponentBitmask(); mask != 0; mask &= mask - 1)
+        {
+            OnComponentAdded(gameObject, static_cast<std::size_t>(std::countr_zero(mask)));
+        }
+        for (TagMask mask = gameObject->GetTagMask(); mask != 0; mask &= mask - 1)
+        {
+            OnTagAdded(gameObject, static_cast<std::size_t>(std::countr_zero(mask)));
+        }
+        for (IRenderable *renderable : gameObject->m_renderables)
+        {
+            OnRenderableAdded(gameObject, renderable);
+        }
+
+        // Objects assembled before joining the scene bring their children along
+        for (GameObject *child : gameObject->GetChildren())
+        {
+            RegisterGameObject(child);
+        }
+    }
+
+    void Scene::UnregisterGameObject(GameObject *gameObject) noexcept
+    {
+        const GameObjectHandle handle = gameObject->m_handle;
+        if (handle.index >= m_handleSlots.size() || m_handleSlots[handle.index].gameObject != gameObject)
+        {
+            return;
+        }
+
+        IndexPositions &positions = m_indexPositions[handle.index];
+        EraseIndexed(m_allGameObjects, positions.all, [this](GameObject *moved) -> std::uint32_t &
+                     { return m_indexPositions[moved->m_handle.index].all; });
+        if (auto it = m_nameIndex.find(gameObject->GetName()); it != m_nameIndex.end())
+        {
+            EraseIndexed(it->second, positions.name, [this](GameObject *moved) -> std::uint32_t &
+                         { return m_indexPositions[moved->m_handle.index].name; });
+        }
+        for (ComponentMask mask = gameObject->GetComponentBitmask(); mask != 0; mask &= mask - 1)
+        {
+            OnComponentRemoved(gameObject, static_cast<std::size_t>(std::countr_zero(mask)));
+        }
+        for (TagMask mask = gameObject->GetTagMask(); mask != 0; mask &= mask - 1)
+        {
+            OnTagRemoved(gameObject, static_cast<std::size_t>(std::countr_zero(mask)));
+        }
+        for (IRenderable *renderable : gameObject->m_renderables)
+        {
+            if (auto *bounded = dynamic_cast<IBoundedRenderable *>(renderable))
+            {
+                RemoveCullEntry(bounded);
+            }
+        }
+        EraseIndexed(m_unboundedRenderers, positions.unboundedRenderer, [this](GameObject *moved) -> std::uint32_t &
+                     { return m_indexPositions[moved->m_handle.index].unboundedRenderer; });
+
+        // Bumping the generation is what turns every outstanding handle to this object stale
+        HandleSlot &slot = m_handleSlots[handle.index];
+        slot.gameObject = nullptr;
+        ++slot.generation;
+        m_freeHandleSlots.push_back(handle.index);
+    }
+
+    void Scene::OnGameObjectRenamed(GameObject *gameObject, const std::string &oldName)
+    {
+        std::uint32_t &position = m_indexPositions[gameObject->m_handle.index].name;
+        if (auto it = m_nameIndex.find(oldName); it != m_nameIndex.end())
+        {
+            EraseIndexed(it->second, position, [this](GameObject *moved) -> std::uint32_t &
+                         { return m_indexPositions[moved->m_handle.index].name; });
+        }
+        InsertIndexed(m_nameIndex[gameObject->GetName()], position, gameObject);
+    }
+
+    void Scene::OnComponentAdded(GameObject *gameObject, std::size_t typeId)
+    {
+        std::uint32_t &position = m_indexPositions[gameObject->m_handle.index].components[typeId];
+        if (position == NotIndexed)
+        {
+            InsertIndexed(m_componentIndex[typeId], position, gameObject);
+        }
+    }
+
+    void Scene::OnComponentRemoved(GameObject *gameObject, std::size_t typeId)
+    {
+        EraseIndexed(m_componentIndex[typeId], m_indexPositions[gameObject->m_handle.index].components[typeId],
+                     [this, typeId](GameObject *moved) -> std::uint32_t &
+                     { return m_indexPositions[moved->m_handle.index].components[typeId]; });
+    }
+
+    void Scene::OnTagAdded(GameObject *gameObject, std::size_t tagId)
+    {
+        std::uint32_t &position = m_indexPositions[gameObject->m_handle.index].tags[tagId];
+        if (position == NotIndexed)
+        {
+            InsertIndexed(m_tagIndex[tagId], position, gameObject);
+        }
+    }
+
+    void Scene::OnTagRemoved(GameObject *gameObject, std::size_t tagId)
+    {
+        EraseIndexed(m_tagIndex[tagId], m_indexPositions[gameObject->m_handle.index].tags[tagId],
+                     [this, tagId](GameObject *moved) -> std::uint32_t &
+                     { return m_indexPositions[moved->m_handle.index].tags[tagId]; });
+    }
+
+    void Scene::OnRenderableAdded(GameObject *gameObject, IRenderable *renderable)
+    {
+        if (auto *bounded = dynamic_cast<IBoundedRenderable *>(renderable))
+        {
+            AddCullEntry(gameObject, bounded);
+            return;
+        }
+
+        std::uint32_t &position = m_indexPositions[gameObject->m_handle.index].unboundedRenderer;
+        if (position == NotIndexed)
+        {
+            InsertIndexed(m_unboundedRenderers, position, gameObject);
+        }
+    }
+
+    void Scene::OnRenderableRemoved(GameObject *gameObject, IRenderable *renderable)
+    {
+        if (auto *bounded = dynamic_cast<IBoundedRenderable *>(renderable))
+        {
+            RemoveCullEntry(bounded);
+        }
+        else if (gameObject->m_unboundedRenderables.empty())
+        {
+            EraseIndexed(m_unboundedRenderers, m_indexPositions[gameObject->m_handle.index].unboundedRenderer,
+                         [this](GameObject *moved) -> std::uint32_t &
+                         { return m_indexPositions[moved->m_handle.index].unboundedRenderer; });
+        }
+    }
+
+    void Scene::AddCullEntry(GameObject *gameObject, IBoundedRenderable *renderable)
+    {
+        if (m_cullEntryIds.contains(renderable))
+        {
+            return;
+        }
+
+        std::uint32_t id;
+        if (!m_freeCullEntries.empty())
+        {
+            id = m_freeCullEntries.back();
+            m_freeCullEntries.pop_back();
+        }
+        else
+        {
+            id = static_cast<std::uint32_t>(m_cullEntries.size());
+            m_cullEntries.emplace_back();
+        }
+
+        // Measured on the next culled Render, the component may not have anything to draw yet
+        m_cullEntries[id] = CullEntry{renderable, gameObject, SDL_FRect{}, 0, 0, false, false};
+        m_cullEntryIds.emplace(renderable, id);
+    }
+
+    void Scene::RemoveCullEntry(IBoundedRenderable *renderable)
+    {
+        auto it = m_cullEntryIds.find(renderable);
+        if (it == m_cullEntryIds.end())
+        {
+            return;
+        }
+
+        const std::uint32_t id = it->second;
+        m_cullEntryIds.erase(it);
+        m_cullingGrid.Remove(id);
+        m_cullEntries[id].renderable = nullptr;
+        m_cullEntries[id].gameObject = nullptr;
+        m_freeCullEntries.push_back(id);
+    }
+
+    std::size_t Scene::RefreshCullEntries()
+    {
+        SPARK_PROFILE_SCOPE("Scene::RefreshCullEntries");
+        std::size_t orderedCount = 0;
+        for (std::uint32_t id = 0; id < m_cullEntries.size(); ++id)
+        {
+            CullEntry &entry = m_cullEntries[id];
+            if (!entry.renderable)
+            {
+                continue;
+            }
+            if (m_indexPositions[entry.gameObject->m_handle.index].renderOrder != NotIndexed)
+            {
+                ++orderedCount;
+            }
+
+            // Static objects stop here, two integer compares and no call into the renderable
+            const TransformComponent *transform = entry.gameObject->GetTransform();
+            const bool hasMoved = transform && (transform->IsDirty() || transform->GetWorldVersion() != entry.transformVersion);
+            if (entry.isMeasured && !hasMoved && entry.renderable->GetBoundsVersion() == entry.boundsVersion)
+            {
+                continue;
+            }
+
+            entry.hasBounds = entry.renderable->GetWorldBounds(entry.bounds);
+            // Read afterwards, measuring may have brought a dirty world matrix up to date
+            entry.transformVersion = transform ? transform->GetWorldVersion() : 0;
+            entry.boundsVersion = entry.renderable->GetBoundsVersion();
+            entry.isMeasured = true;
+            if (entry.hasBounds)
+            {
+                m_cullingGrid.Update(id, entry.bounds);
+            }
+            else
+            {
+                m_cullingGrid.Remove(id);
+            }
+        }
+        return orderedCount;
+    }
+
+    void Scene::RenderVisible(const SDL_FRect &view)
+    {
+        if (m_isHierarchyDirty)
+        {
+            RebuildTransformOrder();
+        }
+        const std::size_t orderedCount = RefreshCullEntries();
+
+        const auto addItem = [this](GameObject *gameObject, IRenderable *renderable)
+        {
+            const std::uint32_t order = m_indexPositions[gameObject->m_handle.index].renderOrder;
+            if (order == NotIndexed)
+            {
+                return false;
+            }
+            const std::vector<IRenderable *> &renderables = gameObject->m_renderables;
+            const auto slot = static_cast<std::uint64_t>(std::find(renderables.begin(), renderables.end(), renderable) - renderables.begin());
+            m_drawList.push_back(DrawItem{(std::uint64_t{order} << 32) | slot, renderable, nullptr});
+            return true;
+        };
+
+        m_drawList.clear();
+        std::size_t drawnCount = 0;
+        m_cullingGrid.Query(view, [&](std::uint32_t id)
+                            {
+                                const CullEntry &entry = m_cullEntries[id];
+                                if (Overlaps(entry.bounds, view) && addItem(entry.gameObject, entry.renderable))
+                                {
+                                    ++drawnCount;
+                                } });
+        for (GameObject *gameObject : m_unboundedRenderers)
+        {
+            for (IRenderable *renderable : gameObject->m_unboundedRenderables)
+            {
+                addItem(gameObject, renderable);
+            }
+        }
+        std::size_t cachedCount = 0;
+        for (const DrawItem &item : m_bitmapCacheRoots)
         {
-            rawPtrs.push_back(go.get());
+            // A stale bitmap has to be redrawn to know where it goes
+            SDL_FRect bounds;
+            if (!item.gameObject->GetBitmapCacheBounds(bounds) || Overlaps(bounds, view))
+            {
+                m_drawList.push_back(item);
+                ++cachedCount;
+            }
+        }
+        m_lastDrawnCount = drawnCount;
+        m_lastCulledCount = orderedCount - drawnCount;
+        m_lastCachedCount = cachedCount;
+
+        // Keys are unique, so this is the order GameObject::Render would have drawn them in
+        std::sort(m_drawList.begin(), m_drawList.end(), [](const DrawItem &a, const DrawItem &b)
+                  { return a.key < b.key; });
+        Renderer &renderer = Renderer::GetInstance();
+        for (const DrawItem &item : m_drawList)
+        {
+            if (!item.renderable)
+            {
+                renderer.SetSortKey({});
+                item.gameObject->Render();
+                continue;
+            }
+            renderer.SetSortKey(item.renderable->GetSortKey());
+            item.renderable->Render();
         }
-        return rawPtrs;
+    }
+
+    void Scene::ReleaseBitmapCaches()
+    {
+        for (GameObject *gameObject : m_allGameObjects)
+        {
+            gameObject->ReleaseBitmapCache();
+        }
+    }
+
+    void Scene::SetCamera(CameraComponent *camera)
+    {
+        m_cameraObject = camera && camera->GetParent()->GetScene() == this ? camera->GetParent()->GetHandle() : GameObjectHandle{};
+    }
+
+    CameraComponent *Scene::GetCamera() const
+    {
+        if (GameObject *gameObject = Resolve(m_cameraObject))
+        {
+            if (CameraComponent *camera = gameObject->GetComponent<CameraComponent>())
+            {
+                return camera;
+            }
+        }
+        // The index is reordered by every removal, so pick by handle to keep the choice stable from frame to frame
+        const std::vector<GameObject *> &cameras = m_componentIndex[GetComponentTypeId<CameraComponent>()];
+        const auto lowest = std::min_element(cameras.begin(), cameras.end(), [](const GameObject *a, const GameObject *b)
+                                             { return a->GetHandle().index < b->GetHandle().index; });
+        return lowest == cameras.end() ? nullptr : (*lowest)->GetComponent<CameraComponent>();
+    }
+
+    GameObject *Scene::FindGameObject(const std::string &name) const
+    {
+        const std::vector<GameObject *> &matches = FindGameObjects(name);
+        return matches.empty() ? nullptr : matches.front();
+    }
+
+    const std::vector<GameObject *> &Scene::FindGameObjects(const std::string &name) const
+    {
+        auto it = m_nameIndex.find(name);
+        return it != m_nameIndex.end() ? it->second : NoGameObjects;
+    }
+
+    const std::vector<GameObject *> &Scene::GetGameObjectsWithTag(const std::string &tag) const
+    {
+        const std::size_t tagId = TagRegistry::GetInstance().FindTagId(tag);
+        return tagId != TagRegistry::InvalidTagId ? m_tagIndex[tagId] : NoGameObjects;
+    }
+
+    const std::vector<GameObject *> &Scene::GetGameObjectsWithComponent(std::size_t componentTypeId) const
+    {
+        return componentTypeId < MaxComponentTypes ? m_componentIndex[componentTypeId] : NoGameObjects;
+    }
+
+    const std::vector<GameObject *> &Scene::GetQueryCandidates(ComponentMask components, TagMask tags) const
+    {
+        const std::vector<GameObject *> *shortest = &m_allGameObjects;
+        for (ComponentMask mask = components; mask != 0; mask &= mask - 1)
+        {
+            const auto &list = m_componentIndex[static_cast<std::size_t>(std::countr_zero(mask))];
+            if (list.size() < shortest->size())
+            {
+                shortest = &list;
+            }
+        }
+        for (TagMask mask = tags; mask != 0; mask &= mask - 1)
+        {
+            const auto &list = m_tagIndex[static_cast<std::size_t>(std::countr_zero(mask))];
+            if (list.size() < shortest->size())
+            {
+                shortest = &list;
+            }
+        }
+        return *shortest;
     }
 
     void Scene::SetName(const std::string &name)
@@ -94,36 +577,320 @@ namespace spark
 
     void Scene::DeleteGameObjects()
     {
-        std::erase_if(m_gameObjects, [](const auto &go)
-                      { return go->GetIsToBeDeleted(); });
+        // One stable compaction pass, the survivors keep their order. The deleted roots are destroyed once the
+        // list is consistent again, their destructors unregister them from the scene.
+        std::vector<std::unique_ptr<GameObject>> deleted;
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < m_gameObjects.size(); ++i)
+        {
+            if (m_gameObjects[i]->GetIsToBeDeleted())
+            {
+                m_gameObjects[i]->m_siblingIndex = GameObject::NoSiblingIndex;
+                deleted.push_back(std::move(m_gameObjects[i]));
+                continue;
+            }
+            if (kept != i)
+            {
+                m_gameObjects[kept] = std::move(m_gameObjects[i]);
+                m_gameObjects[kept]->m_siblingIndex = static_cast<std::uint32_t>(kept);
+            }
+            ++kept;
+        }
+        m_gameObjects.resize(kept);
+        bool isRemoved = !deleted.empty();
+        deleted.clear();
+
+        for (const auto &go : m_gameObjects)
+        {
+            isRemoved |= go->RemoveDeletedChildren();
+        }
+        if (isRemoved)
+        {
+            MarkHierarchyDirty();
+        }
     }
+
+    void Scene::ApplyDeferredChanges()
+    {
+        // Objects first: recorded commands may reparent them, which expects them in m_gameObjects
+        if (!m_pendingGameObjects.empty())
+        {
+            m_gameObjects.reserve(m_gameObjects.size() + m_pendingGameObjects.size());
+            for (auto &gameObject : m_pendingGameObjects)
+            {
+                InsertRoot(std::move(gameObject));
+            }
+            m_pendingGameObjects.clear();
+        }
+        m_deferredChanges.Playback();
+        DeleteGameObjects();
+    }
+
+    void Scene::RebuildTransformOrder()
+    {
+        m_transformOrder.clear();
+        m_subtreeStarts.clear();
+        m_bitmapCacheRoots.clear();
+        // Objects that left the hierarchy keep NotIndexed, the culled Render skips them like the walk would
+        for (GameObject *gameObject : m_allGameObjects)
+        {
+            m_indexPositions[gameObject->m_handle.index].renderOrder = NotIndexed;
+        }
+        std::uint32_t renderOrder = 0;
+
+        // Iterative pre-order walk, so every parent lands in the array before its children
+        struct PendingNode
+        {
+            GameObject *gameObject;
+            std::int32_t parent;
+            // Under an object caching its subtree as a bitmap, which draws it as a whole
+            bool isCached;
+        };
+        std::vector<PendingNode> stack;
+        stack.reserve(m_gameObjects.size());
+        for (auto it = m_gameObjects.rbegin(); it != m_gameObjects.rend(); ++it)
+        {
+            stack.push_back({it->get(), -1, false});
+        }
+
+        while (!stack.empty())
+        {
+            PendingNode node = stack.back();
+            stack.pop_back();
+            const std::uint32_t order = renderOrder++;
+            if (!node.isCached)
+            {
+                if (node.gameObject->IsCacheAsBitmap())
+                {
+                    m_bitmapCacheRoots.push_back(DrawItem{std::uint64_t{order} << 32, nullptr, node.gameObject});
+                    node.isCached = true;
+                }
+                else
+                {
+                    m_indexPositions[node.gameObject->m_handle.index].renderOrder = order;
+                }
+            }
+            // The walk finishes one root's subtree before popping the next root
+            if (!node.gameObject->GetParent())
+            {
+                m_subtreeStarts.push_back(m_transformOrder.size());
+            }
+
+            // Children of an object without a transform are treated as roots, same as GetWorldMatrix does
+            std::int32_t index = -1;
+            if (TransformComponent *transform = node.gameObject->GetTransform())
+            {
+                index = static_cast<std::int32_t>(m_transformOrder.size());
+                m_transformOrder.push_back({transform, node.parent});
+            }
+
+            const auto &children = node.gameObject->GetChildren();
+            for (auto it = children.rbegin(); it != children.rend(); ++it)
+            {
+                stack.push_back({*it, index, node.isCached});
+            }
+        }
+
+        m_isHierarchyDirty = false;
+    }
+
+    void Scene::PropagateTransforms()
+    {
+        if (m_isHierarchyDirty)
+        {
+            RebuildTransformOrder();
+        }
+
+        const std::size_t count = m_transformOrder.size();
+        JobSystem &jobSystem = JobSystem::GetInstance();
+        if (count < ParallelTransformThreshold || m_subtreeStarts.size() < 2 || jobSystem.GetWorkerCount() == 0)
+        {
+            PropagateTransformRange(0, count);
+            return;
+        }
+
+        // Parents always sit in the same subtree as their children, so subtrees never read each other's matrices
+        SPARK_PROFILE_SCOPE("Scene::PropagateTransforms");
+        jobSystem.ParallelFor(0, m_subtreeStarts.size(), SubtreesPerJob, [this, count](std::size_t first, std::size_t last)
+                              {
+                                  const std::size_t end = last < m_subtreeStarts.size() ? m_subtreeStarts[last] : count;
+                                  PropagateTransformRange(m_subtreeStarts[first], end); });
+    }
+
+    void Scene::PropagateTransformRange(std::size_t begin, std::size_t end)
+    {
+        // SetDirtyRecursive already pushes dirtiness down the hierarchy,
+        // so a single forward pass over the flat array is enough
+        const glm::mat4 identity = glm::identity<glm::mat4>();
+        const TransformNode *nodes = m_transformOrder.data();
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            TransformComponent *transform = nodes[i].transform;
+            if (!transform->IsDirty())
+            {
+                continue;
+            }
+
+            const std::int32_t parent = nodes[i].parent;
+            transform->UpdateWorldMatrix(parent >= 0 ? nodes[parent].transform->GetCachedWorldMatrix() : identity);
+        }
+    }
+
     void Scene::Init()
     {
-        for (auto &go : m_gameObjects)
+        // Nothing is deferred here: components added in Init are initialized right away and SetParent shows in
+        // GetParent immediately. Objects are visited from a pre-order snapshot that reparenting can't disturb,
+        // then the ones created meanwhile, which were registered at the end of m_allGameObjects.
+        const std::size_t registeredCount = m_allGameObjects.size();
+        std::vector<GameObject *> gameObjects;
+        gameObjects.reserve(registeredCount);
+        std::vector<GameObject *> stack;
+        for (auto it = m_gameObjects.rbegin(); it != m_gameObjects.rend(); ++it)
+        {
+            stack.push_back(it->get());
+        }
+        while (!stack.empty())
+        {
+            GameObject *gameObject = stack.back();
+            stack.pop_back();
+            gameObjects.push_back(gameObject);
+            const auto &children = gameObject->GetChildren();
+            stack.insert(stack.end(), children.rbegin(), children.rend());
+        }
+
+        for (GameObject *gameObject : gameObjects)
+        {
+            gameObject->Init();
+        }
+        for (std::size_t i = registeredCount; i < m_allGameObjects.size(); ++i)
         {
-            go->Init();
+            m_allGameObjects[i]->Init();
         }
+        ApplyDeferredChanges();
+        PropagateTransforms();
     }
     void Scene::Update(float dt)
     {
+        {
+            // Structural changes made while iterating are queued and applied together below
+            const CommandBuffer::Scope deferChanges{m_deferredChanges};
+            if (m_isParallelUpdateEnabled && JobSystem::GetInstance().GetWorkerCount() > 0)
+            {
+                UpdateParallelRoots(dt);
+            }
+            else
+            {
+                for (auto &go : m_gameObjects)
+                {
+                    go->Update(dt);
+                }
+            }
+        }
+        ApplyDeferredChanges();
+        PropagateTransforms();
+    }
+    void Scene::FixedUpdate(float fixedDt)
+    {
+        {
+            const CommandBuffer::Scope deferChanges{m_deferredChanges};
+            for (auto &go : m_gameObjects)
+            {
+                go->FixedUpdate(fixedDt);
+            }
+        }
+        // Later steps in the same frame read world positions written by this one
+        ApplyDeferredChanges();
+        PropagateTransforms();
+    }
+    void Scene::UpdateParallelRoots(float dt)
+    {
+        m_parallelRoots.clear();
+        m_serialRoots.clear();
         for (auto &go : m_gameObjects)
+        {
+            (go->IsParallelUpdateSafe() ? m_parallelRoots : m_serialRoots).push_back(go.get());
+        }
+
+        if (m_parallelRoots.size() < MinParallelRoots)
+        {
+            for (auto &go : m_gameObjects)
+            {
+                go->Update(dt);
+            }
+            return;
+        }
+
+        // Parallel phase first and fully joined, so scripts in the serial phase never race with the workers
+        JobSystem &jobSystem = JobSystem::GetInstance();
+        m_commandBuffers.resize(jobSystem.GetThreadCount(), CommandBuffer{CommandBuffer::Mode::Worker});
+        {
+            SPARK_PROFILE_SCOPE("Scene::ParallelUpdate");
+            jobSystem.ParallelFor(0, m_parallelRoots.size(), RootsPerJob, [this, dt](std::size_t begin, std::size_t end)
+                                  {
+                                      CommandBuffer &buffer = m_commandBuffers[JobSystem::GetCurrentThreadIndex()];
+                                      for (std::size_t i = begin; i < end; ++i)
+                                      {
+                                          // One scope per root, a job stolen during its Update restores the key on return
+                                          const CommandBuffer::Scope scope{buffer, static_cast<std::uint32_t>(i)};
+                                          m_parallelRoots[i]->Update(dt);
+                                      } });
+        }
+        // Still inside Update's scope, so these are re-recorded into m_deferredChanges in root order
+        CommandBuffer::Playback(m_commandBuffers);
+
+        for (GameObject *go : m_serialRoots)
         {
             go->Update(dt);
         }
-        DeleteGameObjects();
     }
+
     void Scene::Render()
     {
-        for (auto &go : m_gameObjects)
+        SPARK_PROFILE_SCOPE("Scene::Render");
         {
-            go->Render();
+            const CommandBuffer::Scope deferChanges{m_deferredChanges};
+            CameraComponent *camera = GetCamera();
+            if (camera)
+            {
+                camera->BeginRender();
+            }
+
+            if (camera && camera->IsCullingEnabled())
+            {
+                RenderVisible(camera->GetVisibleWorldBounds());
+            }
+            else
+            {
+                m_lastDrawnCount = 0;
+                m_lastCulledCount = 0;
+                m_lastCachedCount = 0;
+                for (auto &go : m_gameObjects)
+                {
+                    go->Render();
+                }
+            }
+
+            if (camera)
+            {
+                camera->EndRender();
+            }
+            // The scene's layers are sorted among themselves, whatever is drawn afterwards (editor overlays,
+            // debug text) stays on top of them
+            Renderer &renderer = Renderer::GetInstance();
+            renderer.Flush();
+            renderer.SetSortKey({});
         }
+        ApplyDeferredChanges();
     }
     void Scene::RenderImGui()
     {
-        for (auto &go : m_gameObjects)
         {
-            go->RenderImGui();
+            const CommandBuffer::Scope deferChanges{m_deferredChanges};
+            for (auto &go : m_gameObjects)
+            {
+                go->RenderImGui();
+            }
         }
+        ApplyDeferredChanges();
     }
 }
@@ -11,14 +11,10 @@ namespace spark
         ImGui::Text("Hierarchy:");
         ImGui::Separator();
 
-        // Add all gameobjects and their children to the scenegraph
-        const auto &allGameObjects = sceneManager.GetCurrentScene()->GetAllGameObjects();
-        for (const auto &gameObject : allGameObjects)
+        // Add all root gameobjects and, through them, their children to the scenegraph
+        for (const auto &gameObject : sceneManager.GetCurrentScene()->GetRootGameObjects())
         {
-            if (!gameObject->GetParent())
-            {
-                RenderGameObjectNode(gameObject, selectedGameObject);
-            }
+            RenderGameObjectNode(gameObject.get(), selectedGameObject);
         }
         ImGui::End();
     }
@@ -1,4 +1,5 @@
 #include "SceneManager.h"
+#include "Profiler.h"
 
 namespace spark
 {
@@ -16,9 +17,16 @@ namespace spark
 
     void SceneManager::Update(float dt)
     {
+        SPARK_PROFILE_SCOPE("SceneManager::Update");
         m_currentScene->Update(dt);
     }
 
+    void SceneManager::FixedUpdate(float fixedDt)
+    {
+        SPARK_PROFILE_SCOPE("SceneManager::FixedUpdate");
+        m_currentScene->FixedUpdate(fixedDt);
+    }
+
     void SceneManager::Render()
     {
         m_currentScene->Render();
@@ -29,6 +37,14 @@ namespace spark
         m_currentScene->RenderImGui();
     }
 
+    void SceneManager::ReleaseBitmapCaches()
+    {
+        for (const auto &scene : m_Scenes)
+        {
+            scene->ReleaseBitmapCaches();
+        }
+    }
+
     void SceneManager::AddScene(std::unique_ptr<Scene> scene)
     {
         auto it = std::find_if(m_Scenes.begin(), m_Scenes.end(), [&](const std::unique_ptr<Scene> &s)
@@ -0,0 +1,236 @@
+#include "SpatialGrid.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace spark
+{
+    namespace
+    {
+        // Keeps the cell table proportional to the point count when points are spread far apart
+        constexpr std::size_t MinCellBudget = 64;
+        constexpr std::size_t CellsPerPoint = 2;
+    }
+
+    SpatialGrid::SpatialGrid(float cellSize)
+    {
+        SetCellSize(cellSize);
+    }
+
+    void SpatialGrid::SetCellSize(float cellSize)
+    {
+        m_cellSize = cellSize > 0.0f ? cellSize : 1.0f;
+        m_invCellSize = 1.0f / m_cellSize;
+    }
+
+    void SpatialGrid::Clear() noexcept
+    {
+        m_columns = 0;
+        m_rows = 0;
+        m_cellStart.clear();
+        m_sortedIndices.clear();
+        m_sortedPoints.clear();
+    }
+
+    int SpatialGrid::CellX(float x) const noexcept
+    {
+        const float cell = (x - m_originX) * m_invCellSize;
+        // Written so NaN lands in the first cell instead of reaching the int conversion
+        if (!(cell >= 0.0f))
+            return 0;
+        if (cell >= static_cast<float>(m_columns - 1))
+            return m_columns - 1;
+        return static_cast<int>(cell);
+    }
+
+    int SpatialGrid::CellY(float y) const noexcept
+    {
+        const float cell = (y - m_originY) * m_invCellSize;
+        if (!(cell >= 0.0f))
+            return 0;
+        if (cell >= static_cast<float>(m_rows - 1))
+            return m_rows - 1;
+        return static_cast<int>(cell);
+    }
+
+    void SpatialGrid::Build(const float *points, std::size_t count, std::size_t stride)
+    {
+        Clear();
+        if (!points || count == 0 || stride < 2)
+        {
+            return;
+        }
+
+        float minX = std::numeric_limits<float>::max();
+        float minY = std::numeric_limits<float>::max();
+        float maxX = std::numeric_limits<float>::lowest();
+        float maxY = std::numeric_limits<float>::lowest();
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const float x = points[i * stride];
+            const float y = points[i * stride + 1];
+            if (x < minX)
+                minX = x;
+            if (x > maxX)
+                maxX = x;
+            if (y < minY)
+                minY = y;
+            if (y > maxY)
+                maxY = y;
+        }
+        if (minX > maxX || minY > maxY)
+        {
+            // Every point was NaN
+            minX = maxX = minY = maxY = 0.0f;
+        }
+
+        m_originX = minX;
+        m_originY = minY;
+
+        const std::size_t cellBudget = std::max(MinCellBudget, count * CellsPerPoint);
+        double cellSize = m_cellSize;
+        double columns = std::floor((static_cast<double>(maxX) - minX) / cellSize) + 1.0;
+        double rows = std::floor((static_cast<double>(maxY) - minY) / cellSize) + 1.0;
+        while (columns * rows > static_cast<double>(cellBudget))
+        {
+            cellSize *= std::sqrt(columns * rows / static_cast<double>(cellBudget)) * 1.01;
+            columns = std::floor((static_cast<double>(maxX) - minX) / cellSize) + 1.0;
+            rows = std::floor((static_cast<double>(maxY) - minY) / cellSize) + 1.0;
+        }
+
+        // Lookups use the grown size, m_cellSize keeps the requested one for the next build
+        m_invCellSize = static_cast<float>(1.0 / cellSize);
+        m_columns = static_cast<int>(columns);
+        m_rows = static_cast<int>(rows);
+
+        // Counting sort by cell: count, prefix sum, scatter
+        const std::size_t cellCount = static_cast<std::size_t>(m_columns) * m_rows;
+        m_cellStart.assign(cellCount + 1, 0);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            ++m_cellStart[CellIndex(CellX(points[i * stride]), CellY(points[i * stride + 1])) + 1];
+        }
+        for (std::size_t cell = 0; cell < cellCount; ++cell)
+        {
+            m_cellStart[cell + 1] += m_cellStart[cell];
+        }
+
+        m_sortedIndices.resize(count);
+        m_sortedPoints.resize(count * 2);
+        // Scatter with a moving cursor per cell, then restore the starts from the cursors
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const float x = points[i * stride];
+            const float y = points[i * stride + 1];
+            const std::uint32_t slot = m_cellStart[CellIndex(CellX(x), CellY(y))]++;
+            m_sortedIndices[slot] = static_cast<std::uint32_t>(i);
+            m_sortedPoints[slot * 2] = x;
+            m_sortedPoints[slot * 2 + 1] = y;
+        }
+        for (std::size_t cell = cellCount; cell > 0; --cell)
+        {
+            m_cellStart[cell] = m_cellStart[cell - 1];
+        }
+        m_cellStart[0] = 0;
+    }
+
+    std::size_t SpatialGrid::QueryRadius(float x, float y, float radius, std::vector<std::uint32_t> &out, std::uint32_t exclude) const
+    {
+        out.clear();
+        ForEachInRadius(x, y, radius, [&](std::uint32_t index, float)
+                        {
+            if (index != exclude)
+            {
+                out.push_back(index);
+            } });
+        return out.size();
+    }
+
+    std::size_t SpatialGrid::QueryNearest(float x, float y, std::size_t k, std::vector<std::uint32_t> &out,
+                                          std::uint32_t exclude, float maxRadius) const
+    {
+        out.clear();
+        if (k == 0 || m_sortedIndices.empty() || maxRadius < 0.0f)
+        {
+            return 0;
+        }
+
+        // Max-heap of the best k candidates seen so far, keyed on squared distance
+        // thread_local so concurrent queries against the same grid don't share it
+        thread_local std::vector<std::pair<float, std::uint32_t>> best;
+        best.clear();
+        const float maxRadiusSq = maxRadius < std::sqrt(std::numeric_limits<float>::max())
+                                      ? maxRadius * maxRadius
+                                      : std::numeric_limits<float>::max();
+        const float cellSize = 1.0f / m_invCellSize;
+
+        const int centerX = CellX(x);
+        const int centerY = CellY(y);
+        const int maxRing = std::max({centerX, m_columns - 1 - centerX, centerY, m_rows - 1 - centerY});
+
+        auto visitCell = [&](int cx, int cy)
+        {
+            const std::size_t cell = CellIndex(cx, cy);
+            for (std::uint32_t i = m_cellStart[cell]; i < m_cellStart[cell + 1]; ++i)
+            {
+                if (m_sortedIndices[i] == exclude)
+                    continue;
+
+                const float dx = m_sortedPoints[i * 2] - x;
+                const float dy = m_sortedPoints[i * 2 + 1] - y;
+                const float distanceSq = dx * dx + dy * dy;
+                if (distanceSq > maxRadiusSq)
+                    continue;
+
+                if (best.size() < k)
+                {
+                    best.emplace_back(distanceSq, m_sortedIndices[i]);
+                    std::push_heap(best.begin(), best.end());
+                }
+                else if (distanceSq < best.front().first)
+                {
+                    std::pop_heap(best.begin(), best.end());
+                    best.back() = {distanceSq, m_sortedIndices[i]};
+                    std::push_heap(best.begin(), best.end());
+                }
+            }
+        };
+
+        for (int ring = 0; ring <= maxRing; ++ring)
+        {
+            // Anything in this ring or beyond is at least (ring - 1) cells away from the query point
+            const float ringDistance = static_cast<float>(std::max(ring - 1, 0)) * cellSize;
+            if (ringDistance * ringDistance > maxRadiusSq)
+                break;
+            if (best.size() == k && ringDistance * ringDistance > best.front().first)
+                break;
+
+            const int minX = centerX - ring;
+            const int maxX = centerX + ring;
+            const int minY = centerY - ring;
+            const int maxY = centerY + ring;
+            for (int cx = std::max(minX, 0); cx <= std::min(maxX, m_columns - 1); ++cx)
+            {
+                if (minY >= 0)
+                    visitCell(cx, minY);
+                if (ring > 0 && maxY < m_rows)
+                    visitCell(cx, maxY);
+            }
+            for (int cy = std::max(minY + 1, 0); cy <= std::min(maxY - 1, m_rows - 1); ++cy)
+            {
+                if (minX >= 0)
+                    visitCell(minX, cy);
+                if (ring > 0 && maxX < m_columns)
+                    visitCell(maxX, cy);
+            }
+        }
+
+        std::sort_heap(best.begin(), best.end());
+        out.reserve(best.size());
+        for (const auto &[distanceSq, index] : best)
+        {
+            out.push_back(index);
+        }
+        return out.size();
+    }
+} // namespace spark
@@ -0,0 +1,38 @@
+#include "TagRegistry.h"
+#include <cassert>
+#include <iostream>
+
+namespace spark
+{
+    std::size_t TagRegistry::GetTagId(const std::string &tag)
+    {
+        auto it = m_tagIds.find(tag);
+        if (it != m_tagIds.end())
+        {
+            return it->second;
+        }
+
+        if (m_tagNames.size() >= MaxTags)
+        {
+            std::cerr << "Can't add tag \"" << tag << "\", all " << MaxTags << " tags are in use\n";
+            return InvalidTagId;
+        }
+
+        const std::size_t id = m_tagNames.size();
+        m_tagNames.emplace_back(tag);
+        m_tagIds.emplace(tag, id);
+        return id;
+    }
+
+    std::size_t TagRegistry::FindTagId(const std::string &tag) const
+    {
+        auto it = m_tagIds.find(tag);
+        return it != m_tagIds.end() ? it->second : InvalidTagId;
+    }
+
+    const std::string &TagRegistry::GetTagName(std::size_t tagId) const
+    {
+        assert(tagId < m_tagNames.size());
+        return m_tagNames[tagId];
+    }
+} // namespace spark
@@ -0,0 +1,461 @@
+#include "TextRenderer.h"
+#include "Renderer.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <unordered_map>
+
+#define STB_TRUETYPE_IMPLEMENTATION
+#include <stb_truetype.h>
+
+namespace spark
+{
+    namespace
+    {
+        struct StringHash
+        {
+            using is_transparent = void;
+            std::size_t operator()(std::string_view text) const { return std::hash<std::string_view>{}(text); }
+        };
+
+        // Next codepoint of a UTF-8 string, malformed sequences come out as U+FFFD one byte at a time
+        char32_t DecodeUtf8(std::string_view text, std::size_t &i)
+        {
+            const unsigned char lead = static_cast<unsigned char>(text[i++]);
+            if (lead < 0x80)
+                return lead;
+
+            int length = 0;
+            char32_t codepoint = 0;
+            if ((lead & 0xE0) == 0xC0)
+            {
+                length = 1;
+                codepoint = lead & 0x1F;
+            }
+            else if ((lead & 0xF0) == 0xE0)
+            {
+                length = 2;
+                codepoint = lead & 0x0F;
+            }
+            else if ((lead & 0xF8) == 0xF0)
+            {
+                length = 3;
+                codepoint = lead & 0x07;
+            }
+            else
+            {
+                return 0xFFFD;
+            }
+
+            if (i + length > text.size())
+                return 0xFFFD;
+            for (int k = 0; k < length; ++k)
+            {
+                const unsigned char next = static_cast<unsigned char>(text[i + k]);
+                if ((next & 0xC0) != 0x80)
+                    return 0xFFFD;
+                codepoint = (codepoint << 6) | (next & 0x3F);
+            }
+            i += length;
+            return codepoint;
+        }
+    }
+
+    struct TextRenderer::Glyph
+    {
+        int index{0};
+        float advance{0.0f};
+        SDL_FRect box{}; // relative to the pen, y from the top of the line
+        SDL_FRect uv{};
+        int page{-1}; // -1 for glyphs with nothing to draw, like spaces
+    };
+
+    struct TextRenderer::TextRun
+    {
+        struct Quad
+        {
+            SDL_FRect box;
+            SDL_FRect uv;
+            int page;
+        };
+
+        // Grouped by page, so each page is one AllocateQuads call
+        std::vector<Quad> quads;
+        SDL_FPoint size{};
+        std::uint64_t lastUsedFrame{0};
+    };
+
+    struct TextRenderer::FontData
+    {
+        std::string path;
+        float pixelHeight{0.0f};
+        // stb_truetype reads straight from here, it must not move
+        std::vector<unsigned char> file;
+        stbtt_fontinfo info{};
+        float scale{0.0f};
+        float ascent{0.0f};
+        float lineHeight{0.0f};
+
+        std::unordered_map<char32_t, Glyph> glyphs;
+        std::unordered_map<std::string, TextRun, StringHash, std::equal_to<>> runs;
+    };
+
+    TextRenderer::TextRenderer() = default;
+
+    TextRenderer::~TextRenderer() = default;
+
+    TextRenderer::FontId TextRenderer::LoadFont(const std::string &path, float pixelHeight)
+    {
+        for (std::size_t i = 0; i < m_fonts.size(); ++i)
+        {
+            if (m_fonts[i]->path == path && m_fonts[i]->pixelHeight == pixelHeight)
+            {
+                return static_cast<FontId>(i);
+            }
+        }
+
+        if (pixelHeight <= 0.0f)
+        {
+            std::cerr << "Invalid font size " << pixelHeight << " for " << path << "\n";
+            return InvalidFontId;
+        }
+
+        std::ifstream stream(path, std::ios::binary);
+        if (!stream.is_open())
+        {
+            std::cerr << "Failed to open font file: " << path << "\n";
+            return InvalidFontId;
+        }
+
+        auto font = std::make_unique<FontData>();
+        font->path = path;
+        font->pixelHeight = pixelHeight;
+        font->file.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+        const int offset = stbtt_GetFontOffsetForIndex(font->file.data(), 0);
+        if (font->file.empty() || offset < 0 || !stbtt_InitFont(&font->info, font->file.data(), offset))
+        {
+            std::cerr << "Failed to load font: " << path << "\n";
+            return InvalidFontId;
+        }
+
+        int ascent = 0;
+        int descent = 0;
+        int lineGap = 0;
+        stbtt_GetFontVMetrics(&font->info, &ascent, &descent, &lineGap);
+        font->scale = stbtt_ScaleForPixelHeight(&font->info, pixelHeight);
+        font->ascent = std::round(ascent * font->scale);
+        font->lineHeight = std::round((ascent - descent + lineGap) * font->scale);
+
+        m_fonts.push_back(std::move(font));
+        return static_cast<FontId>(m_fonts.size() - 1);
+    }
+
+    TextRenderer::FontId TextRenderer::GetDefaultFont()
+    {
+        // A missing default font is reported once, not every time text is drawn
+        if (m_defaultFont == InvalidFontId && !m_defaultFontFailed)
+        {
+            m_defaultFont = LoadFont(DefaultFontPath, DefaultFontSize);
+            m_defaultFontFailed = m_defaultFont == InvalidFontId;
+        }
+        return m_defaultFont;
+    }
+
+    bool TextRenderer::DrawText(FontId font, std::string_view text, float x, float y)
+    {
+        SDL_FColor color{1.0f, 1.0f, 1.0f, 1.0f};
+        Renderer::GetInstance().GetDrawColorFloat(&color.r, &color.g, &color.b, &color.a);
+        return DrawText(font, text, x, y, color);
+    }
+
+    bool TextRenderer::DrawText(FontId font, std::string_view text, float x, float y, const SDL_FColor &color)
+    {
+        FontData *data = Find(font);
+        if (!data)
+        {
+            return false;
+        }
+        if (text.empty())
+        {
+            return true;
+        }
+
+        const TextRun *run = GetRun(*data, text);
+        Renderer &renderer = Renderer::GetInstance();
+
+        // Glyphs are rasterized on whole pixels, keep them there so they stay sharp
+        x = std::round(x);
+        y = std::round(y);
+
+        const std::size_t quadCount = run->quads.size();
+        std::size_t first = 0;
+        while (first < quadCount)
+        {
+            const int page = run->quads[first].page;
+            std::size_t last = first + 1;
+            while (last < quadCount && run->quads[last].page == page)
+            {
+                ++last;
+            }
+
+            SDL_Vertex *vertices = renderer.AllocateQuads(m_pages[page].texture, static_cast<int>(last - first));
+            for (std::size_t i = first; i < last; ++i, vertices += 4)
+            {
+                const TextRun::Quad &quad = run->quads[i];
+                const float left = x + quad.box.x;
+                const float top = y + quad.box.y;
+                const float right = left + quad.box.w;
+                const float bottom = top + quad.box.h;
+                const float u1 = quad.uv.x + quad.uv.w;
+                const float v1 = quad.uv.y + quad.uv.h;
+                vertices[0] = {{left, top}, color, {quad.uv.x, quad.uv.y}};
+                vertices[1] = {{right, top}, color, {u1, quad.uv.y}};
+                vertices[2] = {{right, bottom}, color, {u1, v1}};
+                vertices[3] = {{left, bottom}, color, {quad.uv.x, v1}};
+            }
+            first = last;
+        }
+        return true;
+    }
+
+    SDL_FPoint TextRenderer::MeasureText(FontId font, std::string_view text)
+    {
+        FontData *data = Find(font);
+        if (!data || text.empty())
+        {
+            return SDL_FPoint{0.0f, 0.0f};
+        }
+        return GetRun(*data, text)->size;
+    }
+
+    float TextRenderer::GetLineHeight(FontId font) const
+    {
+        const FontData *data = Find(font);
+        return data ? data->lineHeight : 0.0f;
+    }
+
+    void TextRenderer::Update()
+    {
+        ++m_frame;
+        // Checking every run each frame would cost more than the few stale ones are worth
+        if (m_frame % 60 != 0)
+        {
+            return;
+        }
+
+        SPARK_PROFILE_SCOPE("TextRenderer::Update");
+        for (auto &font : m_fonts)
+        {
+            std::erase_if(font->runs, [this](const auto &entry)
+                          { return entry.second.lastUsedFrame + RunLifetime < m_frame; });
+        }
+    }
+
+    void TextRenderer::Clear()
+    {
+        for (GlyphPage &page : m_pages)
+        {
+            SDL_DestroyTexture(page.texture);
+        }
+        m_pages.clear();
+
+        // Everything cached points into the pages
+        for (auto &font : m_fonts)
+        {
+            font->glyphs.clear();
+            font->runs.clear();
+        }
+    }
+
+    std::size_t TextRenderer::GetCachedRunCount() const
+    {
+        std::size_t count = 0;
+        for (const auto &font : m_fonts)
+        {
+            count += font->runs.size();
+        }
+        return count;
+    }
+
+    TextRenderer::FontData *TextRenderer::Find(FontId font) const
+    {
+        return font < m_fonts.size() ? m_fonts[font].get() : nullptr;
+    }
+
+    TextRenderer::TextRun *TextRenderer::GetRun(FontData &font, std::string_view text)
+    {
+        if (auto it = font.runs.find(text); it != font.runs.end())
+        {
+            it->second.lastUsedFrame = m_frame;
+            return &it->second;
+        }
+
+        SPARK_PROFILE_SCOPE("TextRenderer::Layout");
+        TextRun run;
+        run.lastUsedFrame = m_frame;
+
+        float penX = 0.0f;
+        float penY = 0.0f;
+        float width = 0.0f;
+        int previous = -1;
+        std::size_t i = 0;
+        while (i < text.size())
+        {
+            const char32_t codepoint = DecodeUtf8(text, i);
+            if (codepoint == U'\n')
+            {
+                width = std::max(width, penX);
+                penX = 0.0f;
+                penY += font.lineHeight;
+                previous = -1;
+                continue;
+            }
+            if (codepoint == U'\r')
+            {
+                continue;
+            }
+            if (codepoint == U'\t')
+            {
+                penX += GetGlyph(font, U' ').advance * 4.0f;
+                previous = -1;
+                continue;
+            }
+
+            const Glyph &glyph = GetGlyph(font, codepoint);
+            if (previous >= 0)
+            {
+                penX += stbtt_GetGlyphKernAdvance(&font.info, previous, glyph.index) * font.scale;
+            }
+            if (glyph.page >= 0)
+            {
+                const SDL_FRect box{std::round(penX + glyph.box.x), penY + glyph.box.y, glyph.box.w, glyph.box.h};
+                run.quads.push_back(TextRun::Quad{box, glyph.uv, glyph.page});
+            }
+            penX += glyph.advance;
+            previous = glyph.index;
+        }
+        run.size = SDL_FPoint{std::max(width, penX), penY + font.lineHeight};
+
+        std::stable_sort(run.quads.begin(), run.quads.end(), [](const TextRun::Quad &a, const TextRun::Quad &b)
+                         { return a.page < b.page; });
+        run.quads.shrink_to_fit();
+        return &font.runs.emplace(std::string(text), std::move(run)).first->second;
+    }
+
+    const TextRenderer::Glyph &TextRenderer::GetGlyph(FontData &font, char32_t codepoint)
+    {
+        auto [it, isNew] = font.glyphs.try_emplace(codepoint);
+        Glyph &glyph = it->second;
+        if (!isNew)
+        {
+            return glyph;
+        }
+
+        glyph.index = stbtt_FindGlyphIndex(&font.info, static_cast<int>(codepoint));
+        int advance = 0;
+        int leftBearing = 0;
+        stbtt_GetGlyphHMetrics(&font.info, glyph.index, &advance, &leftBearing);
+        glyph.advance = advance * font.scale;
+
+        int x0 = 0;
+        int y0 = 0;
+        int x1 = 0;
+        int y1 = 0;
+        stbtt_GetGlyphBitmapBox(&font.info, glyph.index, font.scale, font.scale, &x0, &y0, &x1, &y1);
+        const int width = x1 - x0;
+        const int height = y1 - y0;
+        if (width <= 0 || height <= 0)
+        {
+            return glyph;
+        }
+
+        // White with coverage as alpha, so the vertex color tints it. The transparent border keeps linear
+        // filtering from bleeding in the neighbouring glyphs.
+        const int paddedWidth = width + 2;
+        const int paddedHeight = height + 2;
+        std::vector<unsigned char> coverage(static_cast<std::size_t>(width) * height);
+        stbtt_MakeGlyphBitmap(&font.info, coverage.data(), width, height, width, font.scale, font.scale, glyph.index);
+        std::vector<std::uint8_t> pixels(static_cast<std::size_t>(paddedWidth) * paddedHeight * 4, 0);
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                std::uint8_t *pixel = pixels.data() + (static_cast<std::size_t>(y + 1) * paddedWidth + x + 1) * 4;
+                pixel[0] = 255;
+                pixel[1] = 255;
+                pixel[2] = 255;
+                pixel[3] = coverage[static_cast<std::size_t>(y) * width + x];
+            }
+        }
+
+        int page = -1;
+        SDL_Rect rect{};
+        if (!AllocateInPage(paddedWidth, paddedHeight, page, rect))
+        {
+            std::cerr << "No room for glyph " << static_cast<std::uint32_t>(codepoint) << " of " << font.path << "\n";
+            return glyph;
+        }
+        SDL_UpdateTexture(m_pages[page].texture, &rect, pixels.data(), paddedWidth * 4);
+
+        constexpr float texel = 1.0f / PageSize;
+        glyph.page = page;
+        glyph.box = SDL_FRect{static_cast<float>(x0), font.ascent + y0, static_cast<float>(width), static_cast<float>(height)};
+        glyph.uv = SDL_FRect{(rect.x + 1) * texel, (rect.y + 1) * texel, width * texel, height * texel};
+        return glyph;
+    }
+
+    bool TextRenderer::AllocateInPage(int width, int height, int &page, SDL_Rect &rect)
+    {
+        if (width > PageSize || height > PageSize)
+        {
+            return false;
+        }
+
+        // Same shelf packing as the texture atlas, glyphs are never freed so pages only fill up
+        const auto tryPage = [&](GlyphPage &glyphPage) -> bool
+        {
+            int x = glyphPage.shelfX;
+            int y = glyphPage.shelfY;
+            int shelfHeight = glyphPage.shelfHeight;
+            if (x + width > PageSize)
+            {
+                x = 0;
+                y += shelfHeight;
+                shelfHeight = 0;
+            }
+            if (y + height > PageSize)
+            {
+                return false;
+            }
+
+            glyphPage.shelfX = x + width;
+            glyphPage.shelfY = y;
+            glyphPage.shelfHeight = std::max(shelfHeight, height);
+            rect = SDL_Rect{x, y, width, height};
+            return true;
+        };
+
+        // Only the newest page is tried, older ones were too full for some glyph already
+        if (!m_pages.empty() && tryPage(m_pages.back()))
+        {
+            page = static_cast<int>(m_pages.size() - 1);
+            return true;
+        }
+
+        SDL_Texture *texture = SDL_CreateTexture(Renderer::GetInstance().GetSDLRenderer(), SDL_PIXELFORMAT_RGBA32,
+                                                 SDL_TEXTUREACCESS_STATIC, PageSize, PageSize);
+        if (!texture)
+        {
+            std::cerr << "Failed to create a glyph page: " << SDL_GetError() << "\n";
+            return false;
+        }
+        SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+        m_pages.push_back(GlyphPage{texture});
+        page = static_cast<int>(m_pages.size() - 1);
+        return tryPage(m_pages.back());
+    }
+} // namespace spark
@@ -0,0 +1,424 @@
+#include "TextureCache.h"
+#include "JobSystem.h"
+#include "Renderer.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_FAILURE_USERMSG
+#include <stb_image.h>
+
+namespace spark
+{
+    TextureCache::TextureCache() = default;
+
+    TextureCache::~TextureCache()
+    {
+        // Without Clear the job system may already be gone, so loads still in flight can't be waited on.
+        // Their tasks are leaked rather than freed under a running job.
+        for (TextureId id : m_loading)
+        {
+            static_cast<void>(m_entries[id].task.release());
+        }
+    }
+
+    TextureCache::TextureId TextureCache::Acquire(const std::string &path)
+    {
+        if (auto it = m_idsByPath.find(path); it != m_idsByPath.end())
+        {
+            ++m_entries[it->second].references;
+            return it->second;
+        }
+
+        TextureId id;
+        if (!m_freeEntries.empty())
+        {
+            id = m_freeEntries.back();
+            m_freeEntries.pop_back();
+        }
+        else
+        {
+            id = static_cast<TextureId>(m_entries.size());
+            m_entries.emplace_back();
+        }
+
+        Entry &entry = m_entries[id];
+        entry.path = path;
+        entry.references = 1;
+        entry.state = State::Loading;
+        m_idsByPath.emplace(path, id);
+        m_loading.push_back(id);
+        StartDecode(entry);
+        return id;
+    }
+
+    void TextureCache::AddReference(TextureId id)
+    {
+        if (Entry *entry = Find(id))
+        {
+            ++entry->references;
+        }
+    }
+
+    void TextureCache::Release(TextureId id)
+    {
+        Entry *entry = Find(id);
+        if (!entry || --entry->references > 0)
+        {
+            return;
+        }
+
+        // The path is free for a fresh load right away, a decode still running is discarded by Update
+        m_idsByPath.erase(entry->path);
+        if (entry->state != State::Loading)
+        {
+            FreeEntry(id);
+        }
+    }
+
+    bool TextureCache::IsReady(TextureId id) const
+    {
+        return GetRegion(id) != nullptr;
+    }
+
+    bool TextureCache::HasFailed(TextureId id) const
+    {
+        const Entry *entry = Find(id);
+        return entry && entry->state == State::Failed;
+    }
+
+    const TextureRegion *TextureCache::GetRegion(TextureId id) const
+    {
+        const Entry *entry = Find(id);
+        return (entry && entry->state == State::Ready && entry->region.texture) ? &entry->region : nullptr;
+    }
+
+    void TextureCache::Update()
+    {
+        if (m_loading.empty())
+        {
+            return;
+        }
+
+        SPARK_PROFILE_SCOPE("TextureCache::Update");
+        JobSystem &jobSystem = JobSystem::GetInstance();
+        std::size_t i = 0;
+        while (i < m_loading.size())
+        {
+            const TextureId id = m_loading[i];
+            // Without workers nobody else would ever run the decode, so it happens here
+            if (jobSystem.GetWorkerCount() == 0)
+            {
+                jobSystem.Wait(*m_entries[id].task->counter);
+            }
+            // Upload destroys the task and its counter, which the decode job may still be holding the lock of
+            if (!m_entries[id].task->counter->IsReleasable())
+            {
+                ++i;
+                continue;
+            }
+
+            m_loading[i] = m_loading.back();
+            m_loading.pop_back();
+            Upload(m_entries[id]);
+            if (m_entries[id].references == 0)
+            {
+                FreeEntry(id);
+            }
+        }
+    }
+
+    void TextureCache::Wait(TextureId id)
+    {
+        Entry *entry = Find(id);
+        if (!entry || entry->state != State::Loading)
+        {
+            return;
+        }
+
+        JobSystem::GetInstance().Wait(*entry->task->counter);
+        std::erase(m_loading, id);
+        Upload(*entry);
+    }
+
+    void TextureCache::Clear()
+    {
+        for (TextureId id : m_loading)
+        {
+            JobSystem::GetInstance().Wait(*m_entries[id].task->counter);
+        }
+        // Every decode has finished, IsReleasable can only fail spuriously here
+        while (!m_loading.empty())
+        {
+            Update();
+        }
+
+        // Entries stay, Textures held by scripts simply stop drawing
+        for (Entry &entry : m_entries)
+        {
+            if (entry.page < 0 && entry.region.texture)
+            {
+                SDL_DestroyTexture(entry.region.texture);
+            }
+            entry.region.texture = nullptr;
+            entry.page = -1;
+        }
+        for (AtlasPage &page : m_pages)
+        {
+            SDL_DestroyTexture(page.texture);
+        }
+        m_pages.clear();
+    }
+
+    TextureCache::Entry *TextureCache::Find(TextureId id)
+    {
+        return (id < m_entries.size() && !m_entries[id].path.empty()) ? &m_entries[id] : nullptr;
+    }
+
+    const TextureCache::Entry *TextureCache::Find(TextureId id) const
+    {
+        return (id < m_entries.size() && !m_entries[id].path.empty()) ? &m_entries[id] : nullptr;
+    }
+
+    void TextureCache::StartDecode(Entry &entry)
+    {
+        entry.task = std::make_unique<DecodeTask>();
+        entry.task->path = entry.path;
+        entry.task->counter = std::make_unique<JobCounter>();
+
+        // The task is owned by the entry, which stays put until the counter reports the job done
+        DecodeTask *task = entry.task.get();
+        const int maxAtlasedSize = std::min(m_maxAtlasedSize, m_atlasPageSize - 2);
+        // In the background, a decode can take longer than a frame and must not land on a thread waiting on frame work
+        JobSystem::GetInstance().ScheduleBackground([task, maxAtlasedSize]()
+                                                    { Decode(*task, maxAtlasedSize); }, *task->counter);
+    }
+
+    void TextureCache::Upload(Entry &entry)
+    {
+        std::unique_ptr<DecodeTask> task = std::move(entry.task);
+        if (!task->isDecoded)
+        {
+            std::cerr << "Failed to load texture " << entry.path << ": " << task->error << "\n";
+            entry.state = State::Failed;
+            return;
+        }
+        if (entry.references == 0)
+        {
+            return;
+        }
+
+        const int border = task->isPadded ? 1 : 0;
+        const int width = task->width + border * 2;
+        const int height = task->height + border * 2;
+
+        int page = -1;
+        SDL_Rect rect{0, 0, width, height};
+        SDL_Texture *texture = nullptr;
+        if (task->isPadded && AllocateInAtlas(width, height, page, rect))
+        {
+            texture = m_pages[page].texture;
+            ++m_pages[page].images;
+        }
+        else
+        {
+            texture = SDL_CreateTexture(Renderer::GetInstance().GetSDLRenderer(), SDL_PIXELFORMAT_RGBA32,
+                                        SDL_TEXTUREACCESS_STATIC, width, height);
+            if (!texture)
+            {
+                std::cerr << "Failed to create texture for " << entry.path << ": " << SDL_GetError() << "\n";
+                entry.state = State::Failed;
+                return;
+            }
+            SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+        }
+
+        SDL_UpdateTexture(texture, &rect, task->pixels.data(), width * 4);
+        entry.page = page;
+        entry.region.texture = texture;
+        entry.region.rect = SDL_FRect{static_cast<float>(rect.x + border), static_cast<float>(rect.y + border),
+                                      static_cast<float>(task->width), static_cast<float>(task->height)};
+        entry.state = State::Ready;
+    }
+
+    bool TextureCache::AllocateInAtlas(int width, int height, int &page, SDL_Rect &rect)
+    {
+        const auto tryPage = [&](AtlasPage &atlas) -> bool
+        {
+            int x = atlas.shelfX;
+            int y = atlas.shelfY;
+            int shelfHeight = atlas.shelfHeight;
+            if (x + width > atlas.size)
+            {
+                x = 0;
+                y += shelfHeight;
+                shelfHeight = 0;
+            }
+            if (width > atlas.size || y + height > atlas.size)
+            {
+                return false;
+            }
+
+            atlas.shelfX = x + width;
+            atlas.shelfY = y;
+            atlas.shelfHeight = std::max(shelfHeight, height);
+            rect = SDL_Rect{x, y, width, height};
+            return true;
+        };
+
+        for (std::size_t i = 0; i < m_pages.size(); ++i)
+        {
+            if (tryPage(m_pages[i]))
+            {
+                page = static_cast<int>(i);
+                return true;
+            }
+        }
+
+        SDL_Texture *texture = SDL_CreateTexture(Renderer::GetInstance().GetSDLRenderer(), SDL_PIXELFORMAT_RGBA32,
+                                                 SDL_TEXTUREACCESS_STATIC, m_atlasPageSize, m_atlasPageSize);
+        if (!texture)
+        {
+            std::cerr << "Failed to create a texture atlas page: " << SDL_GetError() << "\n";
+            return false;
+        }
+        SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+        m_pages.push_back(AtlasPage{texture, m_atlasPageSize});
+        page = static_cast<int>(m_pages.size() - 1);
+        return tryPage(m_pages.back());
+    }
+
+    void TextureCache::Decode(DecodeTask &task, int maxAtlasedSize)
+    {
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        stbi_uc *data = stbi_load(task.path.c_str(), &width, &height, &channels, 4);
+        if (!data)
+        {
+            task.error = stbi_failure_reason();
+            return;
+        }
+
+        task.width = width;
+        task.height = height;
+        task.isPadded = width <= maxAtlasedSize && height <= maxAtlasedSize;
+        if (!task.isPadded)
+        {
+            task.pixels.assign(data, data + static_cast<std::size_t>(width) * height * 4);
+        }
+        else
+        {
+            const int paddedWidth = width + 2;
+            task.pixels.resize(static_cast<std::size_t>(paddedWidth) * (height + 2) * 4);
+            for (int y = 0; y < height + 2; ++y)
+            {
+                const stbi_uc *source = data + static_cast<std::size_t>(std::clamp(y - 1, 0, height - 1)) * width * 4;
+                std::uint8_t *row = task.pixels.data() + static_cast<std::size_t>(y) * paddedWidth * 4;
+                std::memcpy(row + 4, source, static_cast<std::size_t>(width) * 4);
+                std::memcpy(row, source, 4);
+                std::memcpy(row + static_cast<std::size_t>(width + 1) * 4, source + static_cast<std::size_t>(width - 1) * 4, 4);
+            }
+        }
+        stbi_image_free(data);
+        task.isDecoded = true;
+    }
+
+    void TextureCache::FreeEntry(TextureId id)
+    {
+        Entry &entry = m_entries[id];
+        if (entry.page >= 0)
+        {
+            // Shelves can't hand back single rectangles, a page is only reused once it's empty
+            AtlasPage &page = m_pages[entry.page];
+            if (--page.images == 0)
+            {
+                page.shelfX = 0;
+                page.shelfY = 0;
+                page.shelfHeight = 0;
+            }
+        }
+        else if (entry.region.texture)
+        {
+            SDL_DestroyTexture(entry.region.texture);
+        }
+
+        entry = Entry{};
+        m_freeEntries.push_back(id);
+    }
+
+    Texture::Texture(const std::string &path) : m_id{TextureCache::GetInstance().Acquire(path)}
+    {
+    }
+
+    Texture::~Texture()
+    {
+        if (IsValid())
+        {
+            TextureCache::GetInstance().Release(m_id);
+        }
+    }
+
+    Texture::Texture(const Texture &other) : m_id{other.m_id}
+    {
+        if (IsValid())
+        {
+            TextureCache::GetInstance().AddReference(m_id);
+        }
+    }
+
+    Texture::Texture(Texture &&other) noexcept : m_id{std::exchange(other.m_id, TextureCache::InvalidTextureId)}
+    {
+    }
+
+    Texture &Texture::operator=(const Texture &other)
+    {
+        if (this != &other)
+        {
+            Texture copy{other};
+            std::swap(m_id, copy.m_id);
+        }
+        return *this;
+    }
+
+    Texture &Texture::operator=(Texture &&other) noexcept
+    {
+        std::swap(m_id, other.m_id);
+        return *this;
+    }
+
+    bool Texture::IsReady() const
+    {
+        return TextureCache::GetInstance().IsReady(m_id);
+    }
+
+    bool Texture::HasFailed() const
+    {
+        return TextureCache::GetInstance().HasFailed(m_id);
+    }
+
+    const TextureRegion *Texture::GetRegion() const
+    {
+        return TextureCache::GetInstance().GetRegion(m_id);
+    }
+
+    float Texture::GetWidth() const
+    {
+        const TextureRegion *region = GetRegion();
+        return region ? region->rect.w : 0.0f;
+    }
+
+    float Texture::GetHeight() const
+    {
+        const TextureRegion *region = GetRegion();
+        return region ? region->rect.h : 0.0f;
+    }
+
+    void Texture::Wait() const
+    {
+        TextureCache::GetInstance().Wait(m_id);
+    }
+} // namespace spark
@@ -0,0 +1,193 @@
+#include "TraceRecorder.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten.h>
+#endif
+
+namespace spark
+{
+    namespace
+    {
+        void WriteJsonString(std::ostream &out, const char *text)
+        {
+            out << '"';
+            for (const char *c = text; *c; ++c)
+            {
+                switch (*c)
+                {
+                case '"':
+                    out << "\\\"";
+                    break;
+                case '\\':
+                    out << "\\\\";
+                    break;
+                case '\n':
+                    out << "\\n";
+                    break;
+                case '\t':
+                    out << "\\t";
+                    break;
+                default:
+                    if (static_cast<unsigned char>(*c) < 0x20)
+                    {
+                        out << ' ';
+                    }
+                    else
+                    {
+                        out << *c;
+                    }
+                    break;
+                }
+            }
+            out << '"';
+        }
+
+        // Trace timestamps are microseconds, kept fractional so short zones don't collapse to 0
+        void WriteMicroseconds(std::ostream &out, std::uint64_t ns)
+        {
+            out << ns / 1000 << '.';
+            const std::uint64_t fraction = ns % 1000;
+            out << static_cast<char>('0' + fraction / 100) << static_cast<char>('0' + fraction / 10 % 10) << static_cast<char>('0' + fraction % 10);
+        }
+    }
+
+    void TraceRecorder::StartCapture(std::size_t frameCount, const std::string &fileName)
+    {
+        if (IsCapturing() || frameCount == 0)
+        {
+            return;
+        }
+
+        Profiler &profiler = Profiler::GetInstance();
+        // Recording has to be on for the whole capture, the user's setting is restored afterwards
+        m_wasProfilerEnabled = profiler.IsEnabled();
+        profiler.SetEnabled(true);
+
+        m_framesRemaining = frameCount;
+        // The frame currently running may have started before recording was switched on, skip it
+        m_nextFrameIndex = profiler.GetFrameCount() + 1;
+        m_fileName = fileName.empty() ? DefaultFileName : fileName;
+        m_frames.clear();
+        m_zones.clear();
+        std::cout << "Capturing trace of " << frameCount << " frames\n";
+    }
+
+    void TraceRecorder::CollectFrame()
+    {
+        if (!IsCapturing())
+        {
+            return;
+        }
+
+        const Profiler &profiler = Profiler::GetInstance();
+        const std::uint64_t frameCount = profiler.GetFrameCount();
+        // Frames published since the last call, oldest first, as long as the ring still holds them
+        std::uint64_t frameIndex = std::max(m_nextFrameIndex, frameCount > Profiler::FrameHistory ? frameCount - Profiler::FrameHistory : 0);
+        for (; frameIndex < frameCount && m_framesRemaining > 0; ++frameIndex)
+        {
+            const ProfileFrame &frame = profiler.GetFrame(frameIndex);
+            m_frames.push_back(CapturedFrame{frame.frameIndex, frame.startNs, frame.endNs, m_zones.size(), frame.zones.size()});
+            m_zones.insert(m_zones.end(), frame.zones.begin(), frame.zones.end());
+            --m_framesRemaining;
+        }
+        m_nextFrameIndex = std::max(m_nextFrameIndex, frameIndex);
+
+        if (m_framesRemaining == 0)
+        {
+            Profiler::GetInstance().SetEnabled(m_wasProfilerEnabled);
+            Save();
+        }
+    }
+
+    void TraceRecorder::WriteChromeTrace(std::ostream &out) const
+    {
+        const std::uint64_t originNs = m_frames.empty() ? 0 : m_frames.front().startNs;
+        // Name only the threads that recorded something, so short-lived ones don't leave empty tracks
+        std::vector<bool> hasZones(1, true);
+        for (const ProfileZone &zone : m_zones)
+        {
+            if (zone.threadIndex >= hasZones.size())
+                hasZones.resize(zone.threadIndex + 1, false);
+            hasZones[zone.threadIndex] = true;
+        }
+
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        out << "{\"ph\":\"M\",\"pid\":1,\"tid\":0,\"name\":\"process_name\",\"args\":{\"name\":\"Spark\"}}";
+        for (std::uint32_t thread = 0; thread < hasZones.size(); ++thread)
+        {
+            if (!hasZones[thread])
+                continue;
+            out << ",\n{\"ph\":\"M\",\"pid\":1,\"tid\":" << thread << ",\"name\":\"thread_name\",\"args\":{\"name\":\"";
+            if (thread == 0)
+                out << "Main";
+            else
+                out << "Thread " << thread;
+            out << "\"}}";
+        }
+
+        for (const CapturedFrame &frame : m_frames)
+        {
+            // Frames go on the main thread track, enclosing that frame's zones
+            out << ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":0,\"cat\":\"frame\",\"name\":\"Frame\",\"ts\":";
+            WriteMicroseconds(out, frame.startNs - std::min(frame.startNs, originNs));
+            out << ",\"dur\":";
+            WriteMicroseconds(out, frame.endNs - std::min(frame.endNs, frame.startNs));
+            out << ",\"args\":{\"frame\":" << frame.frameIndex << "}}";
+
+            for (std::size_t i = frame.firstZone; i < frame.firstZone + frame.zoneCount; ++i)
+            {
+                const ProfileZone &zone = m_zones[i];
+                out << ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":" << zone.threadIndex << ",\"cat\":\"engine\",\"name\":";
+                WriteJsonString(out, Profiler::GetInstance().GetLabelName(zone.label));
+                out << ",\"ts\":";
+                WriteMicroseconds(out, zone.startNs - std::min(zone.startNs, originNs));
+                out << ",\"dur\":";
+                WriteMicroseconds(out, zone.endNs - std::min(zone.endNs, zone.startNs));
+                out << '}';
+            }
+        }
+        out << "\n]}\n";
+    }
+
+    bool TraceRecorder::Save() const
+    {
+#ifdef __EMSCRIPTEN__
+        std::ostringstream json;
+        WriteChromeTrace(json);
+        const std::string text = json.str();
+        // No file system worth writing to in the browser, offer the trace as a download instead
+        EM_ASM({
+            const blob = new Blob([UTF8ToString($0, $1)], {type : 'application/json'});
+            const link = document.createElement('a');
+            link.href = URL.createObjectURL(blob);
+            link.download = UTF8ToString($2);
+            document.body.appendChild(link);
+            link.click();
+            document.body.removeChild(link);
+            setTimeout(() => URL.revokeObjectURL(link.href), 0);
+        },
+               text.data(), text.size(), m_fileName.c_str());
+        std::cout << "Trace of " << m_frames.size() << " frames offered as download " << m_fileName << "\n";
+        return true;
+#else
+        std::ofstream file(m_fileName);
+        if (!file.is_open())
+        {
+            std::cerr << "TraceRecorder: failed to open " << m_fileName << " for writing\n";
+            return false;
+        }
+        WriteChromeTrace(file);
+        if (file.fail())
+        {
+            std::cerr << "TraceRecorder: failed to write " << m_fileName << "\n";
+            return false;
+        }
+        std::cout << "Trace of " << m_frames.size() << " frames written to " << m_fileName << "\n";
+        return true;
+#endif
+    }
+} // namespace spark
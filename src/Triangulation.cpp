@@ -0,0 +1,94 @@
+#include "Triangulation.h"
+#include <cstddef>
+
+namespace spark
+{
+    namespace
+    {
+        float Cross(const glm::vec2 &a, const glm::vec2 &b)
+        {
+            return a.x * b.y - a.y * b.x;
+        }
+
+        bool IsInTriangle(const glm::vec2 &p, const glm::vec2 &a, const glm::vec2 &b, const glm::vec2 &c)
+        {
+            return Cross(b - a, p - a) >= 0.0f && Cross(c - b, p - b) >= 0.0f && Cross(a - c, p - c) >= 0.0f;
+        }
+    }
+
+    void TriangulatePolygon(const std::vector<glm::vec2> &points, int base, std::vector<int> &indices)
+    {
+        if (points.size() < 3)
+        {
+            return;
+        }
+
+        // Walk the outline in the winding where a convex corner has a positive cross product
+        float area = 0.0f;
+        for (std::size_t i = 0, j = points.size() - 1; i < points.size(); j = i++)
+        {
+            area += Cross(points[j], points[i]);
+        }
+        std::vector<int> remaining(points.size());
+        for (std::size_t i = 0; i < points.size(); ++i)
+        {
+            remaining[i] = static_cast<int>(area >= 0.0f ? i : points.size() - 1 - i);
+        }
+
+        const auto isConvexCorner = [&](std::size_t i)
+        {
+            const std::size_t count = remaining.size();
+            const glm::vec2 &a = points[remaining[(i + count - 1) % count]];
+            const glm::vec2 &b = points[remaining[i]];
+            const glm::vec2 &c = points[remaining[(i + 1) % count]];
+            return Cross(b - a, c - b) >= 0.0f;
+        };
+
+        // Circles, rects and most hand-made shapes are convex and become a fan
+        bool isConvex = true;
+        for (std::size_t i = 0; i < remaining.size() && isConvex; ++i)
+        {
+            isConvex = isConvexCorner(i);
+        }
+
+        // Otherwise clip ears, which is quadratic but only runs when the path changes
+        std::size_t attempts = 0;
+        std::size_t i = 0;
+        while (!isConvex && remaining.size() > 3 && attempts < remaining.size())
+        {
+            const std::size_t count = remaining.size();
+            const std::size_t previous = (i + count - 1) % count;
+            const std::size_t next = (i + 1) % count;
+            bool isEar = isConvexCorner(i);
+            for (std::size_t k = 0; k < count && isEar; ++k)
+            {
+                if (k != previous && k != i && k != next)
+                {
+                    isEar = !IsInTriangle(points[remaining[k]], points[remaining[previous]], points[remaining[i]], points[remaining[next]]);
+                }
+            }
+
+            if (!isEar)
+            {
+                i = next;
+                ++attempts;
+                continue;
+            }
+
+            indices.push_back(base + remaining[previous]);
+            indices.push_back(base + remaining[i]);
+            indices.push_back(base + remaining[next]);
+            remaining.erase(remaining.begin() + static_cast<std::ptrdiff_t>(i));
+            i = i % remaining.size();
+            attempts = 0;
+        }
+
+        // Convex, the last triangle, or a self-intersecting outline with no ears left which is filled as well as a fan can
+        for (std::size_t k = 1; k + 1 < remaining.size(); ++k)
+        {
+            indices.push_back(base + remaining[0]);
+            indices.push_back(base + remaining[k]);
+            indices.push_back(base + remaining[k + 1]);
+        }
+    }
+} // namespace spark
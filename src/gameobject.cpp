@@ -1,41 +1,119 @@
 #include "GameObject.h"
 #include "Components/TransformComponent.h"
 #include "SceneManager.h"
+#include "Profiler.h"
+#include "CommandBuffer.h"
+#include "IParallelUpdateable.h"
+#include "IBoundedRenderable.h"
+#include "Renderer.h"
 #include "imgui.h"
 #include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
 
 namespace spark
 {
+    namespace
+    {
+        // Larger subtrees are drawn as usual, most GPUs can't hold bigger textures
+        constexpr int MaxBitmapCacheSize = 4096;
+
+        void Unite(SDL_FRect &bounds, bool &hasBounds, const SDL_FRect &other)
+        {
+            if (!hasBounds)
+            {
+                bounds = other;
+                hasBounds = true;
+                return;
+            }
+            const float right = std::max(bounds.x + bounds.w, other.x + other.w);
+            const float bottom = std::max(bounds.y + bounds.h, other.y + other.h);
+            bounds.x = std::min(bounds.x, other.x);
+            bounds.y = std::min(bounds.y, other.y);
+            bounds.w = right - bounds.x;
+            bounds.h = bottom - bounds.y;
+        }
+    }
+
+    struct GameObject::BitmapCache
+    {
+        ~BitmapCache()
+        {
+            if (texture)
+            {
+                SDL_DestroyTexture(texture);
+            }
+        }
+
+        SDL_Texture *texture{nullptr};
+        int width{0};
+        int height{0};
+        // Where the texture is drawn in world space, empty if the subtree draws nothing
+        SDL_FRect bounds{};
+        // Lands where the subtree's first draw would have, taken when the bitmap is redrawn
+        RenderSortKey sortKey{};
+        bool isValid{false};
+        // Too large for a texture, stays that way until the next invalidation
+        bool isUncacheable{false};
+    };
+
     GameObject::GameObject()
     {
-        m_transform = AddComponent<TransformComponent>();
+        AddComponent<TransformComponent>();
     }
 
     GameObject::GameObject(const std::string &name) : m_name{name}
     {
-        m_transform = AddComponent<TransformComponent>();
+        AddComponent<TransformComponent>();
     }
 
     GameObject::GameObject(std::string &&name) : m_name{std::move(name)}
     {
-        m_transform = AddComponent<TransformComponent>();
+        AddComponent<TransformComponent>();
     }
 
-    void GameObject::Init()
+    GameObject::~GameObject()
     {
-        for (auto *initializable : m_initializables)
+        // Children unregister themselves as m_children is destroyed after this
+        if (m_scene)
         {
-            initializable->Init();
+            m_scene->UnregisterGameObject(this);
         }
+    }
 
-        for (auto &child : m_children)
+    void *GameObject::operator new([[maybe_unused]] std::size_t size)
+    {
+        assert(size == sizeof(GameObject));
+        return ObjectPool<GameObject>::GetInstance().Allocate();
+    }
+
+    void GameObject::operator delete(void *ptr) noexcept
+    {
+        ObjectPool<GameObject>::GetInstance().Deallocate(ptr);
+    }
+
+    void GameObject::Init()
+    {
+        // Indexed, components added by an Init are appended and initialized in the same pass
+        for (std::size_t i = 0; i < m_initializables.size(); ++i)
         {
-            child->Init();
+            m_initializables[i]->Init();
         }
     }
 
     void GameObject::Update(float dt)
     {
+#ifndef SPARK_DISABLE_PROFILER
+        if (m_profileLabel == InvalidProfileLabel)
+        {
+            m_profileLabel = Profiler::GetInstance().InternLabel(m_name);
+        }
+        SPARK_PROFILE_SCOPE_LABEL(m_profileLabel);
+#endif
+
         for (auto *updateable : m_updateables)
         {
             updateable->Update(dt);
@@ -47,10 +125,34 @@ namespace spark
         }
     }
 
+    void GameObject::FixedUpdate(float fixedDt)
+    {
+        for (auto *fixedUpdateable : m_fixedUpdateables)
+        {
+            fixedUpdateable->FixedUpdate(fixedDt);
+        }
+
+        for (auto &child : m_children)
+        {
+            child->FixedUpdate(fixedDt);
+        }
+    }
+
     void GameObject::Render()
     {
+        if (m_bitmapCache && RenderBitmapCache())
+        {
+            return;
+        }
+        RenderSubtree();
+    }
+
+    void GameObject::RenderSubtree()
+    {
+        Renderer &renderer = Renderer::GetInstance();
         for (auto *renderable : m_renderables)
         {
+            renderer.SetSortKey(renderable->GetSortKey());
             renderable->Render();
         }
 
@@ -85,8 +187,406 @@ namespace spark
         }
     }
 
+    void GameObject::SetName(const std::string &name)
+    {
+        SetName(std::string{name});
+    }
+
+    void GameObject::SetName(std::string &&name)
+    {
+        // The scene's name index is shared by every worker
+        if (IsInParallelUpdate())
+        {
+            DeferChange([this, name = std::move(name)]()
+                        { SetName(name); });
+            return;
+        }
+        std::string oldName = std::exchange(m_name, std::move(name));
+#ifndef SPARK_DISABLE_PROFILER
+        m_profileLabel = InvalidProfileLabel;
+#endif
+        if (m_scene)
+        {
+            m_scene->OnGameObjectRenamed(this, oldName);
+        }
+    }
+
+    bool GameObject::AddTag(const std::string &tag)
+    {
+        // Neither the registry nor the scene's tag index is safe to touch from a worker
+        if (IsInParallelUpdate())
+        {
+            DeferChange([this, tag]()
+                        { AddTag(tag); });
+            return true;
+        }
+        const std::size_t tagId = TagRegistry::GetInstance().GetTagId(tag);
+        if (tagId == TagRegistry::InvalidTagId)
+        {
+            return false;
+        }
+
+        const TagMask bit = TagMask{1} << tagId;
+        if ((m_tagMask & bit) == 0)
+        {
+            m_tagMask |= bit;
+            if (m_scene)
+            {
+                m_scene->OnTagAdded(this, tagId);
+            }
+        }
+        return true;
+    }
+
+    void GameObject::RemoveTag(const std::string &tag)
+    {
+        if (IsInParallelUpdate())
+        {
+            DeferChange([this, tag]()
+                        { RemoveTag(tag); });
+            return;
+        }
+        const std::size_t tagId = TagRegistry::GetInstance().FindTagId(tag);
+        if (tagId == TagRegistry::InvalidTagId)
+        {
+            return;
+        }
+
+        const TagMask bit = TagMask{1} << tagId;
+        if (m_tagMask & bit)
+        {
+            m_tagMask &= ~bit;
+            if (m_scene)
+            {
+                m_scene->OnTagRemoved(this, tagId);
+            }
+        }
+    }
+
+    bool GameObject::HasTag(const std::string &tag) const
+    {
+        const std::size_t tagId = TagRegistry::GetInstance().FindTagId(tag);
+        return tagId != TagRegistry::InvalidTagId && (m_tagMask & (TagMask{1} << tagId));
+    }
+
+    void GameObject::Delete()
+    {
+        // The flag itself is already deferred on the main thread, the scene only acts on it after iterating
+        if (IsInParallelUpdate())
+        {
+            CommandBuffer::GetCurrent()->Delete(this);
+            return;
+        }
+        m_isToBeDeleted = true;
+    }
+
+    bool GameObject::RemoveDeletedChildren()
+    {
+        // Stable compaction, sibling order is update and draw order and has to survive a deletion
+        std::vector<std::unique_ptr<GameObject>> deleted;
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < m_children.size(); ++i)
+        {
+            if (m_children[i]->GetIsToBeDeleted())
+            {
+                deleted.push_back(std::move(m_children[i]));
+                continue;
+            }
+            if (kept != i)
+            {
+                m_children[kept] = std::move(m_children[i]);
+                m_childrenRawPtrs[kept] = m_childrenRawPtrs[i];
+                m_children[kept]->m_siblingIndex = static_cast<std::uint32_t>(kept);
+            }
+            ++kept;
+        }
+        m_children.resize(kept);
+        m_childrenRawPtrs.resize(kept);
+        bool isRemoved = !deleted.empty();
+        if (isRemoved)
+        {
+            InvalidateBitmapCache();
+        }
+        // Destroyed once the child lists are consistent again
+        deleted.clear();
+
+        for (const auto &child : m_children)
+        {
+            isRemoved |= child->RemoveDeletedChildren();
+        }
+        return isRemoved;
+    }
+
+    bool GameObject::IsParallelUpdateSafe() const noexcept
+    {
+        bool hasUpdateables = false;
+        return AreUpdateablesParallelSafe(hasUpdateables) && hasUpdateables;
+    }
+
+    bool GameObject::AreUpdateablesParallelSafe(bool &hasUpdateables) const noexcept
+    {
+        if (m_serialUpdateableCount > 0)
+        {
+            return false;
+        }
+        hasUpdateables |= !m_updateables.empty();
+        return std::all_of(m_children.begin(), m_children.end(), [&hasUpdateables](const std::unique_ptr<GameObject> &child)
+                           { return child->AreUpdateablesParallelSafe(hasUpdateables); });
+    }
+
+    bool GameObject::IsInParallelUpdate() noexcept
+    {
+        const CommandBuffer *buffer = CommandBuffer::GetCurrent();
+        return buffer && buffer->GetMode() == CommandBuffer::Mode::Worker;
+    }
+
+    bool GameObject::IsDeferringChanges() noexcept
+    {
+        return CommandBuffer::GetCurrent() != nullptr;
+    }
+
+    void GameObject::DeferChange(std::function<void()> change)
+    {
+        CommandBuffer::GetCurrent()->Push(std::move(change));
+    }
+
+    void GameObject::RequireMainThreadUpdate(const char *operation)
+    {
+        if (IsInParallelUpdate())
+        {
+            std::cerr << operation << " called during the parallel update, it would race with the other workers\n";
+            std::abort();
+        }
+    }
+
+    void GameObject::SetCacheAsBitmap(bool enabled)
+    {
+        // Toggled from a Render the cache may be the one being drawn into
+        if (IsDeferringChanges())
+        {
+            DeferChange([this, enabled]()
+                        { SetCacheAsBitmap(enabled); });
+            return;
+        }
+        if (enabled == IsCacheAsBitmap())
+        {
+            return;
+        }
+
+        if (enabled)
+        {
+            m_bitmapCache = std::make_unique<BitmapCache>();
+        }
+        else
+        {
+            m_bitmapCache.reset();
+        }
+        // The scene's culled Render draws cached subtrees as one item
+        if (m_scene)
+        {
+            m_scene->MarkHierarchyDirty();
+        }
+    }
+
+    void GameObject::InvalidateBitmapCache() noexcept
+    {
+        for (GameObject *gameObject = this; gameObject; gameObject = gameObject->m_parent)
+        {
+            if (BitmapCache *cache = gameObject->m_bitmapCache.get())
+            {
+                cache->isValid = false;
+                cache->isUncacheable = false;
+            }
+        }
+    }
+
+    void GameObject::ReleaseBitmapCache()
+    {
+        if (m_bitmapCache)
+        {
+            m_bitmapCache = std::make_unique<BitmapCache>();
+        }
+    }
+
+    bool GameObject::GetBitmapCacheBounds(SDL_FRect &bounds) const noexcept
+    {
+        if (!m_bitmapCache || !m_bitmapCache->isValid)
+        {
+            return false;
+        }
+        bounds = m_bitmapCache->bounds;
+        return true;
+    }
+
+    bool GameObject::RenderBitmapCache()
+    {
+        BitmapCache &cache = *m_bitmapCache;
+        if (cache.isUncacheable || (!cache.isValid && !RedrawBitmapCache()))
+        {
+            return false;
+        }
+
+        if (cache.bounds.w > 0.0f)
+        {
+            Renderer &renderer = Renderer::GetInstance();
+            renderer.SetSortKey(cache.sortKey);
+            renderer.RenderTexture(cache.texture, nullptr, &cache.bounds);
+        }
+        return true;
+    }
+
+    bool GameObject::RedrawBitmapCache()
+    {
+        BitmapCache &cache = *m_bitmapCache;
+        Renderer &renderer = Renderer::GetInstance();
+
+        SDL_FRect bounds{};
+        bool hasBounds = false;
+        bool hasUnbounded = false;
+        GatherRenderBounds(bounds, hasBounds, hasUnbounded);
+        if (hasUnbounded)
+        {
+            // Anything could be drawn anywhere, keep what's currently on screen. The view is affine,
+            // so its inverse maps the screen corners to the world.
+            int outputWidth = 0;
+            int outputHeight = 0;
+            SDL_GetCurrentRenderOutputSize(renderer.GetSDLRenderer(), &outputWidth, &outputHeight);
+            const ViewTransform view = renderer.IsViewTransformEnabled() ? renderer.GetViewTransform() : ViewTransform{};
+            const float determinant = view.xx * view.yy - view.yx * view.xy;
+            if (determinant != 0.0f)
+            {
+                SDL_FRect screen{};
+                bool hasScreen = false;
+                const float corners[4][2] = {{0.0f, 0.0f},
+                                             {static_cast<float>(outputWidth), 0.0f},
+                                             {static_cast<float>(outputWidth), static_cast<float>(outputHeight)},
+                                             {0.0f, static_cast<float>(outputHeight)}};
+                for (const auto &corner : corners)
+                {
+                    const float x = corner[0] - view.tx;
+                    const float y = corner[1] - view.ty;
+                    const SDL_FRect point{(view.yy * x - view.yx * y) / determinant, (view.xx * y - view.xy * x) / determinant, 0.0f, 0.0f};
+                    Unite(screen, hasScreen, point);
+                }
+                Unite(bounds, hasBounds, screen);
+            }
+        }
+
+        if (!hasBounds)
+        {
+            cache.bounds = SDL_FRect{};
+            cache.isValid = true;
+            return true;
+        }
+
+        // Whole pixels, so the bitmap maps 1:1 onto the pixels the subtree would have covered
+        const float left = std::floor(bounds.x);
+        const float top = std::floor(bounds.y);
+        const int width = std::max(1, static_cast<int>(std::ceil(bounds.x + bounds.w) - left));
+        const int height = std::max(1, static_cast<int>(std::ceil(bounds.y + bounds.h) - top));
+        if (width > MaxBitmapCacheSize || height > MaxBitmapCacheSize)
+        {
+            cache.isUncacheable = true;
+            return false;
+        }
+
+        if (!cache.texture || cache.width != width || cache.height != height)
+        {
+            if (cache.texture)
+            {
+                SDL_DestroyTexture(cache.texture);
+            }
+            cache.texture = SDL_CreateTexture(renderer.GetSDLRenderer(), SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_TARGET, width, height);
+            if (!cache.texture)
+            {
+                std::cerr << "Failed to create the bitmap cache of " << m_name << ": " << SDL_GetError() << "\n";
+                cache.isUncacheable = true;
+                return false;
+            }
+            // Blending onto a transparent target leaves premultiplied colors behind
+            SDL_SetTextureBlendMode(cache.texture, SDL_BLENDMODE_BLEND_PREMULTIPLIED);
+            cache.width = width;
+            cache.height = height;
+        }
+
+        float r = 0.0f;
+        float g = 0.0f;
+        float b = 0.0f;
+        float a = 0.0f;
+        renderer.GetDrawColorFloat(&r, &g, &b, &a);
+
+        // Whatever the scene queued so far stays queued for the screen while the subtree draws into the texture
+        if (!renderer.PushRenderTarget(cache.texture))
+        {
+            std::cerr << "Failed to redraw the bitmap cache of " << m_name << ": " << SDL_GetError() << "\n";
+            cache.isUncacheable = true;
+            return false;
+        }
+        renderer.SetDrawColorFloat(0.0f, 0.0f, 0.0f, 0.0f);
+        renderer.Clear();
+        renderer.SetDrawColorFloat(r, g, b, a);
+        renderer.SetViewTransform(ViewTransform{1.0f, 0.0f, 0.0f, 1.0f, -left, -top});
+        renderer.SetViewTransformEnabled(true);
+        RenderSubtree();
+        renderer.PopRenderTarget();
+
+        bool hasSortKey = false;
+        cache.sortKey = RenderSortKey{};
+        GatherLowestSortKey(cache.sortKey, hasSortKey);
+
+        cache.bounds = SDL_FRect{left, top, static_cast<float>(width), static_cast<float>(height)};
+        cache.isValid = true;
+        return true;
+    }
+
+    void GameObject::GatherRenderBounds(SDL_FRect &bounds, bool &hasBounds, bool &hasUnbounded)
+    {
+        for (IRenderable *renderable : m_renderables)
+        {
+            SDL_FRect renderableBounds;
+            if (auto *bounded = dynamic_cast<IBoundedRenderable *>(renderable))
+            {
+                if (bounded->GetWorldBounds(renderableBounds))
+                {
+                    Unite(bounds, hasBounds, renderableBounds);
+                }
+            }
+        }
+        hasUnbounded |= !m_unboundedRenderables.empty();
+
+        for (GameObject *child : m_childrenRawPtrs)
+        {
+            child->GatherRenderBounds(bounds, hasBounds, hasUnbounded);
+        }
+    }
+
+    void GameObject::GatherLowestSortKey(RenderSortKey &sortKey, bool &hasSortKey) const
+    {
+        for (const IRenderable *renderable : m_renderables)
+        {
+            const RenderSortKey key = renderable->GetSortKey();
+            if (!hasSortKey || key.layer < sortKey.layer || (key.layer == sortKey.layer && key.depth < sortKey.depth))
+            {
+                sortKey = key;
+                hasSortKey = true;
+            }
+        }
+
+        for (const GameObject *child : m_childrenRawPtrs)
+        {
+            child->GatherLowestSortKey(sortKey, hasSortKey);
+        }
+    }
+
     void GameObject::SetParent(GameObject *newParent, bool keepWorldPos)
     {
+        if (CommandBuffer *buffer = CommandBuffer::GetCurrent())
+        {
+            // Reparenting moves objects between the scene's and other objects' child lists, which may be mid-iteration
+            buffer->SetParent(this, newParent, keepWorldPos);
+            return;
+        }
+
         if (newParent == m_parent || newParent == this || IsChild(newParent))
         {
             return;
@@ -111,47 +611,102 @@ namespace spark
             m_transform->SetLocalScale(m_transform->GetWorldScale());
         }
 
+        Scene *scene = m_scene ? m_scene : SceneManager::GetInstance().GetCurrentScene();
         if (m_parent != nullptr)
         {
-            auto it = std::find_if(m_parent->m_children.begin(), m_parent->m_children.end(),
-                                   [this](const std::unique_ptr<GameObject> &ptr)
-                                   { return ptr.get() == this; });
-
-            if (it != m_parent->m_children.end())
-            {
-                it->release(); // Release ownership
-                m_parent->m_children.erase(it);
-            }
-
-            auto rawIt = std::find(m_parent->m_childrenRawPtrs.begin(),
-                                   m_parent->m_childrenRawPtrs.end(), this);
-            if (rawIt != m_parent->m_childrenRawPtrs.end())
-            {
-                m_parent->m_childrenRawPtrs.erase(rawIt);
-            }
+            m_parent->DetachChild(this);
         }
         else if (newParent != nullptr)
         {
-            SceneManager::GetInstance().GetCurrentScene()->PopGameObject(this);
+            scene->PopGameObject(this);
         }
 
         m_parent = newParent;
 
         if (m_parent != nullptr)
         {
-            m_parent->m_children.emplace_back(this);
-            m_parent->m_childrenRawPtrs.emplace_back(this);
+            m_parent->AddChild(this);
+            if (!m_scene && m_parent->m_scene)
+            {
+                m_parent->m_scene->RegisterGameObject(this);
+            }
         }
         else
         {
-            SceneManager::GetInstance().GetCurrentScene()->AddGameObject(
-                std::unique_ptr<GameObject>{this});
+            scene->AddGameObject(std::unique_ptr<GameObject>{this});
+        }
+
+        // The cached world matrix was relative to the old parent
+        if (m_transform)
+        {
+            m_transform->SetDirtyRecursive();
+        }
+        NotifyHierarchyChanged();
+    }
+
+    void GameObject::AddChild(GameObject *child)
+    {
+        InvalidateBitmapCache();
+        child->m_siblingIndex = static_cast<std::uint32_t>(m_children.size());
+        m_children.emplace_back(child);
+        m_childrenRawPtrs.emplace_back(child);
+    }
+
+    void GameObject::DetachChild(GameObject *child)
+    {
+        const std::size_t index = child->m_siblingIndex;
+        if (index >= m_children.size() || m_children[index].get() != child)
+        {
+            return;
+        }
+
+        InvalidateBitmapCache();
+        // The child's ownership moves to the caller. Order preserving, the later siblings shift down one.
+        m_children[index].release();
+        m_children.erase(m_children.begin() + static_cast<std::ptrdiff_t>(index));
+        m_childrenRawPtrs.erase(m_childrenRawPtrs.begin() + static_cast<std::ptrdiff_t>(index));
+        for (std::size_t i = index; i < m_children.size(); ++i)
+        {
+            m_children[i]->m_siblingIndex = static_cast<std::uint32_t>(i);
+        }
+        child->m_siblingIndex = NoSiblingIndex;
+    }
+
+    void GameObject::NotifyHierarchyChanged()
+    {
+        // The scene this object lives in, which needn't be the current one while scenes are being switched
+        if (m_scene)
+        {
+            m_scene->MarkHierarchyDirty();
+        }
+    }
+
+    void GameObject::NotifyComponentAdded(std::size_t typeId)
+    {
+        if (m_scene)
+        {
+            m_scene->OnComponentAdded(this, typeId);
+        }
+    }
+
+    void GameObject::NotifyComponentRemoved(std::size_t typeId)
+    {
+        if (m_scene)
+        {
+            m_scene->OnComponentRemoved(this, typeId);
         }
     }
 
-    bool GameObject::IsChild(GameObject *gameObject) const noexcept
+    void GameObject::RegisterInterfaces(Component *component)
     {
-        return std::find(m_childrenRawPtrs.begin(), m_childrenRawPtrs.end(), gameObject) != m_childrenRawPtrs.end();
+        if (CommandBuffer *buffer = CommandBuffer::GetCurrent())
+        {
+            // The interface lists are exactly what Update and Render are looping over
+            buffer->Push([this, component]()
+                         { CacheInterfacePointers(component); });
+            return;
+        }
+        CacheInterfacePointers(component);
     }
 
     void GameObject::CacheInterfacePointers(Component *component)
@@ -163,10 +718,27 @@ namespace spark
         if (auto *updateable = dynamic_cast<IUpdateable *>(component))
         {
             m_updateables.emplace_back(updateable);
+            if (!dynamic_cast<IParallelUpdateable *>(component))
+            {
+                ++m_serialUpdateableCount;
+            }
+        }
+        if (auto *fixedUpdateable = dynamic_cast<IFixedUpdateable *>(component))
+        {
+            m_fixedUpdateables.emplace_back(fixedUpdateable);
         }
         if (auto *renderable = dynamic_cast<IRenderable *>(component))
         {
             m_renderables.emplace_back(renderable);
+            if (!dynamic_cast<IBoundedRenderable *>(component))
+            {
+                m_unboundedRenderables.emplace_back(renderable);
+            }
+            if (m_scene)
+            {
+                m_scene->OnRenderableAdded(this, renderable);
+            }
+            InvalidateBitmapCache();
         }
         if (auto *imguiRenderable = dynamic_cast<IImGuiRenderable *>(component))
         {
@@ -187,10 +759,24 @@ namespace spark
         if (auto *updateable = dynamic_cast<IUpdateable *>(component))
         {
             RemoveInterfacePtr(m_updateables, updateable);
+            if (!dynamic_cast<IParallelUpdateable *>(component))
+            {
+                --m_serialUpdateableCount;
+            }
+        }
+        if (auto *fixedUpdateable = dynamic_cast<IFixedUpdateable *>(component))
+        {
+            RemoveInterfacePtr(m_fixedUpdateables, fixedUpdateable);
         }
         if (auto *renderable = dynamic_cast<IRenderable *>(component))
         {
             RemoveInterfacePtr(m_renderables, renderable);
+            RemoveInterfacePtr(m_unboundedRenderables, renderable);
+            if (m_scene)
+            {
+                m_scene->OnRenderableRemoved(this, renderable);
+            }
+            InvalidateBitmapCache();
         }
         if (auto *imguiRenderable = dynamic_cast<IImGuiRenderable *>(component))
         {
@@ -17,6 +17,11 @@
 #include "SceneManager.h"
 #include "Window.h"
 #include "Renderer.h"
+#include "Profiler.h"
+#include "TraceRecorder.h"
+#include "GameTime.h"
+#include "TextureCache.h"
+#include "TextRenderer.h"
 
 #ifdef __EMSCRIPTEN__
 static std::function<void()> g_mainLoop;
@@ -39,6 +44,7 @@ void QuitSDL()
 
 void Render(spark::Renderer &renderer, spark::SceneManager &sceneManager, spark::EditorUI &editorUI)
 {
+    SPARK_PROFILE_SCOPE("Render");
     // Clear screen
     renderer.SetDrawColor(135, 206, 235, 255);
     renderer.Clear();
@@ -46,11 +52,14 @@ void Render(spark::Renderer &renderer, spark::SceneManager &sceneManager, spark:
     editorUI.BeginFrame();
     // Render scene content
     sceneManager.Render();
+    // Batched scene geometry has to reach SDL before ImGui draws on top of it
+    renderer.Flush();
     // Render UI on top
     editorUI.Render(sceneManager);
     editorUI.EndFrame(renderer.GetSDLRenderer());
 
     // Present final result
+    SPARK_PROFILE_SCOPE("Present");
     renderer.Present();
 }
 int main(int argc, char *argv[])
@@ -59,8 +68,14 @@ int main(int argc, char *argv[])
     // Singletons
     auto &window = spark::Window::GetInstance();
     auto &renderer = spark::Renderer::GetInstance();
+    // Before Lua, so it outlives the Textures scripts still hold when the Lua state is destroyed
+    auto &textureCache = spark::TextureCache::GetInstance();
+    auto &textRenderer = spark::TextRenderer::GetInstance();
     auto &lua = spark::LuaInstance::GetInstance();
     auto &sceneManager = spark::SceneManager::GetInstance();
+    auto &profiler = spark::Profiler::GetInstance();
+    auto &traceRecorder = spark::TraceRecorder::GetInstance();
+    auto &gameTime = spark::GameTime::GetInstance();
 
     renderer.SetVSync(true);
     lua.Init();
@@ -106,35 +121,46 @@ int main(int argc, char *argv[])
 
     auto mainLoopIteration = [&]()
     {
+        profiler.BeginFrame();
+
         Uint64 currentTime = SDL_GetPerformanceCounter();
-        float dt = (currentTime - lastTime) / static_cast<float>(frequency);
+        const float frameDt = (currentTime - lastTime) / static_cast<float>(frequency);
         lastTime = currentTime;
 
         // cap dt
-        dt = std::min(dt, 0.05f);
+        const float dt = std::min(frameDt, 0.05f);
 
-        SDL_Event e;
-        while (SDL_PollEvent(&e))
         {
-            editorUI.ProcessEvent(&e);
-
-            switch (e.type)
+            SPARK_PROFILE_SCOPE("PollEvents");
+            SDL_Event e;
+            while (SDL_PollEvent(&e))
             {
-            case SDL_EVENT_QUIT:
-                running = false;
-                break;
-            case SDL_EVENT_WINDOW_CLOSE_REQUESTED:
-                if (e.window.windowID == SDL_GetWindowID(window.GetSDLWindow()))
-                    running = false;
-                break;
-            case SDL_EVENT_WINDOW_RESIZED:
-                if (e.window.windowID == SDL_GetWindowID(window.GetSDLWindow()))
+                editorUI.ProcessEvent(&e);
+
+                switch (e.type)
                 {
-                    window.OnResize(e.window.data1, e.window.data2);
+                case SDL_EVENT_QUIT:
+                    running = false;
+                    break;
+                case SDL_EVENT_WINDOW_CLOSE_REQUESTED:
+                    if (e.window.windowID == SDL_GetWindowID(window.GetSDLWindow()))
+                        running = false;
+                    break;
+                case SDL_EVENT_WINDOW_RESIZED:
+                    if (e.window.windowID == SDL_GetWindowID(window.GetSDLWindow()))
+                    {
+                        window.OnResize(e.window.data1, e.window.data2);
+                    }
+                    break;
+                case SDL_EVENT_KEY_DOWN:
+                    if (e.key.key == SDLK_F9 && !e.key.repeat)
+                    {
+                        traceRecorder.StartCapture();
+                    }
+                    break;
+                default:
+                    break;
                 }
-                break;
-            default:
-                break;
             }
         }
 
@@ -147,10 +173,20 @@ int main(int argc, char *argv[])
 
         // input
 
-        // update
+        // update: fixed steps first, they get the real frame time and cap it with their own substep limit
+        const int fixedSteps = gameTime.Advance(frameDt);
+        for (int step = 0; step < fixedSteps; ++step)
+        {
+            sceneManager.FixedUpdate(gameTime.GetStepDeltaTime());
+        }
         sceneManager.Update(dt);
+        // Images whose decode finished since last frame become drawable
+        textureCache.Update();
+        textRenderer.Update();
 
         Render(renderer, sceneManager, editorUI);
+        profiler.EndFrame();
+        traceRecorder.CollectFrame();
 
 #ifndef __EMSCRIPTEN__
         // Only limit framerate if not using vsync
@@ -179,6 +215,9 @@ int main(int argc, char *argv[])
 #endif
 
     editorUI.Shutdown();
+    textureCache.Clear();
+    textRenderer.Clear();
+    sceneManager.ReleaseBitmapCaches();
     QuitSDL();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,33 @@
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <iostream>
+
+// assert is compiled out of the default Release build, these checks aren't. A failed check is reported and the test
+// carries on, main returns spark::test::Result() so the test fails once it's done.
+namespace spark::test
+{
+    inline int g_failedChecks = 0;
+
+    inline int Result()
+    {
+        if (g_failedChecks > 0)
+        {
+            std::cerr << g_failedChecks << " check(s) failed\n";
+            return 1;
+        }
+        return 0;
+    }
+} // namespace spark::test
+
+#define SPARK_CHECK(condition)                                                              \
+    do                                                                                      \
+    {                                                                                       \
+        if (!(condition))                                                                   \
+        {                                                                                   \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #condition "\n"; \
+            ++spark::test::g_failedChecks;                                                  \
+        }                                                                                   \
+    } while (false)
+
+#endif // CHECK_H
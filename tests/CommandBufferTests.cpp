@@ -0,0 +1,118 @@
+#include "Check.h"
+#include "CommandBuffer.h"
+
+#include <vector>
+
+using namespace spark;
+
+namespace
+{
+    void ScopesNestAndRestore()
+    {
+        CommandBuffer outer;
+        CommandBuffer inner{CommandBuffer::Mode::Worker};
+        SPARK_CHECK(CommandBuffer::GetCurrent() == nullptr);
+        {
+            const CommandBuffer::Scope outerScope{outer};
+            SPARK_CHECK(CommandBuffer::GetCurrent() == &outer);
+            {
+                const CommandBuffer::Scope innerScope{inner, 3};
+                SPARK_CHECK(CommandBuffer::GetCurrent() == &inner);
+            }
+            SPARK_CHECK(CommandBuffer::GetCurrent() == &outer);
+        }
+        SPARK_CHECK(CommandBuffer::GetCurrent() == nullptr);
+    }
+
+    void PlaybackRunsInRecordedOrder()
+    {
+        CommandBuffer buffer;
+        std::vector<int> order;
+        for (int i = 0; i < 5; ++i)
+        {
+            buffer.Push([&order, i]
+                        { order.push_back(i); });
+        }
+        buffer.Playback();
+        SPARK_CHECK((order == std::vector<int>{0, 1, 2, 3, 4}));
+        SPARK_CHECK(buffer.IsEmpty());
+    }
+
+    // Workers record under their root's key in whatever order they happen to run, playback undoes that
+    void WorkerBuffersPlayBackBySortKey()
+    {
+        std::vector<CommandBuffer> buffers(2, CommandBuffer{CommandBuffer::Mode::Worker});
+        std::vector<int> order;
+        const auto record = [&order](CommandBuffer &buffer, int value)
+        {
+            buffer.Push([&order, value]
+                        { order.push_back(value); });
+        };
+
+        {
+            const CommandBuffer::Scope scope{buffers[0], 2};
+            record(buffers[0], 20);
+            record(buffers[0], 21);
+        }
+        {
+            const CommandBuffer::Scope scope{buffers[1], 0};
+            record(buffers[1], 0);
+        }
+        {
+            const CommandBuffer::Scope scope{buffers[0], 1};
+            record(buffers[0], 10);
+        }
+        {
+            const CommandBuffer::Scope scope{buffers[1], 2};
+            record(buffers[1], 22);
+        }
+
+        CommandBuffer::Playback(buffers);
+        SPARK_CHECK((order == std::vector<int>{0, 10, 20, 21, 22}));
+        SPARK_CHECK(buffers[0].IsEmpty() && buffers[1].IsEmpty());
+    }
+
+    // A worker that runs another root's job while it waits must not leave that root's key behind
+    void NestedScopesRestoreTheSortKey()
+    {
+        std::vector<CommandBuffer> buffers(1, CommandBuffer{CommandBuffer::Mode::Worker});
+        CommandBuffer &buffer = buffers[0];
+        std::vector<int> order;
+        const auto record = [&order, &buffer](int value)
+        {
+            buffer.Push([&order, value]
+                        { order.push_back(value); });
+        };
+
+        {
+            const CommandBuffer::Scope rootScope{buffer, 5};
+            record(50);
+            {
+                const CommandBuffer::Scope stolenScope{buffer, 1};
+                record(10);
+            }
+            record(51);
+            {
+                // The plain form keeps whatever key is current
+                const CommandBuffer::Scope sameKeyScope{buffer};
+                record(52);
+            }
+        }
+        {
+            const CommandBuffer::Scope scope{buffer, 3};
+            record(30);
+        }
+
+        CommandBuffer::Playback(buffers);
+        SPARK_CHECK((order == std::vector<int>{10, 30, 50, 51, 52}));
+    }
+}
+
+int main()
+{
+    ScopesNestAndRestore();
+    PlaybackRunsInRecordedOrder();
+    WorkerBuffersPlayBackBySortKey();
+    NestedScopesRestoreTheSortKey();
+    return spark::test::Result();
+}
@@ -0,0 +1,155 @@
+#include "Check.h"
+#include "CullingGrid.h"
+
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace spark;
+
+namespace
+{
+    // Closed intervals, touching edges count as overlapping
+    bool Overlaps(const SDL_FRect &a, const SDL_FRect &b)
+    {
+        return a.x <= b.x + b.w && b.x <= a.x + a.w && a.y <= b.y + b.h && b.y <= a.y + a.h;
+    }
+
+    std::vector<int> QueryCounts(CullingGrid &grid, const SDL_FRect &area, std::size_t idCount)
+    {
+        std::vector<int> counts(idCount, 0);
+        grid.Query(area, [&counts](std::uint32_t id)
+                   {
+                       if (id < counts.size())
+                       {
+                           ++counts[id];
+                       } });
+        return counts;
+    }
+
+    void QueriesReportOverlappingIdsOnce()
+    {
+        CullingGrid grid{64.0f};
+        const SDL_FRect small{10.0f, 10.0f, 20.0f, 20.0f};
+        const SDL_FRect spanning{-100.0f, -100.0f, 300.0f, 150.0f}; // several cells, negative ones too
+        const SDL_FRect far{5000.0f, 5000.0f, 10.0f, 10.0f};
+        grid.Update(0, small);
+        grid.Update(1, spanning);
+        grid.Update(2, far);
+
+        std::vector<int> counts = QueryCounts(grid, SDL_FRect{0.0f, 0.0f, 100.0f, 100.0f}, 3);
+        SPARK_CHECK(counts[0] == 1 && counts[1] == 1 && counts[2] == 0);
+
+        counts = QueryCounts(grid, SDL_FRect{4990.0f, 4990.0f, 5.0f, 5.0f}, 3);
+        SPARK_CHECK(counts[0] == 0 && counts[1] == 0 && counts[2] == 1);
+
+        // Covers far more cells than are occupied, which walks the occupied cells instead
+        counts = QueryCounts(grid, SDL_FRect{-1.0e6f, -1.0e6f, 2.0e6f, 2.0e6f}, 3);
+        SPARK_CHECK(counts[0] == 1 && counts[1] == 1 && counts[2] == 1);
+    }
+
+    void UpdatesMoveAndRemoveEntries()
+    {
+        CullingGrid grid{64.0f};
+        grid.Update(7, SDL_FRect{0.0f, 0.0f, 10.0f, 10.0f});
+        SPARK_CHECK(grid.Contains(7));
+        SPARK_CHECK(!grid.Contains(6));
+
+        grid.Update(7, SDL_FRect{1000.0f, 0.0f, 10.0f, 10.0f});
+        std::vector<int> counts = QueryCounts(grid, SDL_FRect{0.0f, 0.0f, 10.0f, 10.0f}, 8);
+        SPARK_CHECK(counts[7] == 0);
+        counts = QueryCounts(grid, SDL_FRect{1000.0f, 0.0f, 10.0f, 10.0f}, 8);
+        SPARK_CHECK(counts[7] == 1);
+
+        grid.Remove(7);
+        SPARK_CHECK(!grid.Contains(7));
+        SPARK_CHECK(grid.GetCellCount() == 0);
+        counts = QueryCounts(grid, SDL_FRect{1000.0f, 0.0f, 10.0f, 10.0f}, 8);
+        SPARK_CHECK(counts[7] == 0);
+        grid.Remove(7);
+    }
+
+    void LargeAndInfiniteBoundsAreAlwaysReported()
+    {
+        CullingGrid grid{64.0f};
+        const float infinity = std::numeric_limits<float>::infinity();
+        grid.Update(0, SDL_FRect{-infinity, -infinity, infinity, infinity});
+        grid.Update(1, SDL_FRect{0.0f, 0.0f, 64.0f * 20.0f, 64.0f * 20.0f});
+        grid.Update(2, SDL_FRect{std::numeric_limits<float>::quiet_NaN(), 0.0f, 1.0f, 1.0f});
+        SPARK_CHECK(grid.GetCellCount() == 0);
+
+        std::vector<int> counts = QueryCounts(grid, SDL_FRect{-5000.0f, -5000.0f, 1.0f, 1.0f}, 3);
+        SPARK_CHECK(counts[0] == 1 && counts[1] == 1 && counts[2] == 1);
+
+        // Shrinking back below the limit puts it into cells again
+        grid.Update(1, SDL_FRect{0.0f, 0.0f, 10.0f, 10.0f});
+        counts = QueryCounts(grid, SDL_FRect{-5000.0f, -5000.0f, 1.0f, 1.0f}, 3);
+        SPARK_CHECK(counts[1] == 0);
+        counts = QueryCounts(grid, SDL_FRect{5.0f, 5.0f, 1.0f, 1.0f}, 3);
+        SPARK_CHECK(counts[1] == 1);
+    }
+
+    // Random inserts, moves and removals checked against testing every box
+    void MatchesBruteForce()
+    {
+        constexpr std::uint32_t IdCount = 300;
+        std::mt19937 random{12345};
+        std::uniform_real_distribution<float> position{-2000.0f, 2000.0f};
+        std::uniform_real_distribution<float> size{0.0f, 300.0f};
+        std::uniform_int_distribution<std::uint32_t> pickId{0, IdCount - 1};
+
+        CullingGrid grid{128.0f};
+        std::vector<SDL_FRect> bounds(IdCount);
+        std::vector<bool> isPresent(IdCount, false);
+        int missed = 0;
+        int extraReports = 0;
+        int reportedRemoved = 0;
+        for (int step = 0; step < 2000; ++step)
+        {
+            const std::uint32_t id = pickId(random);
+            if (step % 7 == 0)
+            {
+                grid.Remove(id);
+                isPresent[id] = false;
+            }
+            else
+            {
+                bounds[id] = SDL_FRect{position(random), position(random), size(random), size(random)};
+                grid.Update(id, bounds[id]);
+                isPresent[id] = true;
+            }
+
+            if (step % 20 != 0)
+            {
+                continue;
+            }
+            const SDL_FRect area{position(random), position(random), size(random) * 4.0f, size(random) * 3.0f};
+            const std::vector<int> counts = QueryCounts(grid, area, IdCount);
+            for (std::uint32_t i = 0; i < IdCount; ++i)
+            {
+                missed += isPresent[i] && Overlaps(bounds[i], area) && counts[i] == 0;
+                extraReports += counts[i] > 1;
+                reportedRemoved += !isPresent[i] && counts[i] > 0;
+            }
+        }
+        SPARK_CHECK(missed == 0);
+        SPARK_CHECK(extraReports == 0);
+        SPARK_CHECK(reportedRemoved == 0);
+
+        for (std::uint32_t i = 0; i < IdCount; ++i)
+        {
+            grid.Remove(i);
+        }
+        SPARK_CHECK(grid.GetCellCount() == 0);
+    }
+}
+
+int main()
+{
+    QueriesReportOverlappingIdsOnce();
+    UpdatesMoveAndRemoveEntries();
+    LargeAndInfiniteBoundsAreAlwaysReported();
+    MatchesBruteForce();
+    return spark::test::Result();
+}
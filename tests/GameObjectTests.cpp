@@ -0,0 +1,52 @@
+#include "Check.h"
+#include "GameObject.h"
+#include "Scene.h"
+#include "Components/TransformComponent.h"
+
+using namespace spark;
+
+namespace
+{
+    void TransformCanBeRemovedAndAddedBack()
+    {
+        GameObject gameObject{"object"};
+        SPARK_CHECK(gameObject.GetTransform() != nullptr);
+        SPARK_CHECK(gameObject.GetTransform() == gameObject.GetComponent<TransformComponent>());
+
+        gameObject.RemoveComponent<TransformComponent>();
+        SPARK_CHECK(gameObject.GetTransform() == nullptr);
+        SPARK_CHECK(!gameObject.HasComponent<TransformComponent>());
+
+        TransformComponent *transform = gameObject.AddComponent<TransformComponent>();
+        SPARK_CHECK(transform != nullptr);
+        SPARK_CHECK(gameObject.GetTransform() == transform);
+        SPARK_CHECK(gameObject.GetComponent<TransformComponent>() == transform);
+        SPARK_CHECK(gameObject.HasComponent<TransformComponent>());
+
+        // Adding it again hands back the same one
+        SPARK_CHECK(gameObject.AddComponent<TransformComponent>() == transform);
+    }
+
+    // Children read their parent's transform through the cached pointer
+    void ChildrenFollowAReAddedTransform()
+    {
+        Scene scene;
+        GameObject *parent = scene.EmplaceGameObject("parent");
+        GameObject *child = scene.EmplaceGameObject("child");
+        child->SetParent(parent);
+
+        parent->RemoveComponent<TransformComponent>();
+        parent->AddComponent<TransformComponent>()->SetLocalPosition({10.0f, 20.0f, 0.0f});
+        child->GetTransform()->SetLocalPosition({1.0f, 2.0f, 0.0f});
+
+        const glm::vec3 position = child->GetTransform()->GetWorldPosition();
+        SPARK_CHECK(position.x == 11.0f && position.y == 22.0f);
+    }
+}
+
+int main()
+{
+    TransformCanBeRemovedAndAddedBack();
+    ChildrenFollowAReAddedTransform();
+    return spark::test::Result();
+}
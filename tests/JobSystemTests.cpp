@@ -0,0 +1,171 @@
+#include "Check.h"
+#include "JobSystem.h"
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+using namespace spark;
+
+namespace
+{
+    void ContinuationRunsAfterItsDependency()
+    {
+        JobSystem &jobSystem = JobSystem::GetInstance();
+        constexpr int JobCount = 64;
+        std::atomic<int> finished{0};
+        int seenByContinuation = -1;
+
+        JobCounter jobs;
+        JobCounter continuation;
+        for (int i = 0; i < JobCount; ++i)
+        {
+            jobSystem.Schedule([&finished]
+                               { finished.fetch_add(1, std::memory_order_relaxed); }, jobs);
+        }
+        jobSystem.Schedule([&]
+                           { seenByContinuation = finished.load(std::memory_order_relaxed); }, continuation, &jobs);
+        jobSystem.Wait(continuation);
+
+        SPARK_CHECK(seenByContinuation == JobCount);
+        SPARK_CHECK(jobs.IsDone());
+        SPARK_CHECK(jobs.continuations.empty());
+        SPARK_CHECK(continuation.IsReleasable());
+    }
+
+    void ContinuationOfAFinishedCounterRunsRightAway()
+    {
+        JobSystem &jobSystem = JobSystem::GetInstance();
+        JobCounter done;
+        JobCounter continuation;
+        bool hasRun = false;
+        jobSystem.Schedule([&hasRun]
+                           { hasRun = true; }, continuation, &done);
+        SPARK_CHECK(done.continuations.empty());
+        jobSystem.Wait(continuation);
+        SPARK_CHECK(hasRun);
+    }
+
+    void ChainedContinuationsRunInOrder()
+    {
+        JobSystem &jobSystem = JobSystem::GetInstance();
+        constexpr int ChainLength = 16;
+        std::vector<JobCounter> counters(ChainLength);
+        std::vector<int> order;
+        std::atomic<bool> isReleased{false};
+
+        // The first link waits on a job that spins until everything else is scheduled, so the rest are parked
+        // as continuations rather than pushed
+        JobCounter gate;
+        jobSystem.Schedule([&isReleased]
+                           {
+                               while (!isReleased.load(std::memory_order_acquire))
+                               {
+                               } }, gate);
+        for (int i = 0; i < ChainLength; ++i)
+        {
+            jobSystem.Schedule([&order, i]
+                               { order.push_back(i); }, counters[i], i == 0 ? &gate : &counters[i - 1]);
+        }
+        isReleased.store(true, std::memory_order_release);
+        jobSystem.Wait(counters.back());
+        jobSystem.Wait(gate);
+
+        SPARK_CHECK(static_cast<int>(order.size()) == ChainLength);
+        for (int i = 0; i < static_cast<int>(order.size()); ++i)
+        {
+            SPARK_CHECK(order[i] == i);
+        }
+    }
+
+    void ContinuationsFanOut()
+    {
+        JobSystem &jobSystem = JobSystem::GetInstance();
+        constexpr int FanOut = 32;
+        std::atomic<bool> isReleased{false};
+        std::atomic<int> ranBeforeDependency{0};
+        std::atomic<int> ran{0};
+
+        JobCounter dependency;
+        JobCounter continuations;
+        jobSystem.Schedule([&isReleased]
+                           {
+                               while (!isReleased.load(std::memory_order_acquire))
+                               {
+                               } }, dependency);
+        for (int i = 0; i < FanOut; ++i)
+        {
+            jobSystem.Schedule([&]
+                               {
+                                   if (!dependency.IsDone())
+                                   {
+                                       ranBeforeDependency.fetch_add(1, std::memory_order_relaxed);
+                                   }
+                                   ran.fetch_add(1, std::memory_order_relaxed); }, continuations, &dependency);
+        }
+        isReleased.store(true, std::memory_order_release);
+        jobSystem.Wait(continuations);
+        jobSystem.Wait(dependency);
+
+        SPARK_CHECK(ran.load() == FanOut);
+        SPARK_CHECK(ranBeforeDependency.load() == 0);
+    }
+
+    // Waiting on other work must not pull a background job onto the waiting thread, waiting on its own counter does
+    void BackgroundJobsOnlyRunForTheirOwnWait()
+    {
+        JobSystem &jobSystem = JobSystem::GetInstance();
+        const std::thread::id caller = std::this_thread::get_id();
+        std::atomic<bool> ranOnCaller{false};
+        std::atomic<bool> hasRun{false};
+
+        JobCounter background;
+        jobSystem.ScheduleBackground([&]
+                                     {
+                                         ranOnCaller.store(std::this_thread::get_id() == caller, std::memory_order_relaxed);
+                                         hasRun.store(true, std::memory_order_relaxed); }, background);
+        JobCounter frame;
+        for (int i = 0; i < 8; ++i)
+        {
+            jobSystem.Schedule([] {}, frame);
+        }
+        jobSystem.Wait(frame);
+        SPARK_CHECK(!hasRun.load() || !ranOnCaller.load());
+
+        jobSystem.Wait(background);
+        SPARK_CHECK(hasRun.load());
+    }
+
+    void ParallelForCoversTheRangeOnce()
+    {
+        JobSystem &jobSystem = JobSystem::GetInstance();
+        constexpr std::size_t Begin = 3;
+        constexpr std::size_t End = 10003;
+        std::vector<std::atomic<int>> visits(End);
+        jobSystem.ParallelFor(Begin, End, 64, [&visits](std::size_t begin, std::size_t end)
+                              {
+                                  for (std::size_t i = begin; i < end; ++i)
+                                  {
+                                      visits[i].fetch_add(1, std::memory_order_relaxed);
+                                  } });
+
+        int wrongCount = 0;
+        for (std::size_t i = 0; i < End; ++i)
+        {
+            wrongCount += visits[i].load() != (i >= Begin ? 1 : 0);
+        }
+        SPARK_CHECK(wrongCount == 0);
+    }
+}
+
+int main()
+{
+    ContinuationRunsAfterItsDependency();
+    ContinuationOfAFinishedCounterRunsRightAway();
+    ChainedContinuationsRunInOrder();
+    ContinuationsFanOut();
+    BackgroundJobsOnlyRunForTheirOwnWait();
+    ParallelForCoversTheRangeOnce();
+    return spark::test::Result();
+}
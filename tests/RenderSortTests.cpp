@@ -0,0 +1,130 @@
+#include "Check.h"
+#include "RenderSort.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace spark;
+
+namespace
+{
+    struct Item
+    {
+        std::uint64_t key;
+        std::uint32_t order;
+    };
+
+    std::uint64_t Key(std::int8_t layer, float depth, std::uint64_t textureRank = 0, std::uint64_t blendModeRank = 0)
+    {
+        return PackSortKey(RenderSortKey{layer, depth}, textureRank, blendModeRank);
+    }
+
+    void LayersSortBeforeEverythingElse()
+    {
+        SPARK_CHECK(Key(-128, 1.0e30f, 4095, 15) < Key(-127, -1.0e30f));
+        SPARK_CHECK(Key(-1, 0.0f) < Key(0, 0.0f));
+        SPARK_CHECK(Key(0, 1000.0f, 7) < Key(1, -1000.0f));
+        SPARK_CHECK(Key(126, 0.0f) < Key(127, 0.0f));
+    }
+
+    void DepthsSortLikeFloats()
+    {
+        const float infinity = std::numeric_limits<float>::infinity();
+        const std::vector<float> depths{-infinity, -1.0e20f, -3.5f, -1.0f, -1.0e-30f, 0.0f, 1.0e-30f, 0.5f, 1.0f, 2.0f, 1.0e20f, infinity};
+        for (std::size_t i = 0; i + 1 < depths.size(); ++i)
+        {
+            SPARK_CHECK(Key(0, depths[i]) < Key(0, depths[i + 1]));
+        }
+
+        // Both zeros and NaN share a key, so they fall back to submission order
+        SPARK_CHECK(Key(0, -0.0f) == Key(0, 0.0f));
+        SPARK_CHECK(Key(0, std::numeric_limits<float>::quiet_NaN()) == Key(0, 0.0f));
+    }
+
+    void RanksSortBetweenLayerAndDepth()
+    {
+        SPARK_CHECK(Key(0, 100.0f, 0) < Key(0, -100.0f, 1));
+        SPARK_CHECK(Key(0, 100.0f, 1, 0) < Key(0, -100.0f, 1, 1));
+        SPARK_CHECK(Key(0, 0.0f, 1, 15) < Key(0, 0.0f, 2, 0));
+
+        // Past their bits they're clamped rather than spilling into the layer
+        SPARK_CHECK(Key(0, 0.0f, 4095) == Key(0, 0.0f, 100000));
+        SPARK_CHECK(Key(0, 0.0f, 0, 15) == Key(0, 0.0f, 0, 100));
+        SPARK_CHECK(Key(0, 0.0f, 100000, 100) < Key(1, 0.0f));
+    }
+
+    void RadixSortMatchesStableSort()
+    {
+        std::mt19937 random{2024};
+        std::uniform_int_distribution<int> layer{-3, 3};
+        std::uniform_int_distribution<int> depth{-20, 20};
+        std::uniform_int_distribution<std::uint64_t> rank{0, 5};
+        std::vector<Item> items;
+        std::vector<Item> scratch;
+        for (int round = 0; round < 20; ++round)
+        {
+            items.clear();
+            const int count = 1 + round * 97;
+            for (int i = 0; i < count; ++i)
+            {
+                // Few distinct values, so there are plenty of ties to keep in order
+                const std::uint64_t textureRank = round % 2 ? rank(random) : 0;
+                const std::uint64_t key = Key(static_cast<std::int8_t>(layer(random)), static_cast<float>(depth(random)) * 0.25f, textureRank);
+                items.push_back(Item{key, static_cast<std::uint32_t>(i)});
+            }
+
+            std::vector<Item> expected = items;
+            std::stable_sort(expected.begin(), expected.end(), [](const Item &a, const Item &b)
+                             { return a.key < b.key; });
+            RadixSort(items, scratch);
+
+            bool isSame = items.size() == expected.size();
+            for (std::size_t i = 0; isSame && i < items.size(); ++i)
+            {
+                isSame = items[i].key == expected[i].key && items[i].order == expected[i].order;
+            }
+            SPARK_CHECK(isSame);
+        }
+    }
+
+    void RadixSortEdgeCases()
+    {
+        std::vector<Item> items;
+        std::vector<Item> scratch;
+        RadixSort(items, scratch);
+        SPARK_CHECK(items.empty());
+
+        // Every byte shared, nothing moves
+        items.assign(50, Item{Key(2, 1.0f), 0});
+        for (std::uint32_t i = 0; i < items.size(); ++i)
+        {
+            items[i].order = i;
+        }
+        RadixSort(items, scratch);
+        bool isInOrder = true;
+        for (std::uint32_t i = 0; i < items.size(); ++i)
+        {
+            isInOrder &= items[i].order == i;
+        }
+        SPARK_CHECK(isInOrder);
+
+        // Keys differing in the lowest and highest bytes only
+        items = {{0xFF00000000000001ull, 0}, {0x0000000000000002ull, 1}, {0xFF00000000000000ull, 2}, {0x0000000000000001ull, 3}};
+        RadixSort(items, scratch);
+        SPARK_CHECK(items[0].order == 3 && items[1].order == 1 && items[2].order == 2 && items[3].order == 0);
+    }
+}
+
+int main()
+{
+    LayersSortBeforeEverythingElse();
+    DepthsSortLikeFloats();
+    RanksSortBetweenLayerAndDepth();
+    RadixSortMatchesStableSort();
+    RadixSortEdgeCases();
+    return spark::test::Result();
+}
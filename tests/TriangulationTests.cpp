@@ -0,0 +1,167 @@
+#include "Check.h"
+#include "Triangulation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+using namespace spark;
+
+namespace
+{
+    float SignedArea(const glm::vec2 &a, const glm::vec2 &b, const glm::vec2 &c)
+    {
+        return 0.5f * ((b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x));
+    }
+
+    float PolygonArea(const std::vector<glm::vec2> &points)
+    {
+        float area = 0.0f;
+        for (std::size_t i = 0, j = points.size() - 1; i < points.size(); j = i++)
+        {
+            area += points[j].x * points[i].y - points[i].x * points[j].y;
+        }
+        return 0.5f * area;
+    }
+
+    // Even-odd rule
+    bool IsInside(const std::vector<glm::vec2> &points, const glm::vec2 &p)
+    {
+        bool isInside = false;
+        for (std::size_t i = 0, j = points.size() - 1; i < points.size(); j = i++)
+        {
+            const glm::vec2 &a = points[i];
+            const glm::vec2 &b = points[j];
+            if ((a.y > p.y) != (b.y > p.y) && p.x < (b.x - a.x) * (p.y - a.y) / (b.y - a.y) + a.x)
+            {
+                isInside = !isInside;
+            }
+        }
+        return isInside;
+    }
+
+    // A simple polygon has to come out as n - 2 triangles inside it, all wound the same way whichever way the outline
+    // goes, covering exactly its area
+    void CheckSimplePolygon(const std::vector<glm::vec2> &points)
+    {
+        constexpr int Base = 5;
+        std::vector<int> indices{-1, -1, -1};
+        TriangulatePolygon(points, Base, indices);
+
+        SPARK_CHECK(indices[0] == -1 && indices[1] == -1 && indices[2] == -1);
+        SPARK_CHECK(indices.size() == 3 + (points.size() - 2) * 3);
+
+        const float polygonArea = PolygonArea(points);
+        float coveredArea = 0.0f;
+        for (std::size_t i = 3; i + 2 < indices.size(); i += 3)
+        {
+            bool isInRange = true;
+            for (std::size_t k = i; k < i + 3; ++k)
+            {
+                isInRange &= indices[k] >= Base && indices[k] < Base + static_cast<int>(points.size());
+            }
+            SPARK_CHECK(isInRange);
+            if (!isInRange)
+            {
+                continue;
+            }
+
+            const glm::vec2 &a = points[indices[i] - Base];
+            const glm::vec2 &b = points[indices[i + 1] - Base];
+            const glm::vec2 &c = points[indices[i + 2] - Base];
+            const float area = SignedArea(a, b, c);
+            SPARK_CHECK(area >= 0.0f);
+            coveredArea += std::abs(area);
+            if (std::abs(area) > 1e-4f)
+            {
+                const glm::vec2 centroid{(a.x + b.x + c.x) / 3.0f, (a.y + b.y + c.y) / 3.0f};
+                SPARK_CHECK(IsInside(points, centroid));
+            }
+        }
+        SPARK_CHECK(std::abs(coveredArea - std::abs(polygonArea)) < 1e-3f * std::max(1.0f, std::abs(polygonArea)));
+    }
+
+    void CheckBothWindings(std::vector<glm::vec2> points)
+    {
+        CheckSimplePolygon(points);
+        std::reverse(points.begin(), points.end());
+        CheckSimplePolygon(points);
+    }
+
+    void ConvexOutlinesBecomeAFan()
+    {
+        const std::vector<glm::vec2> square{{0.0f, 0.0f}, {10.0f, 0.0f}, {10.0f, 10.0f}, {0.0f, 10.0f}};
+        std::vector<int> indices;
+        TriangulatePolygon(square, 0, indices);
+        SPARK_CHECK((indices == std::vector<int>{0, 1, 2, 0, 2, 3}));
+        CheckBothWindings(square);
+
+        std::vector<glm::vec2> circle;
+        for (int i = 0; i < 64; ++i)
+        {
+            const float angle = 2.0f * 3.14159265f * static_cast<float>(i) / 64.0f;
+            circle.emplace_back(std::cos(angle) * 50.0f, std::sin(angle) * 50.0f);
+        }
+        CheckBothWindings(circle);
+    }
+
+    void ConcaveOutlinesAreEarClipped()
+    {
+        // L shape
+        CheckBothWindings({{0.0f, 0.0f}, {20.0f, 0.0f}, {20.0f, 5.0f}, {5.0f, 5.0f}, {5.0f, 20.0f}, {0.0f, 20.0f}});
+
+        // Arrow, its reflex corner is next to the start of the outline
+        CheckBothWindings({{0.0f, 0.0f}, {10.0f, 5.0f}, {20.0f, 0.0f}, {10.0f, 20.0f}});
+
+        // Five-pointed star
+        std::vector<glm::vec2> star;
+        for (int i = 0; i < 10; ++i)
+        {
+            const float angle = 2.0f * 3.14159265f * static_cast<float>(i) / 10.0f;
+            const float radius = i % 2 == 0 ? 40.0f : 15.0f;
+            star.emplace_back(std::cos(angle) * radius, std::sin(angle) * radius);
+        }
+        CheckBothWindings(star);
+
+        // Comb, many reflex corners in a row
+        std::vector<glm::vec2> comb{{0.0f, 0.0f}};
+        for (int tooth = 0; tooth < 8; ++tooth)
+        {
+            const float x = static_cast<float>(tooth) * 10.0f;
+            comb.emplace_back(x, 30.0f);
+            comb.emplace_back(x + 5.0f, 30.0f);
+            comb.emplace_back(x + 5.0f, 10.0f);
+            comb.emplace_back(x + 10.0f, 10.0f);
+        }
+        comb.emplace_back(80.0f, 0.0f);
+        CheckBothWindings(comb);
+    }
+
+    void CollinearPointsAreKept()
+    {
+        CheckBothWindings({{0.0f, 0.0f}, {5.0f, 0.0f}, {10.0f, 0.0f}, {10.0f, 10.0f}, {5.0f, 5.0f}, {0.0f, 10.0f}});
+    }
+
+    void DegenerateOutlinesTerminate()
+    {
+        std::vector<int> indices;
+        TriangulatePolygon({}, 0, indices);
+        TriangulatePolygon({{0.0f, 0.0f}, {1.0f, 1.0f}}, 0, indices);
+        SPARK_CHECK(indices.empty());
+
+        // A bow tie has no ears on one side, it's still filled with n - 2 triangles
+        const std::vector<glm::vec2> bowTie{{0.0f, 0.0f}, {10.0f, 10.0f}, {10.0f, 0.0f}, {0.0f, 10.0f}};
+        TriangulatePolygon(bowTie, 0, indices);
+        SPARK_CHECK(indices.size() == 6);
+    }
+}
+
+int main()
+{
+    ConvexOutlinesBecomeAFan();
+    ConcaveOutlinesAreEarClipped();
+    CollinearPointsAreKept();
+    DegenerateOutlinesTerminate();
+    return spark::test::Result();
+}